@@ -0,0 +1,242 @@
+// 端到端负载测试：经由客户端的 ApiService、RateLimiter、PollScheduler 和下载路径
+// 提交 N 个文生视频任务，轮询到完成后下载视频，统计提交吞吐、每个完成任务的查询次数
+// 和端到端延迟分位数。
+//
+// 默认在进程内启动 MockGenerationServer，并临时把设置中的 submitUrl / queryUrl 指向它
+// （退出时恢复）；--use-settings 则直接使用设置中已配置的 URL，例如外部的
+// mock_generation_server。
+//
+// 用法: bench_load_test [--tasks N] [--poll-interval ms] [--submit-rps r] [--poll-rps r]
+//                       [--timeout s] [--use-settings] [--api-key key] [--downloads N]
+//                       [--queue s] [--process s] [--fail-rate p] [--throttle-rate p] [--error-rate p]
+
+#include "MockGenerationServer.h"
+#include "const/AppConfig.h"
+#include "services/ApiService.h"
+#include "services/DownloadScheduler.h"
+#include "services/PollScheduler.h"
+#include "services/RateLimiter.h"
+#include "services/TimingWheel.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// 临时覆盖设置中的 API URL，析构时恢复原值
+class ApiUrlOverride {
+public:
+    ApiUrlOverride(const QUrl &submitUrl, const QUrl &queryUrl) {
+        QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+        for (const QString &key : {QString("submitUrl"), QString("queryUrl")}) {
+            if (settings.contains(key)) {
+                saved.insert(key, settings.value(key));
+            }
+        }
+        settings.setValue("submitUrl", submitUrl.toString());
+        settings.setValue("queryUrl", queryUrl.toString());
+    }
+
+    ~ApiUrlOverride() {
+        QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+        for (const QString &key : {QString("submitUrl"), QString("queryUrl")}) {
+            if (saved.contains(key)) {
+                settings.setValue(key, saved.value(key));
+            } else {
+                settings.remove(key);
+            }
+        }
+    }
+
+private:
+    QVariantMap saved;
+};
+
+double percentile(std::vector<qint64> &values, int p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, values.size() * p / 100)] / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("End-to-end load test against the mock generation server");
+    parser.addHelpOption();
+    QCommandLineOption tasksOption("tasks", "Number of tasks to submit.", "N", "500");
+    QCommandLineOption pollIntervalOption("poll-interval", "Delay between polls of one task (ms).", "ms", "2000");
+    QCommandLineOption submitRpsOption("submit-rps", "Client submit rate limit (0 = built-in default).", "r", "20");
+    QCommandLineOption pollRpsOption("poll-rps", "Client poll rate limit (0 = from settings).", "r", "50");
+    QCommandLineOption timeoutOption("timeout", "Give up after this many seconds.", "s", "600");
+    QCommandLineOption useSettingsOption("use-settings", "Use the configured submitUrl/queryUrl instead of an in-process mock.");
+    QCommandLineOption apiKeyOption("api-key", "API key sent as Bearer token.", "key", "load-test-key");
+    QCommandLineOption queueOption("queue", "Mock median queue time in seconds.", "s", "2");
+    QCommandLineOption processOption("process", "Mock median processing time in seconds.", "s", "8");
+    QCommandLineOption failOption("fail-rate", "Mock fraction of failed tasks.", "p", "0.02");
+    QCommandLineOption throttleOption("throttle-rate", "Mock fraction of 429 responses.", "p", "0.01");
+    QCommandLineOption errorOption("error-rate", "Mock fraction of 500 responses.", "p", "0");
+    QCommandLineOption downloadsOption("downloads", "Max concurrent video downloads.", "N", "8");
+    parser.addOptions({tasksOption, pollIntervalOption, submitRpsOption, pollRpsOption, timeoutOption, useSettingsOption,
+                       apiKeyOption, queueOption, processOption, failOption, throttleOption, errorOption, downloadsOption});
+    parser.process(app);
+
+    const int tasks = qMax(1, parser.value(tasksOption).toInt());
+    const int pollIntervalMs = qMax(100, parser.value(pollIntervalOption).toInt());
+    const QString apiKey = parser.value(apiKeyOption);
+
+    MockGenerationServer::Options options;
+    options.queueMedianSec = parser.value(queueOption).toDouble();
+    options.processMedianSec = parser.value(processOption).toDouble();
+    options.failRate = parser.value(failOption).toDouble();
+    options.throttleRate = parser.value(throttleOption).toDouble();
+    options.errorRate = parser.value(errorOption).toDouble();
+    MockGenerationServer server(options);
+    std::unique_ptr<ApiUrlOverride> urlOverride;
+    if (!parser.isSet(useSettingsOption)) {
+        if (!server.listen(QHostAddress::LocalHost, 0)) {
+            std::fprintf(stderr, "cannot listen: %s\n", qPrintable(server.errorString()));
+            return 1;
+        }
+        urlOverride = std::make_unique<ApiUrlOverride>(server.submitUrl(), server.queryUrl());
+    }
+
+    double submitRps = parser.value(submitRpsOption).toDouble();
+    if (submitRps > 0) {
+        RateLimiter::instance()->setLimits(RateLimiter::Endpoint::Submit, submitRps, qMax(1, static_cast<int>(submitRps)),
+                                           qMax(RateLimiter::SUBMIT_CONCURRENCY, static_cast<int>(submitRps)));
+    }
+    double pollRps = parser.value(pollRpsOption).toDouble();
+    if (pollRps > 0) {
+        RateLimiter::instance()->setLimits(RateLimiter::Endpoint::Poll, pollRps, qMax(1, static_cast<int>(pollRps)),
+                                           qMax(RateLimiter::POLL_CONCURRENCY, static_cast<int>(pollRps)));
+    }
+
+    // 下载并发数由参数给出，不受设置中的带宽上限影响
+    DownloadScheduler::instance()->setMaxConcurrent(parser.value(downloadsOption).toInt());
+    DownloadScheduler::instance()->setBandwidthLimit(0);
+
+    // 在覆盖设置之后创建，使其读取到 mock 的 URL
+    ApiService api;
+    PollScheduler scheduler(nullptr, &api);
+    scheduler.reloadSettings();
+    if (pollRps > 0) {
+        scheduler.setRequestsPerSecond(pollRps);
+    }
+    TimingWheel repolls(100);
+    QTemporaryDir downloadDir;
+
+    std::printf("submit URL: %s\nquery URL:  %s\n", qPrintable(api.getSubmitUrl()), qPrintable(api.getQueryUrl()));
+    std::printf("tasks %d, poll interval %d ms\n\n", tasks, pollIntervalMs);
+    std::fflush(stdout);
+
+    QElapsedTimer clock;
+    QHash<QString, qint64> enqueuedAt;   // requestTag -> 调用 submitTask 的时间
+    QHash<QString, qint64> submittedAt;  // taskId -> 调用 submitTask 的时间
+    std::vector<qint64> endToEndMs;
+    qint64 lastSubmitAcceptedMs = 0;
+    int accepted = 0;
+    int completed = 0;
+    int failed = 0;
+    int submitRetries = 0;
+
+    auto finishOne = [&]() {
+        if (completed + failed >= tasks) {
+            app.quit();
+        }
+    };
+
+    std::function<void(const QString &)> pollTask;
+    pollTask = [&](const QString &taskId) {
+        scheduler.poll(apiKey, taskId, &app, [&, taskId](const PollResult &result) {
+            if (result.isPending()) {
+                repolls.schedule(pollIntervalMs, [&pollTask, taskId]() { pollTask(taskId); });
+            } else if (result.success) {
+                api.downloadVideo(result.videoUrl, downloadDir.filePath(result.taskId + ".mp4"), result.taskId);
+            } else {
+                failed++;  // 与 GenerationTaskManager 一致，查询出错即视为任务失败
+                finishOne();
+            }
+        });
+    };
+
+    // 端到端延迟从调用 submitTask 开始计时，包含限流排队时间
+    QObject::connect(&api, &ApiService::submissionSucceeded, &app, [&](const QString &tag, const QString &taskId) {
+        submittedAt.insert(taskId, enqueuedAt.take(tag));
+        accepted++;
+        lastSubmitAcceptedMs = clock.elapsed();
+        repolls.schedule(pollIntervalMs, [&pollTask, taskId]() { pollTask(taskId); });
+    });
+    QObject::connect(&api, &ApiService::submissionFailed, &app, [&](const QString &, const QString &) {
+        failed++;
+        finishOne();
+    });
+    QObject::connect(&api, &ApiService::submissionRetrying, &app, [&](const QString &, int, int, const QString &) {
+        submitRetries++;
+    });
+    QObject::connect(&api, &ApiService::videoDownloadedForTask, &app, [&](const QString &taskId, const QString &) {
+        endToEndMs.push_back(clock.elapsed() - submittedAt.value(taskId));
+        completed++;
+        finishOne();
+    });
+    QObject::connect(&api, &ApiService::downloadFailed, &app, [&](const QString &, const QString &) {
+        failed++;
+        finishOne();
+    });
+
+    QTimer::singleShot(parser.value(timeoutOption).toInt() * 1000, &app, [&]() {
+        std::fprintf(stderr, "timeout: %d of %d tasks finished\n", completed + failed, tasks);
+        app.quit();
+    });
+
+    clock.start();
+    for (int i = 0; i < tasks; ++i) {
+        QString tag = QString("load-%1").arg(i);
+        enqueuedAt.insert(tag, clock.elapsed());
+        api.submitTask(apiKey, QString("load test prompt %1").arg(i), {}, tag);
+    }
+    app.exec();
+
+    double elapsedSec = clock.elapsed() / 1000.0;
+    PollStats pollStats = scheduler.stats();
+    quint64 throttleEvents = 0;
+    for (const RateLimiterState &state : RateLimiter::instance()->snapshot()) {
+        throttleEvents += state.throttleEvents;
+    }
+
+    std::printf("%-28s %10.1f s\n", "wall time", elapsedSec);
+    std::printf("%-28s %10.2f /s\n", "submits accepted",
+                lastSubmitAcceptedMs > 0 ? accepted * 1000.0 / lastSubmitAcceptedMs : 0.0);
+    std::printf("%-28s %10d\n", "submit retries", submitRetries);
+    std::printf("%-28s %10d / %d (failed %d)\n", "completed", completed, tasks, failed);
+    std::printf("%-28s %10.2f\n", "polls per completed task",
+                completed > 0 ? static_cast<double>(pollStats.sent) / completed : 0.0);
+    std::printf("%-28s %10llu\n", "polls coalesced", static_cast<unsigned long long>(pollStats.coalesced));
+    std::printf("%-28s %10llu\n", "client throttle events", static_cast<unsigned long long>(throttleEvents));
+    std::printf("%-28s %10.2f / %.2f / %.2f s\n", "end-to-end p50 / p90 / p99", percentile(endToEndMs, 50),
+                percentile(endToEndMs, 90), percentile(endToEndMs, 99));
+
+    if (server.isListening()) {
+        MockGenerationServer::Stats s = server.stats();
+        std::printf("\nserver: submits %llu, polls %llu, downloads %llu, 429 %llu, 500 %llu, duplicate submits %llu, %.1f MB\n",
+                    static_cast<unsigned long long>(s.submits), static_cast<unsigned long long>(s.polls),
+                    static_cast<unsigned long long>(s.downloads), static_cast<unsigned long long>(s.throttled),
+                    static_cast<unsigned long long>(s.serverErrors), static_cast<unsigned long long>(s.duplicateSubmits),
+                    s.bytesServed / 1048576.0);
+    }
+    return completed + failed >= tasks ? 0 : 1;
+}
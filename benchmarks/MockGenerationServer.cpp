@@ -0,0 +1,277 @@
+#include "MockGenerationServer.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpSocket>
+#include <QUrlQuery>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+MockGenerationServer::MockGenerationServer(const Options &options, QObject *parent)
+    : QTcpServer(parent), options(options), rng(options.seed), nextTaskSeq(0) {
+    clock.start();
+}
+
+QUrl MockGenerationServer::submitUrl() const {
+    return QUrl(QString("http://127.0.0.1:%1/v3/async/seedance-v1-pro-t2v").arg(serverPort()));
+}
+
+QUrl MockGenerationServer::queryUrl() const {
+    return QUrl(QString("http://127.0.0.1:%1/v3/async/task-result").arg(serverPort()));
+}
+
+MockGenerationServer::Stats MockGenerationServer::stats() const {
+    return counters;
+}
+
+void MockGenerationServer::incomingConnection(qintptr handle) {
+    auto *socket = new QTcpSocket(this);
+    socket->setSocketDescriptor(handle);
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+        buffers[socket] += socket->readAll();
+        processBuffer(socket);
+    });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+        buffers.remove(socket);
+        socket->deleteLater();
+    });
+}
+
+void MockGenerationServer::processBuffer(QTcpSocket *socket) {
+    QByteArray &buffer = buffers[socket];
+    while (true) {
+        int headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            return;
+        }
+
+        QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+        Request request;
+        QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+        request.method = requestLine.value(0);
+        QByteArray target = requestLine.value(1);
+        int questionMark = target.indexOf('?');
+        request.path = questionMark >= 0 ? target.left(questionMark) : target;
+        request.query = questionMark >= 0 ? target.mid(questionMark + 1) : QByteArray();
+        for (int i = 1; i < lines.size(); ++i) {
+            int colon = lines[i].indexOf(':');
+            if (colon > 0) {
+                request.headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+            }
+        }
+
+        qint64 contentLength = request.headers.value("content-length").toLongLong();
+        if (buffer.size() < headerEnd + 4 + contentLength) {
+            return;  // 等待完整的请求体
+        }
+        request.body = buffer.mid(headerEnd + 4, contentLength);
+        buffer.remove(0, headerEnd + 4 + contentLength);
+
+        handle(socket, request);
+    }
+}
+
+void MockGenerationServer::handle(QTcpSocket *socket, const Request &request) {
+    if (request.path.startsWith("/videos/") && request.method == "GET") {
+        handleVideo(socket, request);
+        return;
+    }
+    if (!request.headers.value("authorization").startsWith("Bearer ")) {
+        respond(socket, 401, R"({"message":"missing api key"})");
+        return;
+    }
+    if (request.method == "POST" && request.path.endsWith("seedance-v1-pro-t2v")) {
+        handleSubmit(socket, request, false);
+    } else if (request.method == "POST" && request.path.endsWith("seedance-v1-pro-i2v")) {
+        handleSubmit(socket, request, true);
+    } else if (request.method == "GET" && request.path.endsWith("task-result")) {
+        handleQuery(socket, request);
+    } else {
+        respond(socket, 404, R"({"message":"not found"})");
+    }
+}
+
+bool MockGenerationServer::inject(QTcpSocket *socket) {
+    double roll = rng.generateDouble();
+    if (roll < options.throttleRate) {
+        counters.throttled++;
+        respond(socket, 429, R"({"message":"too many requests"})", "application/json",
+                {{"Retry-After", QByteArray::number(options.retryAfterSec)}});
+        return true;
+    }
+    if (roll < options.throttleRate + options.errorRate) {
+        counters.serverErrors++;
+        respond(socket, 500, R"({"message":"internal error"})");
+        return true;
+    }
+    return false;
+}
+
+qint64 MockGenerationServer::sampleDurationMs(double medianSec) {
+    // 对数正态：median × exp(σ·Z)，Z 由 Box-Muller 生成
+    double u1 = qMax(1e-12, rng.generateDouble());
+    double u2 = rng.generateDouble();
+    const double pi = 3.14159265358979323846;
+    double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * pi * u2);
+    return static_cast<qint64>(medianSec * std::exp(options.sigma * z) * 1000.0);
+}
+
+void MockGenerationServer::handleSubmit(QTcpSocket *socket, const Request &request, bool imageToVideo) {
+    if (inject(socket)) {
+        return;
+    }
+
+    QJsonObject json = QJsonDocument::fromJson(request.body).object();
+    if (imageToVideo ? json["image"].toString().isEmpty() : json["prompt"].toString().isEmpty()) {
+        respond(socket, 400, imageToVideo ? R"({"message":"image is required"})" : R"({"message":"prompt is required"})");
+        return;
+    }
+    counters.submits++;
+
+    // 同一个幂等键只创建一个任务
+    QByteArray idempotencyKey = request.headers.value("idempotency-key");
+    if (!idempotencyKey.isEmpty() && idempotencyKeys.contains(idempotencyKey)) {
+        counters.duplicateSubmits++;
+        respond(socket, 200, QJsonDocument(QJsonObject{{"task_id", QString::fromLatin1(idempotencyKeys.value(idempotencyKey))}})
+                                 .toJson(QJsonDocument::Compact));
+        return;
+    }
+
+    Task task;
+    task.id = "mock-" + QByteArray::number(++nextTaskSeq);
+    task.createdMs = clock.elapsed();
+    task.queueMs = sampleDurationMs(options.queueMedianSec);
+    task.processMs = sampleDurationMs(options.processMedianSec);
+    task.fails = rng.generateDouble() < options.failRate;
+    tasks.insert(task.id, task);
+    if (!idempotencyKey.isEmpty()) {
+        idempotencyKeys.insert(idempotencyKey, task.id);
+    }
+
+    respond(socket, 200, QJsonDocument(QJsonObject{{"task_id", QString::fromLatin1(task.id)}}).toJson(QJsonDocument::Compact));
+}
+
+void MockGenerationServer::handleQuery(QTcpSocket *socket, const Request &request) {
+    if (inject(socket)) {
+        return;
+    }
+    counters.polls++;
+
+    QByteArray taskId = QUrlQuery(QString::fromLatin1(request.query)).queryItemValue("task_id").toLatin1();
+    auto it = tasks.constFind(taskId);
+    if (it == tasks.constEnd()) {
+        respond(socket, 404, R"({"message":"task not found"})");
+        return;
+    }
+
+    const Task &task = *it;
+    qint64 age = clock.elapsed() - task.createdMs;
+    QJsonObject taskObj{{"task_id", QString::fromLatin1(task.id)}};
+    QJsonObject response;
+
+    if (age < task.queueMs) {
+        taskObj["status"] = "TASK_STATUS_QUEUED";
+        taskObj["progress_percent"] = 0;
+    } else if (age < task.queueMs + task.processMs) {
+        taskObj["status"] = "TASK_STATUS_PROCESSING";
+        taskObj["progress_percent"] = static_cast<int>((age - task.queueMs) * 100 / qMax<qint64>(1, task.processMs));
+    } else if (task.fails) {
+        taskObj["status"] = "TASK_STATUS_FAILED";
+        taskObj["reason"] = "mock: injected generation failure";
+    } else {
+        taskObj["status"] = "TASK_STATUS_SUCCEED";
+        taskObj["progress_percent"] = 100;
+        QString videoUrl = QString("http://127.0.0.1:%1/videos/%2.mp4").arg(serverPort()).arg(QString::fromLatin1(task.id));
+        response["videos"] = QJsonArray{QJsonObject{{"video_url", videoUrl}}};
+    }
+    response["task"] = taskObj;
+    respond(socket, 200, QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void MockGenerationServer::handleVideo(QTcpSocket *socket, const Request &request) {
+    QByteArray taskId = request.path.mid(8);
+    taskId.chop(4);  // ".mp4"
+    if (!tasks.contains(taskId)) {
+        respond(socket, 404, R"({"message":"video not found"})");
+        return;
+    }
+    counters.downloads++;
+
+    QByteArray video = syntheticMp4(taskId, options.videoBytes);
+    QByteArray etag = "\"" + taskId + "\"";
+    QList<QPair<QByteArray, QByteArray>> headers{{"Accept-Ranges", "bytes"}, {"ETag", etag}};
+
+    QByteArray range = request.headers.value("range");
+    QByteArray ifRange = request.headers.value("if-range");
+    if (range.startsWith("bytes=") && (ifRange.isEmpty() || ifRange == etag)) {
+        QList<QByteArray> bounds = range.mid(6).split('-');
+        qint64 start = bounds.value(0).toLongLong();
+        qint64 end = bounds.value(1).isEmpty() ? video.size() - 1 : qMin<qint64>(video.size() - 1, bounds.value(1).toLongLong());
+        if (start >= video.size() || start > end) {
+            respond(socket, 416, QByteArray(), "video/mp4",
+                    {{"Content-Range", "bytes */" + QByteArray::number(video.size())}});
+            return;
+        }
+        headers.append({"Content-Range", "bytes " + QByteArray::number(start) + "-" + QByteArray::number(end)
+                                             + "/" + QByteArray::number(video.size())});
+        respond(socket, 206, video.mid(start, end - start + 1), "video/mp4", headers);
+        return;
+    }
+    respond(socket, 200, video, "video/mp4", headers);
+}
+
+void MockGenerationServer::respond(QTcpSocket *socket, int status, const QByteArray &body, const QByteArray &contentType,
+                                   const QList<QPair<QByteArray, QByteArray>> &extraHeaders) {
+    static const QHash<int, QByteArray> reasons{
+        {200, "OK"}, {206, "Partial Content"}, {400, "Bad Request"}, {401, "Unauthorized"}, {404, "Not Found"},
+        {416, "Range Not Satisfiable"}, {429, "Too Many Requests"}, {500, "Internal Server Error"}};
+
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + " " + reasons.value(status, "Unknown") + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    for (const auto &header : extraHeaders) {
+        response += header.first + ": " + header.second + "\r\n";
+    }
+    response += "Connection: keep-alive\r\n\r\n";
+    response += body;
+    counters.bytesServed += body.size();
+    socket->write(response);
+}
+
+QByteArray MockGenerationServer::syntheticMp4(const QByteArray &taskId, qint64 size) {
+    auto box = [](const char *type, const QByteArray &payload) {
+        QByteArray header(8, '\0');
+        qToBigEndian<quint32>(static_cast<quint32>(payload.size() + 8), header.data());
+        std::memcpy(header.data() + 4, type, 4);
+        return header + payload;
+    };
+    auto be32 = [](quint32 value) {
+        QByteArray bytes(4, '\0');
+        qToBigEndian<quint32>(value, bytes.data());
+        return bytes;
+    };
+
+    // ftyp
+    QByteArray ftyp = box("ftyp", QByteArray("isom") + be32(0x200) + "isomiso2avc1mp41");
+
+    // moov/mvhd（version 0，1000 timescale，5 秒）
+    QByteArray mvhd = be32(0) + be32(0) + be32(0) + be32(1000) + be32(5000) + be32(0x00010000)
+                      + QByteArray("\x01\x00", 2) + QByteArray(10, '\0');
+    const quint32 matrix[9] = {0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000};
+    for (quint32 value : matrix) {
+        mvhd += be32(value);
+    }
+    mvhd += QByteArray(24, '\0') + be32(2);
+    QByteArray moov = box("moov", box("mvhd", mvhd));
+
+    // mdat 填充确定性的伪数据，使同一任务的内容可重复校验
+    qint64 payloadSize = qMax<qint64>(0, size - ftyp.size() - moov.size() - 8);
+    QByteArray payload(payloadSize, '\0');
+    quint32 state = qHash(taskId);
+    for (qint64 i = 0; i < payloadSize; ++i) {
+        state = state * 1664525u + 1013904223u;
+        payload[i] = static_cast<char>(state >> 24);
+    }
+    return ftyp + moov + box("mdat", payload);
+}
@@ -0,0 +1,92 @@
+#ifndef MOCKGENERATIONSERVER_H
+#define MOCKGENERATIONSERVER_H
+
+#include <QTcpServer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QUrl>
+
+class QTcpSocket;
+
+// 模拟视频生成 API 的本地 HTTP 服务器，接口与 api.ppinfra.com 一致：
+//   POST /v3/async/seedance-v1-pro-t2v    文生视频提交
+//   POST /v3/async/seedance-v1-pro-i2v    图生视频提交
+//   GET  /v3/async/task-result?task_id=   查询任务状态
+//   GET  /videos/<task_id>.mp4            下载合成的 MP4（支持 Range）
+// 排队和生成耗时服从对数正态分布，可按比例注入任务失败、429 和 500。
+class MockGenerationServer : public QTcpServer {
+    Q_OBJECT
+public:
+    struct Options {
+        double queueMedianSec = 2.0;     // 排队耗时中位数
+        double processMedianSec = 8.0;   // 生成耗时中位数
+        double sigma = 0.5;              // 对数正态分布的 σ
+        double failRate = 0.02;          // 任务最终失败的比例
+        double throttleRate = 0.0;       // 以 429 拒绝请求的比例
+        double errorRate = 0.0;          // 以 500 拒绝请求的比例
+        int retryAfterSec = 1;
+        qint64 videoBytes = 512 * 1024;  // 合成视频大小
+        quint32 seed = 1;
+    };
+
+    struct Stats {
+        quint64 submits = 0;
+        quint64 polls = 0;
+        quint64 downloads = 0;
+        quint64 throttled = 0;
+        quint64 serverErrors = 0;
+        quint64 duplicateSubmits = 0;  // 以相同 Idempotency-Key 重复提交
+        quint64 bytesServed = 0;
+    };
+
+    explicit MockGenerationServer(const Options &options, QObject *parent = nullptr);
+
+    QUrl submitUrl() const;
+    QUrl queryUrl() const;
+    Stats stats() const;
+
+    static QByteArray syntheticMp4(const QByteArray &taskId, qint64 size);
+
+protected:
+    void incomingConnection(qintptr handle) override;
+
+private:
+    struct Task {
+        QByteArray id;
+        qint64 createdMs = 0;
+        qint64 queueMs = 0;
+        qint64 processMs = 0;
+        bool fails = false;
+    };
+
+    struct Request {
+        QByteArray method;
+        QByteArray path;
+        QByteArray query;
+        QHash<QByteArray, QByteArray> headers;  // 小写名
+        QByteArray body;
+    };
+
+    void processBuffer(QTcpSocket *socket);
+    void handle(QTcpSocket *socket, const Request &request);
+    void handleSubmit(QTcpSocket *socket, const Request &request, bool imageToVideo);
+    void handleQuery(QTcpSocket *socket, const Request &request);
+    void handleVideo(QTcpSocket *socket, const Request &request);
+    void respond(QTcpSocket *socket, int status, const QByteArray &body,
+                 const QByteArray &contentType = "application/json",
+                 const QList<QPair<QByteArray, QByteArray>> &extraHeaders = {});
+    bool inject(QTcpSocket *socket);  // 按比例返回 429 / 500
+    qint64 sampleDurationMs(double medianSec);
+
+    Options options;
+    Stats counters;
+    QRandomGenerator rng;
+    QElapsedTimer clock;
+    QHash<QByteArray, Task> tasks;
+    QHash<QByteArray, QByteArray> idempotencyKeys;  // key -> task_id
+    QHash<QTcpSocket *, QByteArray> buffers;
+    quint64 nextTaskSeq;
+};
+
+#endif // MOCKGENERATIONSERVER_H
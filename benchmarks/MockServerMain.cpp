@@ -0,0 +1,63 @@
+// 独立运行的模拟生成服务器。启动后把设置中的"提交 URL"和"查询 URL"指向输出的地址，
+// 即可在不访问 api.ppinfra.com 的情况下使用客户端或 bench_load_test --use-settings。
+//
+// 用法: mock_generation_server [--port N] [--queue s] [--process s] [--sigma x]
+//                              [--fail-rate p] [--throttle-rate p] [--error-rate p] [--video-kb N]
+
+#include "MockGenerationServer.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <cstdio>
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Local mock of the video generation API");
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", "Listen port (0 = any).", "N", "8765");
+    QCommandLineOption queueOption("queue", "Median queue time in seconds.", "s", "2");
+    QCommandLineOption processOption("process", "Median processing time in seconds.", "s", "8");
+    QCommandLineOption sigmaOption("sigma", "Log-normal sigma of both distributions.", "x", "0.5");
+    QCommandLineOption failOption("fail-rate", "Fraction of tasks that end FAILED.", "p", "0.02");
+    QCommandLineOption throttleOption("throttle-rate", "Fraction of API requests answered with 429.", "p", "0");
+    QCommandLineOption errorOption("error-rate", "Fraction of API requests answered with 500.", "p", "0");
+    QCommandLineOption videoOption("video-kb", "Synthetic MP4 size in KB.", "N", "512");
+    QCommandLineOption seedOption("seed", "Random seed.", "N", "1");
+    parser.addOptions({portOption, queueOption, processOption, sigmaOption, failOption, throttleOption, errorOption,
+                       videoOption, seedOption});
+    parser.process(app);
+
+    MockGenerationServer::Options options;
+    options.queueMedianSec = parser.value(queueOption).toDouble();
+    options.processMedianSec = parser.value(processOption).toDouble();
+    options.sigma = parser.value(sigmaOption).toDouble();
+    options.failRate = parser.value(failOption).toDouble();
+    options.throttleRate = parser.value(throttleOption).toDouble();
+    options.errorRate = parser.value(errorOption).toDouble();
+    options.videoBytes = parser.value(videoOption).toLongLong() * 1024;
+    options.seed = parser.value(seedOption).toUInt();
+
+    MockGenerationServer server(options);
+    if (!server.listen(QHostAddress::LocalHost, parser.value(portOption).toUShort())) {
+        std::fprintf(stderr, "cannot listen: %s\n", qPrintable(server.errorString()));
+        return 1;
+    }
+    std::printf("submit URL: %s\nquery URL:  %s\n", qPrintable(server.submitUrl().toString()),
+                qPrintable(server.queryUrl().toString()));
+    std::fflush(stdout);
+
+    QTimer statsTimer;
+    QObject::connect(&statsTimer, &QTimer::timeout, [&server]() {
+        MockGenerationServer::Stats s = server.stats();
+        std::printf("submits %llu  polls %llu  downloads %llu  429 %llu  500 %llu  duplicate %llu\n",
+                    static_cast<unsigned long long>(s.submits), static_cast<unsigned long long>(s.polls),
+                    static_cast<unsigned long long>(s.downloads), static_cast<unsigned long long>(s.throttled),
+                    static_cast<unsigned long long>(s.serverErrors), static_cast<unsigned long long>(s.duplicateSubmits));
+        std::fflush(stdout);
+    });
+    statsTimer.start(5000);
+
+    return app.exec();
+}
@@ -0,0 +1,223 @@
+// 表结构迁移基准：生成 N 个任务的版本 0 数据库（ISO 8601 文本时间、旧索引），
+// 测量列表查询和未完成任务查询的耗时与查询计划，再用 TaskDatabase 打开（迁移到
+// SCHEMA_VERSION，测量迁移耗时），在迁移后的数据库上重复同样的查询。
+//
+// 用法: bench_schema_migration [--tasks N] [--pending P] [--runs R]
+
+#include "services/TaskDatabase.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const char *LEGACY_CONNECTION = "bench-legacy";
+
+// 引入版本号之前的 tasks 表（TaskDatabase::createBaseline）及当时的索引
+const char *LEGACY_SCHEMA[] = {
+    R"(CREATE TABLE tasks (
+        task_id TEXT PRIMARY KEY, prompt TEXT NOT NULL, api_key TEXT, width INTEGER, height INTEGER,
+        resolution TEXT, aspect_ratio TEXT, duration INTEGER, camera_fixed INTEGER, seed INTEGER,
+        status INTEGER, error_message TEXT, video_url TEXT, local_file_path TEXT,
+        create_time TEXT, update_time TEXT, complete_time TEXT,
+        submit_attempts INTEGER DEFAULT 1, submit_latency_ms INTEGER DEFAULT 0, batch_id TEXT,
+        request_hash TEXT, video_hash TEXT, last_played_time TEXT, video_url_expires TEXT))",
+    "CREATE INDEX idx_create_time ON tasks(create_time DESC)",
+    "CREATE INDEX idx_status ON tasks(status)",
+    "CREATE INDEX idx_batch_id ON tasks(batch_id)",
+    "CREATE INDEX idx_request_hash ON tasks(request_hash)",
+    "CREATE INDEX idx_video_hash ON tasks(video_hash)",
+    "CREATE INDEX idx_local_file_path ON tasks(local_file_path)",
+};
+
+const char *LIST_SQL = "SELECT * FROM tasks ORDER BY create_time DESC";
+const char *PENDING_SQL = "SELECT * FROM tasks WHERE status IN (0, 1) ORDER BY create_time DESC";
+
+bool createLegacyDatabase(const QString &path, int tasks, int pending) {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", LEGACY_CONNECTION);
+    db.setDatabaseName(path);
+    if (!db.open()) {
+        std::fprintf(stderr, "%s\n", qPrintable(db.lastError().text()));
+        return false;
+    }
+    QSqlQuery query(db);
+    for (const char *sql : LEGACY_SCHEMA) {
+        if (!query.exec(sql)) {
+            std::fprintf(stderr, "%s\n", qPrintable(query.lastError().text()));
+            return false;
+        }
+    }
+
+    db.transaction();
+    query.prepare(R"(
+        INSERT INTO tasks (task_id, prompt, api_key, width, height, resolution, aspect_ratio, duration,
+                           camera_fixed, seed, status, error_message, video_url, local_file_path,
+                           create_time, update_time, complete_time, batch_id, video_url_expires)
+        VALUES (?, ?, 'sk-bench', 1920, 1080, '1080p', '16:9', 5, 0, ?, ?, '', ?, ?, ?, ?, ?, ?, ?)
+    )");
+    // 最新的 pending 个任务未完成，其余已完成，时间间隔 30 秒；四分之一属于参数扫描
+    QDateTime start = QDateTime::currentDateTime().addSecs(-30LL * tasks);
+    for (int i = 0; i < tasks; ++i) {
+        QDateTime created = start.addSecs(30LL * i);
+        bool done = i < tasks - pending;
+        QString id = QString("bench-%1").arg(i, 8, 10, QChar('0'));
+        query.addBindValue(id);
+        query.addBindValue(QString("A slow dolly shot over a neon city at night, variation %1").arg(i));
+        query.addBindValue(i);
+        query.addBindValue(done ? 2 : i % 2);
+        query.addBindValue(done ? QString("https://cdn.example.com/%1.mp4?Expires=4102444800").arg(id) : QString());
+        query.addBindValue(done ? QString("/videos/%1.mp4").arg(id) : QString());
+        query.addBindValue(created.toString(Qt::ISODate));
+        query.addBindValue(created.addSecs(90).toString(Qt::ISODate));
+        query.addBindValue(done ? created.addSecs(90).toString(Qt::ISODate) : QString());
+        query.addBindValue(i % 4 == 0 ? QVariant(QString("batch-%1").arg(i / 256)) : QVariant());
+        query.addBindValue(done ? QString("2100-01-01T00:00:00Z") : QString());
+        if (!query.exec()) {
+            std::fprintf(stderr, "%s\n", qPrintable(query.lastError().text()));
+            return false;
+        }
+    }
+    db.commit();
+    return true;
+}
+
+// 版本 0 的行解码：每个时间列逐行解析 ISO 8601 文本
+TaskItem legacyTaskFromQuery(QSqlQuery &query) {
+    TaskItem task;
+    task.taskId = query.value("task_id").toString();
+    task.prompt = query.value("prompt").toString();
+    task.apiKey = query.value("api_key").toString();
+    task.width = query.value("width").toInt();
+    task.height = query.value("height").toInt();
+    task.resolution = query.value("resolution").toString();
+    task.aspectRatio = query.value("aspect_ratio").toString();
+    task.duration = query.value("duration").toInt();
+    task.cameraFixed = query.value("camera_fixed").toInt() == 1;
+    task.seed = query.value("seed").toInt();
+    task.status = static_cast<TaskStatus>(query.value("status").toInt());
+    task.errorMessage = query.value("error_message").toString();
+    task.videoUrl = query.value("video_url").toString();
+    task.localFilePath = query.value("local_file_path").toString();
+    task.createTime = QDateTime::fromString(query.value("create_time").toString(), Qt::ISODate);
+    task.updateTime = QDateTime::fromString(query.value("update_time").toString(), Qt::ISODate);
+    task.completeTime = QDateTime::fromString(query.value("complete_time").toString(), Qt::ISODate);
+    task.lastPlayedTime = QDateTime::fromString(query.value("last_played_time").toString(), Qt::ISODate);
+    task.submitAttempts = query.value("submit_attempts").toInt();
+    task.submitLatencyMs = query.value("submit_latency_ms").toLongLong();
+    task.batchId = query.value("batch_id").toString();
+    task.requestHash = query.value("request_hash").toString();
+    task.videoHash = query.value("video_hash").toString();
+    task.videoUrlExpires = QDateTime::fromString(query.value("video_url_expires").toString(), Qt::ISODate);
+    return task;
+}
+
+QList<TaskItem> legacyQuery(const char *sql) {
+    QList<TaskItem> tasks;
+    QSqlQuery query(QSqlDatabase::database(LEGACY_CONNECTION));
+    if (query.exec(sql)) {
+        while (query.next()) {
+            tasks.append(legacyTaskFromQuery(query));
+        }
+    }
+    return tasks;
+}
+
+// 取 runs 次中的最小值，排除页缓存预热和调度干扰
+template <typename F>
+double bestOf(int runs, F work, qsizetype *rows) {
+    double best = 1e9;
+    for (int i = 0; i < runs; ++i) {
+        QElapsedTimer clock;
+        clock.start();
+        *rows = work().size();
+        best = std::min(best, clock.nsecsElapsed() / 1e6);
+    }
+    return best;
+}
+
+QString queryPlan(const QString &connection, const char *sql) {
+    QStringList steps;
+    QSqlQuery query(QSqlDatabase::database(connection));
+    if (query.exec(QString("EXPLAIN QUERY PLAN ") + sql)) {
+        while (query.next()) {
+            steps.append(query.value("detail").toString());
+        }
+    }
+    return steps.join("; ");
+}
+
+void printRow(const char *schema, const char *name, double ms, qsizetype rows, const QString &plan) {
+    std::printf("%-10s %-10s %10.1f %8lld   %s\n", schema, name, ms, static_cast<long long>(rows), qPrintable(plan));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("tasks.db schema migration benchmark: ISO 8601 text timestamps vs. epoch-ms integers and partial indexes");
+    parser.addHelpOption();
+    QCommandLineOption tasksOption("tasks", "Number of tasks.", "N", "100000");
+    QCommandLineOption pendingOption("pending", "Number of pending/processing tasks.", "P", "200");
+    QCommandLineOption runsOption("runs", "Runs per query; the fastest is reported.", "R", "5");
+    parser.addOptions({tasksOption, pendingOption, runsOption});
+    parser.process(app);
+
+    int tasks = qMax(1, parser.value(tasksOption).toInt());
+    int pending = qBound(0, parser.value(pendingOption).toInt(), tasks);
+    int runs = qMax(1, parser.value(runsOption).toInt());
+
+    QTemporaryDir dir;
+    QString path = dir.path() + "/tasks.db";
+    if (!createLegacyDatabase(path, tasks, pending)) {
+        return 1;
+    }
+    qint64 legacyBytes = QFileInfo(path).size();
+
+    std::printf("%d tasks (%d pending), best of %d runs\n", tasks, pending, runs);
+    std::printf("%-10s %-10s %10s %8s   %s\n", "schema", "query", "ms", "rows", "plan");
+    qsizetype rows = 0;
+    double ms = bestOf(runs, [] { return legacyQuery(LIST_SQL); }, &rows);
+    printRow("v0", "list", ms, rows, queryPlan(LEGACY_CONNECTION, LIST_SQL));
+    ms = bestOf(runs, [] { return legacyQuery(PENDING_SQL); }, &rows);
+    printRow("v0", "pending", ms, rows, queryPlan(LEGACY_CONNECTION, PENDING_SQL));
+    QSqlDatabase::removeDatabase(LEGACY_CONNECTION);
+
+    TaskDatabase db;
+    QObject::connect(&db, &TaskDatabase::databaseError, [](const QString &error) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+    });
+    QElapsedTimer clock;
+    clock.start();
+    if (!db.open(path, "bench-migrated")) {
+        return 1;
+    }
+    double migrationMs = clock.nsecsElapsed() / 1e6;
+
+    // TaskDatabase 的连接不对外公开，另开一个连接读取查询计划
+    QString planConnection = "bench-plan";
+    {
+        QSqlDatabase plans = QSqlDatabase::addDatabase("QSQLITE", planConnection);
+        plans.setDatabaseName(path);
+        plans.open();
+    }
+    ms = bestOf(runs, [&] { return db.getAllTasks(); }, &rows);
+    printRow("v1", "list", ms, rows, queryPlan(planConnection, LIST_SQL));
+    ms = bestOf(runs, [&] { return db.getPendingTasks(); }, &rows);
+    printRow("v1", "pending", ms, rows, queryPlan(planConnection, PENDING_SQL));
+    QSqlDatabase::removeDatabase(planConnection);
+    db.close();
+
+    std::printf("\nmigration v0 -> v%d: %.0f ms, file %.1f MB -> %.1f MB\n", TaskDatabase::SCHEMA_VERSION, migrationMs,
+                legacyBytes / 1048576.0,
+                (QFileInfo(path).size() + QFileInfo(path + "-wal").size()) / 1048576.0);
+    return 0;
+}
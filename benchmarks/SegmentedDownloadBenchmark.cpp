@@ -0,0 +1,239 @@
+// 分段下载吞吐量基准：在本地启动一个模拟高延迟 CDN 的 HTTP 服务器
+// （每个连接限速 + 首字节延迟，支持 Range / If-Range / keep-alive），
+// 分别以 K = 1, 2, 4, 8 个连接下载同一文件并比较耗时和吞吐量。
+//
+// 用法: bench_segmented_download [--size MB] [--rate KB/s] [--latency ms] [--runs N] [--client-limit KB/s]
+
+#include "services/SegmentedDownload.h"
+#include "services/NetworkClient.h"
+#include "services/DownloadScheduler.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+// 本地测试服务器。每个连接按 bytesPerSecond 限速发送，模拟单个 TCP 连接在高 RTT 链路上的吞吐上限。
+class ThrottledHttpServer : public QTcpServer {
+public:
+    ThrottledHttpServer(qint64 payloadSize, qint64 bytesPerSecond, int latencyMs, QObject *parent = nullptr)
+        : QTcpServer(parent), rate(bytesPerSecond), latency(latencyMs) {
+        payload.resize(payloadSize);
+        for (qint64 i = 0; i < payloadSize; ++i) {
+            payload[i] = static_cast<char>((i * 131) & 0xff);
+        }
+        // 最小的 MP4 顶层结构（ftyp、空 moov、覆盖其余内容的 mdat），使下载通过完整性检查
+        QByteArray head("\0\0\0\x10" "ftypisom\0\0\x02\0" "\0\0\0\x08" "moov", 24);
+        QByteArray mdat(8, '\0');
+        qToBigEndian<quint32>(static_cast<quint32>(payloadSize - head.size()), mdat.data());
+        mdat.replace(4, 4, "mdat");
+        payload.replace(0, head.size() + mdat.size(), head + mdat);
+    }
+
+    qint64 connectionsAccepted = 0;
+
+protected:
+    void incomingConnection(qintptr handle) override {
+        auto *socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(handle);
+        connectionsAccepted++;
+
+        auto state = std::make_shared<ConnectionState>();
+        state->timer = new QTimer(socket);
+        state->timer->setInterval(TICK_MS);
+
+        connect(socket, &QTcpSocket::readyRead, socket, [this, socket, state]() {
+            state->input += socket->readAll();
+            if (!state->sending) {
+                processNextRequest(socket, state);
+            }
+        });
+        connect(state->timer, &QTimer::timeout, socket, [this, socket, state]() {
+            sendTick(socket, state);
+        });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    }
+
+private:
+    struct ConnectionState {
+        QByteArray input;
+        QTimer *timer = nullptr;
+        bool sending = false;
+        qint64 position = 0;
+        qint64 end = 0;  // 不包含
+    };
+
+    static const int TICK_MS = 10;
+
+    void processNextRequest(QTcpSocket *socket, const std::shared_ptr<ConnectionState> &state) {
+        int headerEnd = state->input.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            return;
+        }
+        QByteArray header = state->input.left(headerEnd);
+        state->input.remove(0, headerEnd + 4);
+
+        const QByteArray etag = "\"bench-payload\"";
+        qint64 size = payload.size();
+        qint64 start = 0;
+        qint64 end = size;
+        bool partial = false;
+
+        QByteArray range;
+        QByteArray ifRange;
+        for (const QByteArray &line : header.split('\n')) {
+            QByteArray trimmed = line.trimmed();
+            if (trimmed.toLower().startsWith("range:")) {
+                range = trimmed.mid(6).trimmed();
+            } else if (trimmed.toLower().startsWith("if-range:")) {
+                ifRange = trimmed.mid(9).trimmed();
+            }
+        }
+        if (range.startsWith("bytes=") && (ifRange.isEmpty() || ifRange == etag)) {
+            QList<QByteArray> bounds = range.mid(6).split('-');
+            start = bounds.value(0).toLongLong();
+            end = bounds.value(1).isEmpty() ? size : qMin(size, bounds.value(1).toLongLong() + 1);
+            partial = true;
+        }
+
+        QByteArray response = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+        response += "Content-Type: video/mp4\r\n";
+        response += "Accept-Ranges: bytes\r\n";
+        response += "ETag: " + etag + "\r\n";
+        response += "Content-Length: " + QByteArray::number(end - start) + "\r\n";
+        if (partial) {
+            response += "Content-Range: bytes " + QByteArray::number(start) + "-" + QByteArray::number(end - 1)
+                        + "/" + QByteArray::number(size) + "\r\n";
+        }
+        response += "Connection: keep-alive\r\n\r\n";
+
+        state->sending = true;
+        state->position = start;
+        state->end = end;
+        // 首字节延迟模拟往返时间
+        QTimer::singleShot(latency, socket, [socket, state, response]() {
+            socket->write(response);
+            state->timer->start();
+        });
+    }
+
+    void sendTick(QTcpSocket *socket, const std::shared_ptr<ConnectionState> &state) {
+        qint64 quota = qMax<qint64>(1, rate * TICK_MS / 1000);
+        qint64 n = qMin(quota, state->end - state->position);
+        if (n > 0) {
+            socket->write(payload.constData() + state->position, n);
+            state->position += n;
+        }
+        if (state->position >= state->end) {
+            state->timer->stop();
+            state->sending = false;
+            processNextRequest(socket, state);  // keep-alive：处理同一连接上排队的请求
+        }
+    }
+
+    QByteArray payload;
+    qint64 rate;
+    int latency;
+};
+
+struct RunResult {
+    bool ok = false;
+    double seconds = 0;
+    bool segmented = false;
+};
+
+RunResult runOnce(const QUrl &url, const QString &destPath, int segments) {
+    NetworkClient client;  // 每次运行使用新的连接池，保证冷启动条件一致
+    client.setMaxConnectionsPerHost(qMax(6, segments));
+    SegmentedDownload download(&client, url, destPath, segments);
+
+    RunResult result;
+    QEventLoop loop;
+    QObject::connect(&download, &SegmentedDownload::finished, &loop, [&](const QString &) {
+        result.ok = true;
+        loop.quit();
+    });
+    QObject::connect(&download, &SegmentedDownload::failed, &loop, [&](const QString &error) {
+        std::fprintf(stderr, "download failed: %s\n", qPrintable(error));
+        loop.quit();
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    download.start();
+    loop.exec();
+    result.seconds = timer.nsecsElapsed() / 1e9;
+    result.segmented = download.isSegmented();
+    QFile::remove(destPath);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Segmented download throughput benchmark");
+    parser.addHelpOption();
+    QCommandLineOption sizeOption("size", "Payload size in MB.", "MB", "32");
+    QCommandLineOption rateOption("rate", "Per-connection bandwidth in KB/s.", "KBps", "2048");
+    QCommandLineOption latencyOption("latency", "Time to first byte in ms.", "ms", "150");
+    QCommandLineOption runsOption("runs", "Runs per segment count.", "N", "3");
+    QCommandLineOption clientLimitOption("client-limit", "Client-side bandwidth cap in KB/s (0 = none).", "KBps", "0");
+    parser.addOptions({sizeOption, rateOption, latencyOption, runsOption, clientLimitOption});
+    parser.process(app);
+
+    qint64 size = parser.value(sizeOption).toLongLong() * 1024 * 1024;
+    qint64 rate = parser.value(rateOption).toLongLong() * 1024;
+    int latency = parser.value(latencyOption).toInt();
+    int runs = qMax(1, parser.value(runsOption).toInt());
+
+    // 不使用设置中的带宽上限，默认只测量连接数带来的吞吐差异
+    DownloadScheduler::instance()->setBandwidthLimit(parser.value(clientLimitOption).toLongLong() * 1024);
+
+    ThrottledHttpServer server(size, rate, latency);
+    if (!server.listen(QHostAddress::LocalHost)) {
+        std::fprintf(stderr, "cannot listen: %s\n", qPrintable(server.errorString()));
+        return 1;
+    }
+    QUrl url(QString("http://127.0.0.1:%1/video.mp4").arg(server.serverPort()));
+
+    QTemporaryDir dir;
+    QString destPath = dir.filePath("bench.mp4");
+
+    std::printf("payload %.1f MB, per-connection %lld KB/s, latency %d ms, %d runs\n",
+                size / 1048576.0, rate / 1024, latency, runs);
+    std::printf("%4s %10s %10s %12s %10s\n", "K", "mode", "best(s)", "MB/s", "speedup");
+
+    double baseline = 0;
+    for (int k : {1, 2, 4, 8}) {
+        double best = -1;
+        bool segmented = false;
+        for (int i = 0; i < runs; ++i) {
+            RunResult result = runOnce(url, destPath, k);
+            if (!result.ok) {
+                return 1;
+            }
+            segmented = result.segmented;
+            if (best < 0 || result.seconds < best) {
+                best = result.seconds;
+            }
+        }
+        if (k == 1) {
+            baseline = best;
+        }
+        std::printf("%4d %10s %10.3f %12.2f %9.2fx\n", k, segmented ? "segmented" : "single",
+                    best, size / 1048576.0 / best, baseline / best);
+    }
+    std::printf("connections accepted: %lld\n", server.connectionsAccepted);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// 任务行解码基准：在临时数据库中写入 N 个任务，比较
+//   - SELECT * 并按列名读取（投影查询之前的做法），
+//   - 详情投影（全部列，按列序号解码为 TaskItem），
+//   - 列表投影（历史列表所需的列，解码为 TaskSummary），
+//   - 轮询投影（未完成任务的 ID 和 API Key，解码为 PendingTask）
+// 读取并解码全部行的耗时。
+//
+// 用法: bench_task_decode [--tasks N] [--runs R]
+
+#include "services/TaskDatabase.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const char *BY_NAME_CONNECTION = "bench-by-name";
+
+TaskItem makeTask(int i, const QDateTime &start) {
+    TaskItem task;
+    task.taskId = QString("bench-%1").arg(i, 8, 10, QChar('0'));
+    // 实际提示词通常有几百个字符
+    task.prompt = QString("A slow dolly shot over a neon city at night, rain on the streets, reflections in puddles, "
+                          "volumetric fog, cinematic lighting, shallow depth of field, variation %1").arg(i);
+    task.apiKey = "sk-bench-0123456789abcdef";
+    task.width = 1920;
+    task.height = 1080;
+    task.resolution = "1080p";
+    task.aspectRatio = "16:9";
+    task.duration = 5;
+    task.seed = i;
+    task.status = TaskStatus::Completed;
+    task.videoUrl = QString("https://cdn.example.com/%1.mp4?Expires=4102444800&Signature=abcdef0123456789").arg(task.taskId);
+    task.localFilePath = QString("/videos/store/%1.mp4").arg(task.taskId);
+    task.batchId = i % 4 == 0 ? QString("batch-%1").arg(i / 256) : QString();
+    task.createTime = start.addSecs(30LL * i);
+    task.updateTime = task.createTime.addSecs(90);
+    task.completeTime = task.updateTime;
+    return task;
+}
+
+// 投影查询之前的解码：SELECT * 后逐列按名称查找
+TaskItem taskByName(const QSqlQuery &query) {
+    auto time = [&](const char *column) {
+        QVariant value = query.value(column);
+        return value.isNull() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(value.toLongLong());
+    };
+    TaskItem task;
+    task.taskId = query.value("task_id").toString();
+    task.prompt = query.value("prompt").toString();
+    task.apiKey = query.value("api_key").toString();
+    task.width = query.value("width").toInt();
+    task.height = query.value("height").toInt();
+    task.resolution = query.value("resolution").toString();
+    task.aspectRatio = query.value("aspect_ratio").toString();
+    task.duration = query.value("duration").toInt();
+    task.cameraFixed = query.value("camera_fixed").toInt() == 1;
+    task.seed = query.value("seed").toInt();
+    task.status = static_cast<TaskStatus>(query.value("status").toInt());
+    task.errorMessage = query.value("error_message").toString();
+    task.videoUrl = query.value("video_url").toString();
+    task.localFilePath = query.value("local_file_path").toString();
+    task.createTime = time("create_time");
+    task.updateTime = time("update_time");
+    task.completeTime = time("complete_time");
+    task.lastPlayedTime = time("last_played_time");
+    task.submitAttempts = query.value("submit_attempts").toInt();
+    task.submitLatencyMs = query.value("submit_latency_ms").toLongLong();
+    task.batchId = query.value("batch_id").toString();
+    task.requestHash = query.value("request_hash").toString();
+    task.videoHash = query.value("video_hash").toString();
+    task.videoUrlExpires = time("video_url_expires");
+    return task;
+}
+
+QList<TaskItem> selectAllByName() {
+    QList<TaskItem> tasks;
+    QSqlQuery query(QSqlDatabase::database(BY_NAME_CONNECTION));
+    if (query.exec("SELECT * FROM tasks ORDER BY create_time DESC")) {
+        while (query.next()) {
+            tasks.append(taskByName(query));
+        }
+    }
+    return tasks;
+}
+
+// 取 runs 次中的最小值
+template <typename F>
+double bestOf(int runs, F work, qsizetype *rows) {
+    double best = 1e9;
+    for (int i = 0; i < runs; ++i) {
+        QElapsedTimer clock;
+        clock.start();
+        *rows = work().size();
+        best = std::min(best, clock.nsecsElapsed() / 1e6);
+    }
+    return best;
+}
+
+void printRow(const char *name, double ms, qsizetype rows) {
+    std::printf("%-22s %10.1f %8lld %12.0f\n", name, ms, static_cast<long long>(rows),
+                ms > 0 ? rows * 1000.0 / ms : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("tasks.db row decoding benchmark: SELECT * by column name vs. projections by ordinal");
+    parser.addHelpOption();
+    QCommandLineOption tasksOption("tasks", "Number of tasks.", "N", "100000");
+    QCommandLineOption runsOption("runs", "Runs per query; the fastest is reported.", "R", "5");
+    parser.addOptions({tasksOption, runsOption});
+    parser.process(app);
+
+    int tasks = qMax(1, parser.value(tasksOption).toInt());
+    int runs = qMax(1, parser.value(runsOption).toInt());
+
+    QTemporaryDir dir;
+    QString path = dir.path() + "/tasks.db";
+    TaskDatabase db;
+    QObject::connect(&db, &TaskDatabase::databaseError, [](const QString &error) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+    });
+    if (!db.open(path, "bench-projection")) {
+        return 1;
+    }
+
+    // 一半任务处于处理中，轮询投影读取其中的 N/2 行
+    QDateTime start = QDateTime::currentDateTime().addSecs(-30LL * tasks);
+    for (int first = 0; first < tasks; first += 1000) {
+        db.transaction([&]() {
+            for (int i = first; i < qMin(tasks, first + 1000); ++i) {
+                TaskItem task = makeTask(i, start);
+                if (i % 2 == 1) {
+                    task.status = TaskStatus::Processing;
+                }
+                if (!db.saveTask(task)) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    {
+        QSqlDatabase byName = QSqlDatabase::addDatabase("QSQLITE", BY_NAME_CONNECTION);
+        byName.setDatabaseName(path);
+        byName.open();
+    }
+
+    std::printf("%d tasks (half pending), best of %d runs\n", tasks, runs);
+    std::printf("%-22s %10s %8s %12s\n", "query", "ms", "rows", "rows/s");
+    qsizetype rows = 0;
+    double ms = bestOf(runs, selectAllByName, &rows);
+    printRow("select * by name", ms, rows);
+    ms = bestOf(runs, [&] { return db.getAllTasks(); }, &rows);
+    printRow("detail by ordinal", ms, rows);
+    ms = bestOf(runs, [&] { return db.getTaskSummaries(); }, &rows);
+    printRow("list projection", ms, rows);
+    ms = bestOf(runs, [&] { return db.getPendingTasks(); }, &rows);
+    printRow("pending projection", ms, rows);
+
+    QSqlDatabase::removeDatabase(BY_NAME_CONNECTION);
+    db.close();
+    return 0;
+}
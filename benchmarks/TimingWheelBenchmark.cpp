@@ -0,0 +1,208 @@
+// 轮询截止时间调度基准：N 个任务各自按随机间隔重复查询 R 次，
+// 比较"每个任务一个 QTimer"与共用一个 tick 的 TimingWheel 的
+// 插入/重排耗时、事件循环 CPU 时间和触发延迟。
+//
+// 用法: bench_timing_wheel [--tasks N] [--min ms] [--max ms] [--rounds R] [--tick ms]
+
+#include "services/TimingWheel.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+struct Result {
+    double scheduleMs = 0;    // 插入 N 个截止时间
+    double rescheduleMs = 0;  // 取消并重新插入 N 个截止时间
+    double runSeconds = 0;    // 全部触发完成的墙钟时间
+    double cpuSeconds = 0;    // 运行阶段的进程 CPU 时间
+    double meanLateMs = 0;
+    double p99LateMs = 0;
+    int maxDuePerTick = 0;
+};
+
+// 每个任务的下一次截止时间序列，两种实现使用同一份数据
+struct Workload {
+    std::vector<std::vector<int>> delays;  // [task][round]
+};
+
+Workload makeWorkload(int tasks, int rounds, int minMs, int maxMs) {
+    Workload workload;
+    QRandomGenerator rng(42);
+    workload.delays.resize(tasks);
+    for (auto &taskDelays : workload.delays) {
+        for (int r = 0; r < rounds; ++r) {
+            taskDelays.push_back(minMs + static_cast<int>(rng.bounded(maxMs - minMs + 1)));
+        }
+    }
+    return workload;
+}
+
+void summarize(std::vector<qint64> &lateness, Result &result) {
+    if (lateness.empty()) {
+        return;
+    }
+    std::sort(lateness.begin(), lateness.end());
+    double sum = 0;
+    for (qint64 ns : lateness) {
+        sum += ns;
+    }
+    result.meanLateMs = sum / lateness.size() / 1e6;
+    result.p99LateMs = lateness[std::min(lateness.size() - 1, lateness.size() * 99 / 100)] / 1e6;
+}
+
+Result runQTimers(const Workload &workload) {
+    int tasks = static_cast<int>(workload.delays.size());
+    int rounds = static_cast<int>(workload.delays.front().size());
+    Result result;
+    QElapsedTimer clock;
+    clock.start();
+
+    std::vector<QTimer *> timers(tasks);
+    std::vector<qint64> deadlines(tasks);
+    std::vector<int> round(tasks, 0);
+    std::vector<qint64> lateness;
+    lateness.reserve(static_cast<size_t>(tasks) * rounds);
+    int remaining = tasks;
+    QEventLoop loop;
+
+    QElapsedTimer phase;
+    phase.start();
+    for (int i = 0; i < tasks; ++i) {
+        timers[i] = new QTimer;
+        timers[i]->setSingleShot(true);
+        QObject::connect(timers[i], &QTimer::timeout, [&, i]() {
+            lateness.push_back(clock.nsecsElapsed() - deadlines[i]);
+            if (++round[i] < rounds) {
+                int delay = workload.delays[i][round[i]];
+                deadlines[i] = clock.nsecsElapsed() + delay * 1000000LL;
+                timers[i]->start(delay);
+            } else if (--remaining == 0) {
+                loop.quit();
+            }
+        });
+        deadlines[i] = clock.nsecsElapsed() + workload.delays[i][0] * 1000000LL;
+        timers[i]->start(workload.delays[i][0]);
+    }
+    result.scheduleMs = phase.nsecsElapsed() / 1e6;
+
+    // 模拟退避间隔变化：全部取消后按同样的间隔重新设置
+    phase.restart();
+    for (int i = 0; i < tasks; ++i) {
+        timers[i]->stop();
+        deadlines[i] = clock.nsecsElapsed() + workload.delays[i][0] * 1000000LL;
+        timers[i]->start(workload.delays[i][0]);
+    }
+    result.rescheduleMs = phase.nsecsElapsed() / 1e6;
+
+    phase.restart();
+    std::clock_t cpuStart = std::clock();
+    loop.exec();
+    result.cpuSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    result.runSeconds = phase.nsecsElapsed() / 1e9;
+
+    qDeleteAll(timers);
+    summarize(lateness, result);
+    return result;
+}
+
+Result runWheel(const Workload &workload, int tickMs) {
+    int tasks = static_cast<int>(workload.delays.size());
+    int rounds = static_cast<int>(workload.delays.front().size());
+    Result result;
+    QElapsedTimer clock;
+    clock.start();
+
+    TimingWheel wheel(tickMs);
+    std::vector<TimingWheel::TimerId> ids(tasks);
+    std::vector<qint64> deadlines(tasks);
+    std::vector<int> round(tasks, 0);
+    std::vector<qint64> lateness;
+    lateness.reserve(static_cast<size_t>(tasks) * rounds);
+    int remaining = tasks;
+    QEventLoop loop;
+
+    std::function<void(int)> arm = [&](int i) {
+        int delay = workload.delays[i][round[i]];
+        deadlines[i] = clock.nsecsElapsed() + delay * 1000000LL;
+        ids[i] = wheel.schedule(delay, [&, i]() {
+            lateness.push_back(clock.nsecsElapsed() - deadlines[i]);
+            if (++round[i] < rounds) {
+                arm(i);
+            } else if (--remaining == 0) {
+                loop.quit();
+            }
+        });
+    };
+
+    QElapsedTimer phase;
+    phase.start();
+    for (int i = 0; i < tasks; ++i) {
+        arm(i);
+    }
+    result.scheduleMs = phase.nsecsElapsed() / 1e6;
+
+    phase.restart();
+    for (int i = 0; i < tasks; ++i) {
+        wheel.cancel(ids[i]);
+        arm(i);
+    }
+    result.rescheduleMs = phase.nsecsElapsed() / 1e6;
+
+    phase.restart();
+    std::clock_t cpuStart = std::clock();
+    loop.exec();
+    result.cpuSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    result.runSeconds = phase.nsecsElapsed() / 1e9;
+
+    result.maxDuePerTick = wheel.maxDueCount();
+    summarize(lateness, result);
+    return result;
+}
+
+void printRow(const char *name, const Result &r) {
+    std::printf("%-12s %12.2f %14.2f %10.2f %10.3f %12.2f %11.2f", name, r.scheduleMs, r.rescheduleMs,
+                r.runSeconds, r.cpuSeconds, r.meanLateMs, r.p99LateMs);
+    if (r.maxDuePerTick > 0) {
+        std::printf(" %10d", r.maxDuePerTick);
+    }
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Timing wheel vs. per-task QTimer benchmark");
+    parser.addHelpOption();
+    QCommandLineOption tasksOption("tasks", "Number of tasks.", "N", "10000");
+    QCommandLineOption minOption("min", "Minimum poll interval in ms.", "ms", "200");
+    QCommandLineOption maxOption("max", "Maximum poll interval in ms.", "ms", "2000");
+    QCommandLineOption roundsOption("rounds", "Polls per task.", "R", "3");
+    QCommandLineOption tickOption("tick", "Timing wheel tick in ms.", "ms", "100");
+    parser.addOptions({tasksOption, minOption, maxOption, roundsOption, tickOption});
+    parser.process(app);
+
+    int tasks = qMax(1, parser.value(tasksOption).toInt());
+    int minMs = qMax(0, parser.value(minOption).toInt());
+    int maxMs = qMax(minMs, parser.value(maxOption).toInt());
+    int rounds = qMax(1, parser.value(roundsOption).toInt());
+    int tickMs = qMax(1, parser.value(tickOption).toInt());
+
+    Workload workload = makeWorkload(tasks, rounds, minMs, maxMs);
+
+    std::printf("%d tasks x %d polls, interval %d-%d ms, wheel tick %d ms\n", tasks, rounds, minMs, maxMs, tickMs);
+    std::printf("%-12s %12s %14s %10s %10s %12s %11s %10s\n", "impl", "schedule(ms)", "reschedule(ms)",
+                "run(s)", "cpu(s)", "mean late", "p99 late", "max due");
+    printRow("QTimer x N", runQTimers(workload));
+    printRow("TimingWheel", runWheel(workload, tickMs));
+    return 0;
+}
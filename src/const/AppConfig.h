@@ -14,6 +14,39 @@ namespace Config {
     // Settings Keys
     const QString KEY_SAVE_PATH = "savePath";
     const QString KEY_API_TOKEN = "apiKey";
+    const QString KEY_MAX_CONCURRENT_TASKS = "maxConcurrentTasks";
+    const QString KEY_DOWNLOAD_SEGMENTS = "downloadSegments";
+    const QString KEY_MAX_CONNECTIONS_PER_HOST = "maxConnectionsPerHost";
+    const QString KEY_POLL_REQUESTS_PER_SECOND = "pollRequestsPerSecond";
+    const QString KEY_USE_REQUEST_CACHE = "useRequestCache";
+    const QString KEY_VIDEO_STORE_QUOTA_GB = "videoStoreQuotaGb";
+    const QString KEY_MAX_CONCURRENT_DOWNLOADS = "maxConcurrentDownloads";
+    const QString KEY_DOWNLOAD_BANDWIDTH_KBPS = "downloadBandwidthKbps";
+    const QString KEY_LAST_VIDEO_SCRUB = "lastVideoScrub";
+
+    // 并发生成任务数上限（默认值）
+    const int DEFAULT_MAX_CONCURRENT_TASKS = 3;
+
+    // 单个视频下载的并行连接数，1 表示单连接（支持跨重启断点续传）
+    const int DEFAULT_DOWNLOAD_SEGMENTS = 1;
+
+    // 共享网络客户端每个主机的 HTTP/1.1 连接上限
+    const int DEFAULT_MAX_CONNECTIONS_PER_HOST = 6;
+
+    // 所有任务状态查询合计的每秒请求数上限
+    const double DEFAULT_POLL_REQUESTS_PER_SECOND = 5.0;
+
+    // 本地视频存储的容量上限（GB），0 表示不限制；超出时淘汰最久未播放且可重新下载的视频
+    const int DEFAULT_VIDEO_STORE_QUOTA_GB = 0;
+
+    // 同时进行的视频下载数上限，超出的按优先级排队（播放请求不受此限制）
+    const int DEFAULT_MAX_CONCURRENT_DOWNLOADS = 3;
+
+    // 所有视频下载合计的带宽上限（KB/s），0 表示不限制
+    const int DEFAULT_DOWNLOAD_BANDWIDTH_KBPS = 0;
+
+    // 后台重新校验本地视频存储的间隔（天）
+    const int VIDEO_SCRUB_INTERVAL_DAYS = 7;
 }
 
 #endif // APPCONFIG_H
\ No newline at end of file
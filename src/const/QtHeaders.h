@@ -43,6 +43,7 @@
 #include <QScrollArea>
 #include <QCheckBox>
 #include <QComboBox>
+#include <QSpinBox>
 
 // Qt GUI
 #include <QPixmap>
@@ -1,15 +1,129 @@
 #include "ui/MainWindow.h"
 #include "ui/SetupDialog.h"
 #include "const/AppConfig.h"
+#include "services/BatchRunner.h"
+#include "services/NetworkClient.h"
+#include "services/TrafficRecorder.h"
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QSettings>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// 录制 / 回放 API 流量，用于离线复现和性能分析
+struct TrafficOptions {
+    QCommandLineOption record{"record-traffic", "Record API traffic to <file>.", "file"};
+    QCommandLineOption replay{"replay-traffic", "Answer API requests from a recording instead of the network.", "file"};
+    QCommandLineOption speed{"replay-speed", "Replay timing speed-up factor.", "factor", "1.0"};
+
+    void addTo(QCommandLineParser &parser) const {
+        parser.addOptions({record, replay, speed});
+    }
+
+    bool apply(const QCommandLineParser &parser) const {
+        if (!parser.isSet(record) && !parser.isSet(replay)) {
+            return true;
+        }
+        TrafficRecorder *recorder = new TrafficRecorder(NetworkClient::instance());
+        bool started = parser.isSet(replay) ? recorder->loadReplay(parser.value(replay), parser.value(speed).toDouble())
+                                            : recorder->startRecording(parser.value(record));
+        if (started) {
+            NetworkClient::instance()->setTrafficRecorder(recorder);
+        }
+        return started;
+    }
+};
+
+bool isBatchMode(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        // 只匹配 --batch 和 --batch=file，不匹配 --batch-size 等以它开头的参数
+        if (std::strcmp(argv[i], "--batch") == 0 || std::strncmp(argv[i], "--batch=", 8) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 无界面批处理：QCoreApplication，不显示 SetupDialog 和 MainWindow
+int runBatch(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName(Config::ORG_NAME);
+    QCoreApplication::setApplicationName(Config::APP_NAME);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless batch generation. Progress is printed to stdout as JSON lines.");
+    parser.addHelpOption();
+    QCommandLineOption batchOption("batch", "JSONL or CSV file of prompts, parameters and optional image paths.", "file");
+    QCommandLineOption concurrencyOption("concurrency", "Maximum tasks generating at once.", "N",
+                                         QString::number(Config::DEFAULT_MAX_CONCURRENT_TASKS));
+    QCommandLineOption outputOption("output", "Directory for downloaded videos (default: configured save path).", "dir");
+    QCommandLineOption apiKeyOption("api-key", "API key (default: ISEE_API_KEY or the configured key).", "key");
+    QCommandLineOption noCacheOption("no-cache", "Always generate, even if an identical request already has a video.");
+    parser.addOptions({batchOption, concurrencyOption, outputOption, apiKeyOption, noCacheOption});
+    TrafficOptions traffic;
+    traffic.addTo(parser);
+    parser.process(app);
+
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    QString apiKey = parser.value(apiKeyOption);
+    if (apiKey.isEmpty()) {
+        apiKey = qEnvironmentVariable("ISEE_API_KEY", settings.value(Config::KEY_API_TOKEN).toString());
+    }
+    if (apiKey.isEmpty()) {
+        std::fprintf(stderr, "No API key: pass --api-key or set ISEE_API_KEY\n");
+        return 1;
+    }
+    QString outputDir = parser.isSet(outputOption) ? parser.value(outputOption) : settings.value(Config::KEY_SAVE_PATH).toString();
+    if (outputDir.isEmpty()) {
+        std::fprintf(stderr, "No output directory: pass --output or configure a save path\n");
+        return 1;
+    }
+    if (!traffic.apply(parser)) {
+        std::fprintf(stderr, "Cannot open traffic recording\n");
+        return 1;
+    }
+
+    QString error;
+    QList<BatchItem> items = BatchRunner::loadItems(parser.value(batchOption), &error);
+    if (!error.isEmpty()) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    BatchRunner runner(apiKey);
+    runner.setConcurrency(parser.value(concurrencyOption).toInt());
+    runner.setOutputDir(outputDir);
+    runner.setUseRequestCache(!parser.isSet(noCacheOption));
+    QObject::connect(&runner, &BatchRunner::finished, &app, &QCoreApplication::exit);
+    QTimer::singleShot(0, &runner, [&runner, items]() { runner.start(items); });
+    return app.exec();
+}
+
+} // namespace
 
 int main(int argc, char *argv[]) {
+    if (isBatchMode(argc, argv)) {
+        return runBatch(argc, argv);
+    }
+
     QApplication a(argc, argv);
 
     QCoreApplication::setOrganizationName(Config::ORG_NAME);
     QCoreApplication::setApplicationName(Config::APP_NAME);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    TrafficOptions traffic;
+    traffic.addTo(parser);
+    parser.process(a);
+
+    if (!traffic.apply(parser)) {
+        QMessageBox::critical(nullptr, "错误", "无法打开流量录制文件");
+        return 1;
+    }
+
     QSettings settings;
     if (!settings.contains(Config::KEY_SAVE_PATH)) {
         SetupDialog setup;
@@ -22,4 +136,4 @@ int main(int argc, char *argv[]) {
     w.show();
 
     return a.exec();
-}
\ No newline at end of file
+}
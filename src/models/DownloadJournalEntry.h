@@ -0,0 +1,23 @@
+#ifndef DOWNLOADJOURNALENTRY_H
+#define DOWNLOADJOURNALENTRY_H
+
+#include <QString>
+#include <QDateTime>
+
+// 未完成下载的断点记录，对应 tasks.db 中的 download_journal 表
+struct DownloadJournalEntry {
+    QString destPath;       // 最终文件路径（主键），暂存文件为 destPath + ".part"
+    QString taskId;
+    QString url;
+    qint64 bytesDone = 0;   // 已写入暂存文件的字节数
+    qint64 totalBytes = -1; // 完整文件大小，未知为 -1
+    QString etag;           // 用于 If-Range 校验
+    QString lastModified;   // 没有强 ETag 时使用
+    QDateTime updateTime;
+
+    bool isValid() const {
+        return !destPath.isEmpty();
+    }
+};
+
+#endif // DOWNLOADJOURNALENTRY_H
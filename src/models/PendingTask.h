@@ -0,0 +1,13 @@
+#ifndef PENDINGTASK_H
+#define PENDINGTASK_H
+
+#include "TaskItem.h"
+
+// 轮询未完成任务所需的列（轮询投影）
+struct PendingTask {
+    QString taskId;
+    QString apiKey;
+    TaskStatus status = TaskStatus::Pending;
+};
+
+#endif // PENDINGTASK_H
@@ -11,6 +11,16 @@ enum class TaskStatus {
     Failed        // 失败
 };
 
+inline QString taskStatusString(TaskStatus status) {
+    switch(status) {
+        case TaskStatus::Pending: return "等待中";
+        case TaskStatus::Processing: return "处理中";
+        case TaskStatus::Completed: return "已完成";
+        case TaskStatus::Failed: return "失败";
+        default: return "未知";
+    }
+}
+
 struct TaskItem {
     QString taskId;
     QString prompt;
@@ -29,22 +39,31 @@ struct TaskItem {
     TaskStatus status = TaskStatus::Pending;
     QString errorMessage;
     QString videoUrl;
+    QDateTime videoUrlExpires;  // 从签名 URL 解析的过期时间（UTC），无法识别时无效
     QString localFilePath;
 
+    // 参数扫描：同一次扫描提交的任务共用一个批次 ID，单独提交的任务为空
+    QString batchId;
+
+    // 结果缓存：规范化请求的 SHA-256，相同请求可直接复用已完成任务的视频；随机种子的请求为空
+    QString requestHash;
+
+    // 内容寻址存储中视频的 SHA-256，localFilePath 为其在存储中的路径；旧版本下载的视频为空
+    QString videoHash;
+
+    // 提交统计
+    int submitAttempts = 1;      // 提交尝试次数（含重试）
+    qint64 submitLatencyMs = 0;  // 从首次提交到收到最终响应的耗时
+
     // 时间戳
     QDateTime createTime;
     QDateTime updateTime;
     QDateTime completeTime;
+    QDateTime lastPlayedTime;  // 最近一次播放，本地存储按此淘汰最久未播放的视频
 
     // 辅助方法
     QString statusString() const {
-        switch(status) {
-            case TaskStatus::Pending: return "等待中";
-            case TaskStatus::Processing: return "处理中";
-            case TaskStatus::Completed: return "已完成";
-            case TaskStatus::Failed: return "失败";
-            default: return "未知";
-        }
+        return taskStatusString(status);
     }
 
     bool isFinished() const {
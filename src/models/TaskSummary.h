@@ -0,0 +1,53 @@
+#ifndef TASKSUMMARY_H
+#define TASKSUMMARY_H
+
+#include "TaskItem.h"
+
+// 任务列表一行所需的列（列表投影），不含 API Key、请求参数和错误信息；详情另行读取 TaskItem
+struct TaskSummary {
+    // prompt 只读取前 PROMPT_PREVIEW_LENGTH + 1 个字符：多出的一个表示原文更长，显示时加省略号
+    static constexpr int PROMPT_PREVIEW_LENGTH = 30;
+
+    QString taskId;
+    QString prompt;
+    TaskStatus status = TaskStatus::Pending;
+    QString videoUrl;
+    QString localFilePath;
+    QDateTime createTime;
+    QDateTime completeTime;
+
+    static TaskSummary fromTask(const TaskItem &task) {
+        TaskSummary summary;
+        summary.taskId = task.taskId;
+        summary.prompt = task.prompt.left(PROMPT_PREVIEW_LENGTH + 1);
+        summary.status = task.status;
+        summary.videoUrl = task.videoUrl;
+        summary.localFilePath = task.localFilePath;
+        summary.createTime = task.createTime;
+        summary.completeTime = task.completeTime;
+        return summary;
+    }
+
+    QString statusString() const {
+        return taskStatusString(status);
+    }
+};
+
+// 列表中一行的位置：按 (createTime, taskId) 排序，键集分页从某个键之后继续读取
+struct TaskPageKey {
+    qint64 createTime = 0;  // 毫秒时间戳，与 tasks.create_time 一致
+    QString taskId;         // 为空表示从头开始
+
+    bool isNull() const {
+        return taskId.isEmpty();
+    }
+
+    static TaskPageKey of(const TaskSummary &task) {
+        TaskPageKey key;
+        key.createTime = task.createTime.toMSecsSinceEpoch();
+        key.taskId = task.taskId;
+        return key;
+    }
+};
+
+#endif // TASKSUMMARY_H
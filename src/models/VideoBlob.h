@@ -0,0 +1,15 @@
+#ifndef VIDEOBLOB_H
+#define VIDEOBLOB_H
+
+#include <QString>
+#include <QDateTime>
+
+// 内容寻址存储中的一个视频，对应 tasks.db 中的 video_blobs 表
+struct VideoBlob {
+    QString hash;       // 内容的 SHA-256（主键）
+    QString path;       // 在存储中的路径
+    qint64 size = 0;
+    QDateTime lastUsed; // 引用它的任务中最近的播放时间（从未播放时取完成时间）
+};
+
+#endif // VIDEOBLOB_H
@@ -1,17 +1,20 @@
 #include "ApiService.h"
 #include "const/AppConfig.h"
+#include "SegmentedDownload.h"
+#include "VideoStore.h"
+#include "NetworkClient.h"
+#include "RateLimiter.h"
+#include <QUuid>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QRandomGenerator>
-#include <QFile>
-#include <QFileInfo>
-#include <QStandardPaths>
 
-ApiService::ApiService(QObject *parent) : QObject(parent) {
-    manager = new QNetworkAccessManager(this);
+ApiService::ApiService(QObject *parent, NetworkClient *client)
+    : QObject(parent), network(client ? client : NetworkClient::instance()), limiter(RateLimiter::instance()),
+      downloadJournal(nullptr), store(nullptr) {
     loadApiUrls();
 }
 
@@ -26,6 +29,9 @@ void ApiService::loadApiUrls() {
     qDebug() << "API URLs loaded:";
     qDebug() << "  Submit:" << submitUrl << (submitUrl == Config::SUBMIT_URL ? "(default)" : "(custom)");
     qDebug() << "  Query:" << queryUrl << (queryUrl == Config::QUERY_URL ? "(default)" : "(custom)");
+
+    // 提前建立到 API 主机的连接，后续提交和轮询复用
+    network->warmUp(QUrl(submitUrl));
 }
 
 void ApiService::setSubmitUrl(const QString &url) {
@@ -50,12 +56,24 @@ QString ApiService::getQueryUrl() const {
     return queryUrl;
 }
 
+void ApiService::setDownloadJournal(TaskDatabaseService *journal) {
+    downloadJournal = journal;
+}
+
+void ApiService::setVideoStore(VideoStore *videoStore) {
+    store = videoStore;
+}
+
+VideoStore *ApiService::videoStore() const {
+    return store;
+}
+
 void ApiService::reloadApiUrls() {
     loadApiUrls();
     qDebug() << "API URLs reloaded";
 }
 
-void ApiService::submitTask(const QString &apiKey, const QString &prompt) {
+void ApiService::submitTask(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params, const QString &requestTag) {
     QNetworkRequest request{QUrl(submitUrl)};
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json; charset=utf-8");
     request.setRawHeader("Authorization", ("Bearer " + apiKey).toUtf8());
@@ -63,12 +81,13 @@ void ApiService::submitTask(const QString &apiKey, const QString &prompt) {
     QJsonObject json;
     // json["model"] = "seedance-v1-pro-t2v";
     json["prompt"] = prompt;
-    json["width"] = 1280;
-    json["resolution"] = "1080p";
-    json["aspect_ratio"] = "16:9";
-    json["duration"] = 5;  // API 只接受 5 或 10
-    json["camera_fixed"] = false;
-    json["seed"] = 123;
+    json["width"] = params.value("width", "1280").toInt();
+    // 使用用户配置的参数，如果没有则使用默认值
+    json["resolution"] = params.value("resolution", "1080p");
+    json["aspect_ratio"] = params.value("aspect_ratio", "16:9");
+    json["duration"] = params.value("duration", "5").toInt();  // API 只接受 5 或 10
+    json["camera_fixed"] = (params.value("camera_fixed", "false") == "true");
+    json["seed"] = params.value("seed", "123").toInt();
     // json["height"] = 720;
     // json["video_length"] = 5;
     // json["seed"] = QRandomGenerator::global()->bounded(1000000);
@@ -76,31 +95,10 @@ void ApiService::submitTask(const QString &apiKey, const QString &prompt) {
     QByteArray jsonData = QJsonDocument(json).toJson(QJsonDocument::Compact);
     qDebug() << "Submitting JSON:" << QString::fromUtf8(jsonData);
 
-    QNetworkReply *reply = manager->post(request, jsonData);
-    connect(reply, &QNetworkReply::finished, this, [=, this]() {
-        reply->deleteLater();
-        if (reply->error()) {
-            QByteArray responseData = reply->readAll();
-            QString errorDetails = QString::fromUtf8(responseData);
-            qDebug() << "HTTP Error:" << reply->error() << reply->errorString();
-            qDebug() << "Server Response:" << errorDetails;
-            emit errorOccurred("提交失败: " + reply->errorString() + "\n详情: " + errorDetails);
-            return;
-        }
-        QByteArray responseData = reply->readAll();
-        qDebug() << "Success Response:" << QString::fromUtf8(responseData);
-        QJsonObject resp = QJsonDocument::fromJson(responseData).object();
-        QString taskId;
-        if(resp.contains("task_id")) taskId = resp["task_id"].toString();
-        else if(resp.contains("id")) taskId = resp["id"].toString();
-        else if(resp.contains("data")) taskId = resp["data"].toObject()["id"].toString();
-
-        if(!taskId.isEmpty()) emit taskSubmitted(taskId);
-        else emit errorOccurred("未获取到 Task ID");
-    });
+    submitWithRetry(apiKey, request, jsonData, requestTag, "提交失败: ");
 }
 
-void ApiService::submitImageToVideoTask(const QString &apiKey, const QString &prompt, const QString &imageData, const QString &lastImageData, const QMap<QString, QString> &params) {
+void ApiService::submitImageToVideoTask(const QString &apiKey, const QString &prompt, const QString &imageData, const QString &lastImageData, const QMap<QString, QString> &params, const QString &requestTag) {
     // 使用图生视频的 API 端点
     QString i2vUrl = submitUrl;
     // 如果当前是 t2v 端点，替换为 i2v
@@ -132,30 +130,101 @@ void ApiService::submitImageToVideoTask(const QString &apiKey, const QString &pr
     QByteArray jsonData = QJsonDocument(json).toJson(QJsonDocument::Compact);
     qDebug() << "Submitting Image-to-Video JSON:" << QString::fromUtf8(jsonData).left(500) << "...";  // 限制日志长度
 
-    QNetworkReply *reply = manager->post(request, jsonData);
-    connect(reply, &QNetworkReply::finished, this, [=, this]() {
-        reply->deleteLater();
-        if (reply->error()) {
-            QByteArray responseData = reply->readAll();
-            QString errorDetails = QString::fromUtf8(responseData);
-            qDebug() << "HTTP Error:" << reply->error() << reply->errorString();
-            qDebug() << "Server Response:" << errorDetails;
-            emit errorOccurred("图生视频提交失败: " + reply->errorString() + "\n详情: " + errorDetails);
+    submitWithRetry(apiKey, request, jsonData, requestTag, "图生视频提交失败: ");
+}
+
+void ApiService::submitWithRetry(const QString &apiKey, QNetworkRequest request, const QByteArray &body,
+                                 const QString &requestTag, const QString &errorPrefix) {
+    // 同一次提交的所有重试共用一个幂等键，服务端据此去重，避免超时重试重复创建付费任务
+    request.setRawHeader("Idempotency-Key", QUuid::createUuid().toString(QUuid::WithoutBraces).toUtf8());
+    request.setTransferTimeout(SUBMIT_TIMEOUT_MS);
+
+    auto submit = std::make_shared<PendingSubmit>();
+    submit->apiKey = apiKey;
+    submit->request = request;
+    submit->body = body;
+    submit->requestTag = requestTag;
+    submit->errorPrefix = errorPrefix;
+    submit->started.start();
+    sendSubmitAttempt(submit);
+}
+
+void ApiService::sendSubmitAttempt(std::shared_ptr<PendingSubmit> submit) {
+    submit->attempts++;
+    sendLimited(RateLimiter::Endpoint::Submit, submit->apiKey, [=, this]() {
+        return network->post(submit->request, submit->body, NetworkClient::Traffic::Api);
+    }, [=, this](QNetworkReply *reply) {
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (reply->error() != QNetworkReply::NoError && retryPolicy.shouldRetry(submit->attempts, reply->error(), status)) {
+            int delay = retryPolicy.delayForAttempt(submit->attempts);
+            qDebug() << "Submit" << submit->requestTag << "attempt" << submit->attempts << "failed:"
+                     << reply->errorString() << ", retrying in" << delay << "ms";
+            emit submissionRetrying(submit->requestTag, submit->attempts, delay, reply->errorString());
+            QTimer::singleShot(delay, this, [=, this]() {
+                sendSubmitAttempt(submit);
+            });
             return;
         }
-        QByteArray responseData = reply->readAll();
-        qDebug() << "Success Response:" << QString::fromUtf8(responseData);
-        QJsonObject resp = QJsonDocument::fromJson(responseData).object();
-        QString taskId;
-        if(resp.contains("task_id")) taskId = resp["task_id"].toString();
-        else if(resp.contains("id")) taskId = resp["id"].toString();
-        else if(resp.contains("data")) taskId = resp["data"].toObject()["id"].toString();
+        emit submissionMetrics(submit->requestTag, submit->attempts, submit->started.elapsed());
+        handleSubmitReply(reply, submit->requestTag, submit->errorPrefix);
+    });
+}
 
-        if(!taskId.isEmpty()) emit taskSubmitted(taskId);
-        else emit errorOccurred("未获取到 Task ID");
+void ApiService::sendLimited(RateLimiter::Endpoint endpoint, const QString &apiKey,
+                             std::function<QNetworkReply *()> send, std::function<void(QNetworkReply *)> onFinished,
+                             int throttleRetries) {
+    limiter->acquire(endpoint, apiKey, this, [=, this]() {
+        QNetworkReply *reply = send();
+        // 以共享的限流器为上下文归还槽位：本对象在请求途中销毁时也要归还，否则该桶的并发数永久减少。
+        // 先于下面的连接建立，重新排队之前已经归还
+        RateLimiter *sharedLimiter = limiter;
+        connect(reply, &QNetworkReply::finished, sharedLimiter, [=]() {
+            reply->deleteLater();
+            int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            sharedLimiter->release(endpoint, apiKey, status, reply->rawHeader("Retry-After"));
+        });
+        connect(reply, &QNetworkReply::finished, this, [=, this]() {
+            int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+            // 被限流的请求重新排队，等 Retry-After 之后再发，而不是直接判定失败
+            if (RateLimiter::isThrottleStatus(status) && throttleRetries < MAX_THROTTLE_RETRIES) {
+                qDebug() << "Request throttled with HTTP" << status << ", requeueing (" << throttleRetries + 1 << ")";
+                sendLimited(endpoint, apiKey, send, onFinished, throttleRetries + 1);
+                return;
+            }
+            onFinished(reply);
+        });
     });
 }
 
+void ApiService::handleSubmitReply(QNetworkReply *reply, const QString &requestTag, const QString &errorPrefix) {
+    if (reply->error()) {
+        QByteArray responseData = reply->readAll();
+        QString errorDetails = QString::fromUtf8(responseData);
+        qDebug() << "HTTP Error:" << reply->error() << reply->errorString();
+        qDebug() << "Server Response:" << errorDetails;
+        QString msg = errorPrefix + reply->errorString() + "\n详情: " + errorDetails;
+        emit submissionFailed(requestTag, msg);
+        emit errorOccurred(msg);
+        return;
+    }
+    QByteArray responseData = reply->readAll();
+    qDebug() << "Success Response:" << QString::fromUtf8(responseData);
+    QJsonObject resp = QJsonDocument::fromJson(responseData).object();
+    QString taskId;
+    if(resp.contains("task_id")) taskId = resp["task_id"].toString();
+    else if(resp.contains("id")) taskId = resp["id"].toString();
+    else if(resp.contains("data")) taskId = resp["data"].toObject()["id"].toString();
+
+    if(!taskId.isEmpty()) {
+        emit submissionSucceeded(requestTag, taskId);
+        emit taskSubmitted(taskId);
+    } else {
+        emit submissionFailed(requestTag, "未获取到 Task ID");
+        emit errorOccurred("未获取到 Task ID");
+    }
+}
+
 void ApiService::pollTask(const QString &apiKey, const QString &taskId) {
     // 使用查询参数而不是路径参数
     QString urlStr = queryUrl + "?task_id=" + taskId;
@@ -163,12 +232,12 @@ void ApiService::pollTask(const QString &apiKey, const QString &taskId) {
     QNetworkRequest request{QUrl(urlStr)};
     request.setRawHeader("Authorization", ("Bearer " + apiKey).toUtf8());
 
-    QNetworkReply *reply = manager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [=, this]() {
-        reply->deleteLater();
+    sendLimited(RateLimiter::Endpoint::Poll, apiKey, [=, this]() {
+        return network->get(request, NetworkClient::Traffic::Poll);
+    }, [=, this](QNetworkReply *reply) {
         if(reply->error()) {
             emit errorOccurred("轮询失败: " + reply->errorString());
-            emit taskPolled(taskId, false, "", reply->errorString());
+            emit taskPolled(taskId, false, "", reply->errorString(), false);
             return;
         }
 
@@ -193,7 +262,7 @@ void ApiService::pollTask(const QString &apiKey, const QString &taskId) {
 
             qDebug() << "Task succeeded, video URL:" << videoUrl;
             emit taskFinished(true, videoUrl, "");
-            emit taskPolled(taskId, true, videoUrl, "");
+            emit taskPolled(taskId, true, videoUrl, "", false);
         } else if (status == "TASK_STATUS_FAILED") {
             QString error = taskObj["reason"].toString();
             if (error.isEmpty()) {
@@ -201,17 +270,18 @@ void ApiService::pollTask(const QString &apiKey, const QString &taskId) {
             }
             qDebug() << "Task failed:" << error;
             emit taskFinished(false, "", error);
-            emit taskPolled(taskId, false, "", error);
+            emit taskPolled(taskId, false, "", error, true);
         } else if (status == "TASK_STATUS_PROCESSING" || status == "TASK_STATUS_QUEUED") {
             // 仍在处理中或排队中
             int progressPercent = taskObj["progress_percent"].toInt();
             qDebug() << "Task processing, progress:" << progressPercent << "%";
+            emit taskStatusUpdated(taskId, status, progressPercent);
             emit errorOccurred("STATUS_PROCESSING"); // 用一个特殊字��通知 VM 继续
-            emit taskPolled(taskId, false, "", "STATUS_PROCESSING");
+            emit taskPolled(taskId, false, "", "STATUS_PROCESSING", false);
         } else {
             // 未知状态
             qDebug() << "Unknown task status:" << status;
-            emit taskPolled(taskId, false, "", "未知状态: " + status);
+            emit taskPolled(taskId, false, "", "未知状态: " + status, false);
         }
     });
 }
@@ -224,10 +294,9 @@ void ApiService::pollAllTasks(const QString &apiKey) {
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", ("Bearer " + apiKey).toUtf8());
 
-    qDebug();
-    QNetworkReply *reply = manager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [=, this]() {
-        reply->deleteLater();
+    sendLimited(RateLimiter::Endpoint::Poll, apiKey, [=, this]() {
+        return network->get(request, NetworkClient::Traffic::Poll);
+    }, [=, this](QNetworkReply *reply) {
         if(reply->error()) {
             qDebug() << "Batch poll failed:" << reply->errorString();
             emit errorOccurred("批量查询失败: " + reply->errorString());
@@ -258,33 +327,74 @@ void ApiService::pollAllTasks(const QString &apiKey) {
                     QJsonObject videoObj = videos[0].toObject();
                     videoUrl = videoObj["video_url"].toString();
                 }
-                emit taskPolled(taskId, true, videoUrl, "");
+                emit taskPolled(taskId, true, videoUrl, "", false);
             } else if (status == "TASK_STATUS_FAILED") {
                 QString error = taskObj["reason"].toString();
-                emit taskPolled(taskId, false, "", error);
+                emit taskPolled(taskId, false, "", error, true);
             } else {
-                emit taskPolled(taskId, false, "", "STATUS_PROCESSING");
+                emit taskPolled(taskId, false, "", "STATUS_PROCESSING", false);
             }
         }
     });
 }
 
-void ApiService::downloadVideo(const QString &url) {
-    QNetworkRequest request{QUrl(url)};
-    QNetworkReply *reply = manager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [=, this]() {
-        reply->deleteLater();
-        if(reply->error()) {
-            emit errorOccurred("下载失败");
-            return;
+void ApiService::downloadVideo(const QString &url, const QString &destPath, const QString &taskId,
+                               DownloadScheduler::Priority priority) {
+    enqueueDownload(url, destPath, taskId, priority, 0);
+}
+
+void ApiService::enqueueDownload(const QString &url, const QString &destPath, const QString &taskId,
+                                 DownloadScheduler::Priority priority, int integrityRetries) {
+    // 全局排队：有空闲的下载槽位（播放请求立即）时才开始，本对象销毁后不再启动；
+    // 排队期间签名 URL 可能被换新，以启动时的 URL 为准
+    DownloadScheduler::instance()->enqueue(taskId, url, priority, this,
+                                           [=, this](quint64 schedulerId, const QString &currentUrl) {
+        startDownload(currentUrl, destPath, taskId, schedulerId, priority, integrityRetries);
+    });
+}
+
+void ApiService::startDownload(const QString &url, const QString &destPath, const QString &taskId, quint64 schedulerId,
+                               DownloadScheduler::Priority priority, int integrityRetries) {
+    // 流式写入 destPath 旁的暂存文件，完成后原子重命名；分段数大于 1 时多连接并行下载
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    int segments = settings.value(Config::KEY_DOWNLOAD_SEGMENTS, Config::DEFAULT_DOWNLOAD_SEGMENTS).toInt();
+    SegmentedDownload *download = new SegmentedDownload(network, QUrl(url), destPath, segments, this);
+    if (downloadJournal) {
+        download->setJournal(downloadJournal, taskId);
+    }
+    download->setSchedulerId(schedulerId);
+    DownloadScheduler *scheduler = DownloadScheduler::instance();
+    connect(download, &SegmentedDownload::finished, this, [=, this](const QString &downloadedPath) {
+        download->deleteLater();
+        scheduler->finished(schedulerId, true);
+        QString localPath = downloadedPath;
+        if (store) {
+            localPath = store->add(downloadedPath, download->contentHash(), taskId);
+            if (localPath.isEmpty()) {
+                emit downloadFailed(taskId, "无法将视频移入存储");
+                emit errorOccurred("下载失败");
+                return;
+            }
         }
-        // 临时保存到缓存目录，实际保存逻辑由 ViewModel/HistoryService 处理
-        QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/temp_video.mp4";
-        QFile file(tempPath);
-        if(file.open(QIODevice::WriteOnly)) {
-            file.write(reply->readAll());
-            file.close();
-            emit videoDownloaded(tempPath);
+        emit videoDownloadedForTask(taskId, localPath);
+        emit videoDownloaded(localPath);
+    });
+    connect(download, &SegmentedDownload::failed, this, [=, this](const QString &error) {
+        download->deleteLater();
+        scheduler->finished(schedulerId, false);
+        qDebug() << "Download failed for" << url << ":" << error;
+        if (download->integrityFailed() && integrityRetries < MAX_INTEGRITY_RETRIES) {
+            // 内容损坏（截断、字节数不符、不是完整的 MP4）：损坏的文件已删除，重新排队从头下载
+            qWarning() << "Re-queueing corrupt download for task" << taskId << ", attempt" << integrityRetries + 1;
+            enqueueDownload(url, destPath, taskId, priority, integrityRetries + 1);
+            return;
         }
+        emit downloadFailed(taskId, error);
+        emit errorOccurred("下载失败");
     });
-}
\ No newline at end of file
+    connect(download, &SegmentedDownload::progress, this, [=, this](qint64 bytesReceived, qint64 bytesTotal) {
+        scheduler->progress(schedulerId, bytesReceived, bytesTotal);
+        emit downloadProgress(taskId, bytesReceived, bytesTotal);
+    });
+    download->start();
+}
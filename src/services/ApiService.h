@@ -2,16 +2,31 @@
 #define APISERVICE_H
 
 #include "const/QtHeaders.h"
+#include "DownloadScheduler.h"
+#include "RateLimiter.h"
+#include "RetryPolicy.h"
+#include <QElapsedTimer>
+#include <QNetworkRequest>
+#include <functional>
+#include <memory>
+
+class TaskDatabaseService;
+class NetworkClient;
+class VideoStore;
 
 class ApiService : public QObject {
     Q_OBJECT
 public:
-    explicit ApiService(QObject *parent = nullptr);
-    void submitTask(const QString &apiKey, const QString &prompt);
-    void submitImageToVideoTask(const QString &apiKey, const QString &prompt, const QString &imageData, const QString &lastImageData = "", const QMap<QString, QString> &params = QMap<QString, QString>());
-    void pollTask(const QString &apiKey, const QString &taskId);
+    // client 为空时使用应用共享的 NetworkClient::instance()
+    explicit ApiService(QObject *parent = nullptr, NetworkClient *client = nullptr);
+    // requestTag 用于并发提交时区分各个请求的结果（见 submissionSucceeded / submissionFailed）
+    void submitTask(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params = QMap<QString, QString>(), const QString &requestTag = "");
+    void submitImageToVideoTask(const QString &apiKey, const QString &prompt, const QString &imageData, const QString &lastImageData = "", const QMap<QString, QString> &params = QMap<QString, QString>(), const QString &requestTag = "");
+    void pollTask(const QString &apiKey, const QString &taskId);  // 应用内查询请经由 PollScheduler 合并和限速
     void pollAllTasks(const QString &apiKey);  // 新增：批量查询所有任务
-    void downloadVideo(const QString &url);
+    // 经由 DownloadScheduler 按优先级排队，轮到时才发出请求
+    void downloadVideo(const QString &url, const QString &destPath, const QString &taskId = "",
+                       DownloadScheduler::Priority priority = DownloadScheduler::Priority::Fresh);
 
     // API 端点配置
     void setSubmitUrl(const QString &url);
@@ -20,20 +35,69 @@ public:
     QString getQueryUrl() const;
     void reloadApiUrls();  // 重新加载 API URLs
 
+    // 设置后下载支持断点续传（日志保存在 tasks.db）
+    void setDownloadJournal(TaskDatabaseService *journal);
+    // 设置后下载完成的视频移入内容寻址存储，videoDownloaded 信号给出存储中的路径
+    void setVideoStore(VideoStore *store);
+    VideoStore *videoStore() const;
+
 signals:
     void taskSubmitted(const QString &taskId);
     void taskFinished(bool success, const QString &result, const QString &errorMsg); // result is URL if success
-    void taskPolled(const QString &taskId, bool success, const QString &videoUrl, const QString &error); // 任务轮询结果
+    void taskPolled(const QString &taskId, bool success, const QString &videoUrl, const QString &error,
+                    bool failed); // 任务轮询结果；failed 仅在服务端明确返回失败时为 true
     void allTasksPolled(const QJsonObject &response); // 新增：批量查询结果
+    void taskStatusUpdated(const QString &taskId, const QString &status, int progressPercent); // 排队/处理中的原始状态
     void videoDownloaded(const QString &localPath);
     void errorOccurred(const QString &msg);
 
+    // 带请求标识的结果信号，供多任务调度使用
+    void submissionSucceeded(const QString &requestTag, const QString &taskId);
+    void submissionFailed(const QString &requestTag, const QString &error);
+    void submissionRetrying(const QString &requestTag, int attempt, int delayMs, const QString &error);
+    void submissionMetrics(const QString &requestTag, int attempts, qint64 latencyMs);  // 在成功/失败信号之前发出
+    void videoDownloadedForTask(const QString &taskId, const QString &localPath);
+    void downloadFailed(const QString &taskId, const QString &error);
+    void downloadProgress(const QString &taskId, qint64 bytesReceived, qint64 bytesTotal);
+
 private:
-    QNetworkAccessManager *manager;
+    NetworkClient *network;
+    RateLimiter *limiter;  // 应用共享，按端点和 API Key 限流
+    RetryPolicy retryPolicy;
     QString submitUrl;  // 提交任务的 URL
     QString queryUrl;   // 查询任务的 URL
+    TaskDatabaseService *downloadJournal;
+    VideoStore *store;
 
     void loadApiUrls();  // 从设置加载 API URL
+    // integrityRetries：因内容损坏已重新下载的次数
+    void enqueueDownload(const QString &url, const QString &destPath, const QString &taskId,
+                         DownloadScheduler::Priority priority, int integrityRetries);
+    void startDownload(const QString &url, const QString &destPath, const QString &taskId, quint64 schedulerId,
+                       DownloadScheduler::Priority priority, int integrityRetries);
+    void handleSubmitReply(QNetworkReply *reply, const QString &requestTag, const QString &errorPrefix);
+    // 经限流器发出请求；429/503 时按 Retry-After 重新排队，onFinished 只收到最终的响应
+    void sendLimited(RateLimiter::Endpoint endpoint, const QString &apiKey, std::function<QNetworkReply *()> send,
+                     std::function<void(QNetworkReply *)> onFinished, int throttleRetries = 0);
+
+    // 一次提交的重试状态
+    struct PendingSubmit {
+        QString apiKey;
+        QNetworkRequest request;
+        QByteArray body;
+        QString requestTag;
+        QString errorPrefix;
+        int attempts = 0;
+        QElapsedTimer started;
+    };
+
+    void submitWithRetry(const QString &apiKey, QNetworkRequest request, const QByteArray &body,
+                         const QString &requestTag, const QString &errorPrefix);
+    void sendSubmitAttempt(std::shared_ptr<PendingSubmit> submit);
+
+    static const int MAX_THROTTLE_RETRIES = 5;
+    static const int MAX_INTEGRITY_RETRIES = 2;  // 下载内容损坏时自动重新下载的次数
+    static const int SUBMIT_TIMEOUT_MS = 60000;  // 单次提交的传输超时，超时后按重试策略重试
 };
 
 #endif // APISERVICE_H
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include "BatchRunner.h"
+#include "ApiService.h"
+#include "DownloadScheduler.h"
+#include "HistoryService.h"
+#include "TaskDatabaseService.h"
+#include "VideoStore.h"
+#include "const/AppConfig.h"
+#include "utils/ImageUtils.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+
+namespace {
+
+// 输入中除以下字段外的列/键都作为请求参数
+bool isItemField(const QString &name) {
+    return name == "prompt" || name == "image" || name == "last_image";
+}
+
+QString valueToString(const QJsonValue &value) {
+    if (value.isBool()) {
+        return value.toBool() ? "true" : "false";
+    }
+    if (value.isDouble()) {
+        return QString::number(value.toDouble());
+    }
+    return value.toString();
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(const QString &apiKey, QObject *parent)
+    : QObject(parent), apiKey(apiKey), nextItem(0), pendingItem(-1), inProgress(0),
+      concurrency(Config::DEFAULT_MAX_CONCURRENT_TASKS), saved(0), failed(0) {
+    apiService = new ApiService(this);
+    historyService = new HistoryService(this);
+    dbService = new TaskDatabaseService(this);
+
+    if (!dbService->initialize()) {
+        qWarning() << "Failed to initialize task database";
+    }
+
+    apiService->setDownloadJournal(dbService);
+    apiService->setVideoStore(new VideoStore(dbService, historyService, this));
+    taskManager = new GenerationTaskManager(apiService, dbService, historyService, this);
+
+    connect(taskManager, &GenerationTaskManager::jobStateChanged, this, &BatchRunner::onJobStateChanged);
+    connect(taskManager, &GenerationTaskManager::jobProgress, this, &BatchRunner::onJobProgress);
+    connect(taskManager, &GenerationTaskManager::jobSaved, this, &BatchRunner::onJobSaved);
+    connect(taskManager, &GenerationTaskManager::jobFailed, this, &BatchRunner::onJobFailed);
+}
+
+QList<BatchItem> BatchRunner::loadItems(const QString &path, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("无法打开输入文件 %1: %2").arg(path, file.errorString());
+        return {};
+    }
+    QByteArray data = file.readAll();
+    if (QFileInfo(path).suffix().toLower() == "csv") {
+        return parseCsv(data, error);
+    }
+    return parseJsonLines(data, error);
+}
+
+QList<BatchItem> BatchRunner::parseJsonLines(const QByteArray &data, QString *error) {
+    QList<BatchItem> result;
+    const QList<QByteArray> lines = data.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        QByteArray line = lines[i].trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            *error = QString("第 %1 行不是有效的 JSON 对象: %2").arg(i + 1).arg(parseError.errorString());
+            return {};
+        }
+
+        QJsonObject obj = doc.object();
+        BatchItem item;
+        item.line = i + 1;
+        item.prompt = obj["prompt"].toString();
+        item.imagePath = obj["image"].toString();
+        item.lastImagePath = obj["last_image"].toString();
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            if (!isItemField(it.key())) {
+                item.params.insert(it.key(), valueToString(it.value()));
+            }
+        }
+        result.append(item);
+    }
+    return result;
+}
+
+QList<BatchItem> BatchRunner::parseCsv(const QByteArray &data, QString *error) {
+    // RFC 4180：字段可用双引号包裹，引号内可含逗号、换行，"" 表示一个引号
+    QList<QStringList> records;
+    QList<int> recordLines;
+    QStringList record;
+    QString field;
+    bool quoted = false;
+    int line = 1;
+    int recordLine = 1;
+    const QString text = QString::fromUtf8(data);
+
+    for (int i = 0; i < text.size(); ++i) {
+        QChar c = text[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < text.size() && text[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                if (c == '\n') {
+                    ++line;
+                }
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            record.append(field);
+            field.clear();
+        } else if (c == '\n' || c == '\r') {
+            if (c == '\r' && i + 1 < text.size() && text[i + 1] == '\n') {
+                ++i;
+            }
+            record.append(field);
+            field.clear();
+            if (!(record.size() == 1 && record.first().trimmed().isEmpty())) {
+                records.append(record);
+                recordLines.append(recordLine);
+            }
+            record.clear();
+            recordLine = ++line;
+        } else {
+            field += c;
+        }
+    }
+    if (quoted) {
+        *error = QString("第 %1 行的引号未闭合").arg(recordLine);
+        return {};
+    }
+    if (!field.isEmpty() || !record.isEmpty()) {
+        record.append(field);
+        records.append(record);
+        recordLines.append(recordLine);
+    }
+
+    if (records.isEmpty()) {
+        return {};
+    }
+    QStringList header = records.takeFirst();
+    recordLines.removeFirst();
+    for (QString &name : header) {
+        name = name.trimmed();
+    }
+    if (!header.contains("prompt") && !header.contains("image")) {
+        *error = "CSV 首行需要包含 prompt 或 image 列";
+        return {};
+    }
+
+    QList<BatchItem> result;
+    for (int r = 0; r < records.size(); ++r) {
+        const QStringList &values = records[r];
+        BatchItem item;
+        item.line = recordLines[r];
+        for (int c = 0; c < header.size(); ++c) {
+            QString value = values.value(c).trimmed();
+            if (header[c] == "prompt") {
+                item.prompt = value;
+            } else if (header[c] == "image") {
+                item.imagePath = value;
+            } else if (header[c] == "last_image") {
+                item.lastImagePath = value;
+            } else if (!value.isEmpty()) {
+                item.params.insert(header[c], value);
+            }
+        }
+        result.append(item);
+    }
+    return result;
+}
+
+void BatchRunner::setConcurrency(int value) {
+    concurrency = qMax(1, value);
+    taskManager->setMaxConcurrent(concurrency);
+}
+
+void BatchRunner::setOutputDir(const QString &dir) {
+    historyService->setSavePathOverride(dir);
+}
+
+void BatchRunner::setUseRequestCache(bool enabled) {
+    taskManager->setRequestCacheEnabled(enabled);
+}
+
+void BatchRunner::start(const QList<BatchItem> &batch) {
+    items = batch;
+    clock.start();
+    emitEvent({{"event", "start"}, {"items", static_cast<int>(items.size())}, {"concurrency", concurrency},
+               {"output", historyService->getSavePath()}});
+    feed();
+    if (items.isEmpty()) {
+        finishItem();
+    }
+}
+
+void BatchRunner::feed() {
+    // 图片在交给调度器时才读取，避免整批图片同时驻留内存
+    while (nextItem < items.size() && inProgress < concurrency * FEED_FACTOR) {
+        int index = nextItem++;
+        const BatchItem &item = items[index];
+        inProgress++;
+
+        if (item.imagePath.isEmpty()) {
+            if (item.prompt.isEmpty()) {
+                emitEvent({{"event", "failed"}, {"line", item.line}, {"error", "提示词为空"}});
+                failed++;
+                finishItem();
+                continue;
+            }
+            pendingItem = index;
+            QString jobId = taskManager->enqueueTextToVideo(apiKey, item.prompt, item.params);
+            jobToItem.insert(jobId, index);
+        } else {
+            QString image = ImageUtils::fileToDataUri(item.imagePath);
+            QString lastImage = item.lastImagePath.isEmpty() ? QString() : ImageUtils::fileToDataUri(item.lastImagePath);
+            if (image.isEmpty() || (!item.lastImagePath.isEmpty() && lastImage.isEmpty())) {
+                emitEvent({{"event", "failed"}, {"line", item.line}, {"error", "无法读取图片"}});
+                failed++;
+                finishItem();
+                continue;
+            }
+            pendingItem = index;
+            QString jobId = taskManager->enqueueImageToVideo(apiKey, item.prompt, image, lastImage, item.params);
+            jobToItem.insert(jobId, index);
+        }
+        pendingItem = -1;
+    }
+}
+
+int BatchRunner::itemIndex(const QString &jobId) {
+    auto it = jobToItem.constFind(jobId);
+    if (it != jobToItem.constEnd()) {
+        return *it;
+    }
+    // enqueue 返回之前同步发出的事件（等待、提交中）
+    if (pendingItem >= 0) {
+        jobToItem.insert(jobId, pendingItem);
+        return pendingItem;
+    }
+    return -1;
+}
+
+void BatchRunner::onJobStateChanged(const QString &jobId, GenerationState state, const QString &message) {
+    int index = itemIndex(jobId);
+    if (index < 0) {
+        return;
+    }
+    auto previous = lastState.constFind(jobId);
+    if (previous != lastState.constEnd() && *previous == state) {
+        return;  // 轮询期间的等待时间更新不重复输出
+    }
+    lastState.insert(jobId, state);
+
+    QJsonObject event{{"event", "state"}, {"line", items[index].line}, {"job", jobId},
+                      {"state", stateName(state)}, {"message", message}};
+    GenerationJob job = taskManager->job(jobId);
+    if (!job.taskId.isEmpty()) {
+        taskIds.insert(jobId, job.taskId);
+    }
+    if (taskIds.contains(jobId)) {
+        event["taskId"] = taskIds.value(jobId);
+    }
+    emitEvent(event);
+}
+
+void BatchRunner::onJobProgress(const QString &jobId, int percent) {
+    int index = itemIndex(jobId);
+    if (index >= 0) {
+        emitEvent({{"event", "progress"}, {"line", items[index].line}, {"job", jobId}, {"percent", percent}});
+    }
+}
+
+void BatchRunner::onJobSaved(const QString &jobId, const QString &localPath) {
+    int index = itemIndex(jobId);
+    if (index < 0) {
+        return;
+    }
+    saved++;
+    emitEvent({{"event", "saved"}, {"line", items[index].line}, {"job", jobId},
+               {"taskId", taskIds.take(jobId)}, {"path", localPath}});
+    finishItem();
+}
+
+void BatchRunner::onJobFailed(const QString &jobId, const QString &error) {
+    int index = itemIndex(jobId);
+    if (index < 0) {
+        return;
+    }
+    failed++;
+    emitEvent({{"event", "failed"}, {"line", items[index].line}, {"job", jobId},
+               {"taskId", taskIds.take(jobId)}, {"error", error}});
+    finishItem();
+}
+
+void BatchRunner::finishItem() {
+    inProgress = qMax(0, inProgress - 1);
+    if (nextItem < items.size()) {
+        // 在事件循环中补充，避免在调度器的信号处理中重入 enqueue
+        QTimer::singleShot(0, this, &BatchRunner::feed);
+        return;
+    }
+    if (inProgress > 0) {
+        return;
+    }
+    RequestCacheStats cache = taskManager->requestCacheStats();
+    DownloadStats downloads = DownloadScheduler::instance()->stats();
+    emitEvent({{"event", "done"}, {"saved", saved}, {"failed", failed}, {"elapsedSec", clock.elapsed() / 1000.0},
+               {"cacheHits", static_cast<qint64>(cache.hits)}, {"cacheLookups", static_cast<qint64>(cache.lookups)},
+               {"urlRefreshes", static_cast<qint64>(downloads.urlRefreshes)},
+               {"missedUrlWindows", static_cast<qint64>(downloads.missedWindow)}});
+    emit finished(failed > 0 ? 2 : 0);
+}
+
+void BatchRunner::emitEvent(QJsonObject event) {
+    event["time"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+    QByteArray line = QJsonDocument(event).toJson(QJsonDocument::Compact);
+    std::fwrite(line.constData(), 1, line.size(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+QString BatchRunner::stateName(GenerationState state) {
+    switch (state) {
+        case GenerationState::Waiting: return "waiting";
+        case GenerationState::Submitting: return "submitting";
+        case GenerationState::Queued: return "queued";
+        case GenerationState::Processing: return "processing";
+        case GenerationState::Downloading: return "downloading";
+        case GenerationState::Saved: return "saved";
+        case GenerationState::Failed: return "failed";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "const/QtHeaders.h"
+#include "GenerationTaskManager.h"
+#include <QElapsedTimer>
+
+class ApiService;
+class HistoryService;
+class TaskDatabaseService;
+
+// 批处理输入中的一项
+struct BatchItem {
+    int line = 0;            // 在输入文件中的行号，用于进度输出
+    QString prompt;
+    QString imagePath;       // 非空时为图生视频
+    QString lastImagePath;   // 可选的尾帧
+    QMap<QString, QString> params;  // resolution、duration、seed 等请求参数
+};
+
+// 无界面的批量生成：读取 JSONL 或 CSV，经 GenerationTaskManager 在并发窗口内
+// 提交、轮询、下载，并记录到 tasks.db；进度以每行一个 JSON 事件输出到标准输出。
+class BatchRunner : public QObject {
+    Q_OBJECT
+public:
+    BatchRunner(const QString &apiKey, QObject *parent = nullptr);
+
+    // 按扩展名选择格式：.csv 为 CSV（首行为列名），其余按 JSONL
+    static QList<BatchItem> loadItems(const QString &path, QString *error);
+    static QList<BatchItem> parseJsonLines(const QByteArray &data, QString *error);
+    static QList<BatchItem> parseCsv(const QByteArray &data, QString *error);
+
+    void setConcurrency(int value);
+    void setOutputDir(const QString &dir);  // 覆盖设置中的保存路径
+    void setUseRequestCache(bool enabled);  // 关闭后相同的请求也重新生成
+    void start(const QList<BatchItem> &items);
+
+signals:
+    void finished(int exitCode);  // 0 全部成功，2 有失败的项
+
+private slots:
+    void onJobStateChanged(const QString &jobId, GenerationState state, const QString &message);
+    void onJobProgress(const QString &jobId, int percent);
+    void onJobSaved(const QString &jobId, const QString &localPath);
+    void onJobFailed(const QString &jobId, const QString &error);
+
+private:
+    void feed();  // 保持最多 concurrency × FEED_FACTOR 个任务交给调度器
+    void finishItem();
+    void emitEvent(QJsonObject event);
+    int itemIndex(const QString &jobId);
+    static QString stateName(GenerationState state);
+
+    QString apiKey;
+    ApiService *apiService;
+    TaskDatabaseService *dbService;
+    HistoryService *historyService;
+    GenerationTaskManager *taskManager;
+
+    QList<BatchItem> items;
+    int nextItem;
+    int pendingItem;  // enqueue 期间同步发出的事件归属的项
+    int inProgress;
+    int concurrency;
+    int saved;
+    int failed;
+    QMap<QString, int> jobToItem;
+    QMap<QString, GenerationState> lastState;
+    QMap<QString, QString> taskIds;  // jobId -> taskId；任务结束时调度器已移除 job，需提前记录
+    QElapsedTimer clock;
+
+    static const int FEED_FACTOR = 2;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,76 @@
+#include "CompletionTimeModel.h"
+#include <QDebug>
+#include <algorithm>
+
+void CompletionTimeModel::load(const QList<TaskItem> &tasks) {
+    byParams.clear();
+    byResolution.clear();
+    all.clear();
+
+    // 查询结果按完成时间倒序，反向加入以保证每组保留的是最近的样本
+    for (auto it = tasks.crbegin(); it != tasks.crend(); ++it) {
+        if (!it->createTime.isValid() || !it->completeTime.isValid()) {
+            continue;
+        }
+        addSample(it->resolution, it->duration, it->createTime.msecsTo(it->completeTime) / 1000.0);
+    }
+    qDebug() << "Completion time model loaded" << all.size() << "samples in" << byParams.size() << "groups";
+}
+
+void CompletionTimeModel::addSample(const QString &resolution, int duration, double seconds) {
+    // 丢弃明显异常的记录（时钟调整、手动导入的任务等）
+    if (seconds <= 0 || seconds > 6 * 3600) {
+        return;
+    }
+    append(byParams[groupKey(resolution, duration)], seconds);
+    append(byResolution[resolution], seconds);
+    append(all, seconds);
+}
+
+CompletionEstimate CompletionTimeModel::estimate(const QString &resolution, int duration) const {
+    const QVector<double> &exact = byParams.value(groupKey(resolution, duration));
+    if (exact.size() >= MIN_SAMPLES) {
+        return fromSamples(exact);
+    }
+    const QVector<double> &sameResolution = byResolution.value(resolution);
+    if (sameResolution.size() >= MIN_SAMPLES) {
+        return fromSamples(sameResolution);
+    }
+    if (all.size() >= MIN_SAMPLES) {
+        return fromSamples(all);
+    }
+    return CompletionEstimate();
+}
+
+QString CompletionTimeModel::groupKey(const QString &resolution, int duration) {
+    return resolution + "/" + QString::number(duration);
+}
+
+void CompletionTimeModel::append(QVector<double> &samples, double seconds) {
+    samples.append(seconds);
+    if (samples.size() > MAX_SAMPLES_PER_GROUP) {
+        samples.removeFirst();
+    }
+}
+
+CompletionEstimate CompletionTimeModel::fromSamples(const QVector<double> &samples) {
+    QVector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto quantile = [&sorted](double q) {
+        // 线性插值
+        double pos = q * (sorted.size() - 1);
+        int lower = static_cast<int>(pos);
+        int upper = qMin(lower + 1, static_cast<int>(sorted.size()) - 1);
+        return sorted[lower] + (sorted[upper] - sorted[lower]) * (pos - lower);
+    };
+
+    CompletionEstimate estimate;
+    estimate.valid = true;
+    estimate.samples = sorted.size();
+    estimate.p10 = quantile(0.10);
+    estimate.p50 = quantile(0.50);
+    estimate.p90 = quantile(0.90);
+    estimate.p99 = quantile(0.99);
+    return estimate;
+}
@@ -0,0 +1,42 @@
+#ifndef COMPLETIONTIMEMODEL_H
+#define COMPLETIONTIMEMODEL_H
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include "models/TaskItem.h"
+
+// 按参数预测的生成完成时间（秒，自提交起）
+struct CompletionEstimate {
+    bool valid = false;
+    int samples = 0;
+    double p10 = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+};
+
+// 基于 tasks.db 中历史任务 create_time → complete_time 的完成时间模型。
+// 按 (分辨率, 时长) 分组统计分位数，样本不足时依次退化到同分辨率、全部任务。
+class CompletionTimeModel {
+public:
+    // tasks 为最近完成的任务（TaskDatabase::getCompletedTasks，按完成时间倒序），替换已有的样本
+    void load(const QList<TaskItem> &tasks);
+    void addSample(const QString &resolution, int duration, double seconds);
+    CompletionEstimate estimate(const QString &resolution, int duration) const;
+
+    static const int MIN_SAMPLES = 5;              // 少于该样本数的分组不使用
+    static const int MAX_SAMPLES_PER_GROUP = 200;  // 每组只保留最近的样本
+    static const int MAX_HISTORY = 2000;           // 启动时最多读取的历史任务数
+
+private:
+    static QString groupKey(const QString &resolution, int duration);
+    static void append(QVector<double> &samples, double seconds);
+    static CompletionEstimate fromSamples(const QVector<double> &samples);
+
+    QMap<QString, QVector<double>> byParams;      // "1080p/5" -> 耗时
+    QMap<QString, QVector<double>> byResolution;  // "1080p" -> 耗时
+    QVector<double> all;
+};
+
+#endif // COMPLETIONTIMEMODEL_H
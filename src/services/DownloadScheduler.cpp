@@ -0,0 +1,387 @@
+#include "DownloadScheduler.h"
+#include "const/AppConfig.h"
+#include "utils/SignedUrl.h"
+#include <QCoreApplication>
+#include <QMetaMethod>
+
+DownloadScheduler::DownloadScheduler(QObject *parent)
+    : QObject(parent), nextId(0), maxActive(Config::DEFAULT_MAX_CONCURRENT_DOWNLOADS), dispatching(false),
+      limit(0), tokens(0), windowBytes(0), measuredRate(0) {
+    rateWindow.start();
+    expiryTimer = new QTimer(this);
+    expiryTimer->setInterval(EXPIRY_CHECK_INTERVAL_MS);
+    connect(expiryTimer, &QTimer::timeout, this, &DownloadScheduler::checkExpiry);
+    reloadSettings();
+}
+
+DownloadScheduler *DownloadScheduler::instance() {
+    static DownloadScheduler *shared = nullptr;
+    if (!shared) {
+        shared = new DownloadScheduler(QCoreApplication::instance());
+    }
+    return shared;
+}
+
+void DownloadScheduler::setMaxConcurrent(int value) {
+    maxActive = qMax(1, value);
+    dispatch();
+}
+
+int DownloadScheduler::maxConcurrent() const {
+    return maxActive;
+}
+
+void DownloadScheduler::setBandwidthLimit(qint64 bytesPerSecond) {
+    limit = qMax<qint64>(0, bytesPerSecond);
+    tokens = bucketCapacity();
+    refillClock.start();
+}
+
+qint64 DownloadScheduler::bandwidthLimit() const {
+    return limit;
+}
+
+void DownloadScheduler::reloadSettings() {
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    setMaxConcurrent(settings.value(Config::KEY_MAX_CONCURRENT_DOWNLOADS, Config::DEFAULT_MAX_CONCURRENT_DOWNLOADS).toInt());
+    setBandwidthLimit(settings.value(Config::KEY_DOWNLOAD_BANDWIDTH_KBPS,
+                                     Config::DEFAULT_DOWNLOAD_BANDWIDTH_KBPS).toLongLong() * 1024);
+}
+
+quint64 DownloadScheduler::enqueue(const QString &taskId, const QString &url, Priority priority, QObject *receiver,
+                                   StartFunction start) {
+    Pending item;
+    item.entry.id = ++nextId;
+    item.entry.taskId = taskId;
+    item.entry.priority = priority;
+    item.entry.url = url;
+    item.entry.deadline = SignedUrl::expiry(url);
+    item.receiver = receiver;
+    item.start = start;
+    pending.insert(item.entry.id, item);
+    insertQueued(item);
+    if (item.entry.deadline.isValid() && !expiryTimer->isActive()) {
+        expiryTimer->start();
+    }
+    emit queueChanged();
+    dispatch();
+    return item.entry.id;
+}
+
+void DownloadScheduler::insertQueued(const Pending &item) {
+    QList<quint64> &queue = queues[static_cast<int>(item.entry.priority)];
+    int index = queue.size();
+    if (item.entry.deadline.isValid()) {
+        for (int i = 0; i < queue.size(); ++i) {
+            QDateTime other = pending.value(queue[i]).entry.deadline;
+            if (!other.isValid() || other > item.entry.deadline) {
+                index = i;
+                break;
+            }
+        }
+    }
+    queue.insert(index, item.entry.id);
+}
+
+void DownloadScheduler::finished(quint64 id, bool success) {
+    auto it = pending.find(id);
+    if (it == pending.end()) {
+        return;
+    }
+    if (success) {
+        counters.completed++;
+    } else {
+        counters.failed++;
+        const QDateTime &deadline = it->entry.deadline;
+        if (deadline.isValid() && deadline <= QDateTime::currentDateTimeUtc()) {
+            counters.missedWindow++;
+            qWarning() << "Download for task" << it->entry.taskId << "failed after its URL expired at" << deadline;
+        }
+    }
+    pending.erase(it);
+    emit queueChanged();
+    dispatch();
+}
+
+void DownloadScheduler::progress(quint64 id, qint64 bytesReceived, qint64 bytesTotal) {
+    auto it = pending.find(id);
+    if (it != pending.end()) {
+        it->entry.bytesReceived = bytesReceived;
+        it->entry.bytesTotal = bytesTotal;
+    }
+}
+
+bool DownloadScheduler::promote(const QString &taskId, Priority priority) {
+    bool found = false;
+    for (Pending &item : pending) {
+        if (item.entry.taskId != taskId || item.receiver.isNull()) {
+            continue;
+        }
+        found = true;
+        if (item.entry.priority <= priority) {
+            continue;
+        }
+        // 进行中的下载提升后在带宽预算中按新的优先级计
+        Priority previous = item.entry.priority;
+        item.entry.priority = priority;
+        if (!item.entry.active) {
+            queues[static_cast<int>(previous)].removeOne(item.entry.id);
+            insertQueued(item);
+        }
+    }
+    if (found) {
+        emit queueChanged();
+        dispatch();
+    }
+    return found;
+}
+
+void DownloadScheduler::updateUrl(const QString &taskId, const QString &url) {
+    bool found = false;
+    for (Pending &item : pending) {
+        if (item.entry.taskId != taskId || item.entry.active) {
+            continue;
+        }
+        found = true;
+        item.entry.url = url;
+        item.entry.deadline = SignedUrl::expiry(url);
+        item.entry.refreshing = false;
+        // 新的 URL 仍临近过期时不再反复刷新
+        item.refreshTried = nearExpiry(item);
+        queues[static_cast<int>(item.entry.priority)].removeOne(item.entry.id);
+        insertQueued(item);
+    }
+    if (found) {
+        qDebug() << "Download URL refreshed for task" << taskId;
+        emit queueChanged();
+        dispatch();
+    }
+}
+
+void DownloadScheduler::refreshFailed(const QString &taskId) {
+    bool found = false;
+    for (Pending &item : pending) {
+        if (item.entry.taskId == taskId && item.entry.refreshing) {
+            item.entry.refreshing = false;
+            found = true;
+        }
+    }
+    if (found) {
+        counters.refreshFailures++;
+        emit queueChanged();
+        dispatch();
+    }
+}
+
+bool DownloadScheduler::nearExpiry(const Pending &item) const {
+    return item.entry.deadline.isValid()
+        && QDateTime::currentDateTimeUtc().secsTo(item.entry.deadline) < URL_REFRESH_MARGIN_SEC;
+}
+
+void DownloadScheduler::requestRefresh(Pending &item) {
+    item.refreshTried = true;
+    // 没有人能重新查询（如基准程序）时直接用原 URL 尝试
+    if (!isSignalConnected(QMetaMethod::fromSignal(&DownloadScheduler::urlExpiring))) {
+        return;
+    }
+    item.entry.refreshing = true;
+    item.refreshClock.start();
+    counters.urlRefreshes++;
+    qDebug() << "Download URL for task" << item.entry.taskId << "expires at" << item.entry.deadline << ", refreshing";
+    emit urlExpiring(item.entry.taskId);
+}
+
+void DownloadScheduler::checkExpiry() {
+    bool hasDeadlines = false;
+    bool changed = false;
+    for (Pending &item : pending) {
+        if (item.entry.active || !item.entry.deadline.isValid()) {
+            continue;
+        }
+        hasDeadlines = true;
+        if (item.entry.refreshing && item.refreshClock.elapsed() > URL_REFRESH_TIMEOUT_MS) {
+            item.entry.refreshing = false;
+            counters.refreshFailures++;
+            changed = true;
+        } else if (!item.refreshTried && nearExpiry(item)) {
+            requestRefresh(item);
+            changed = true;
+        }
+    }
+    if (!hasDeadlines) {
+        expiryTimer->stop();
+    }
+    if (changed) {
+        emit queueChanged();
+        dispatch();
+    }
+}
+
+void DownloadScheduler::dispatch() {
+    // start 可能同步失败并回调 finished，由外层循环继续调度
+    if (dispatching) {
+        return;
+    }
+    dispatching = true;
+    // 发起方已销毁的下载随之中止，释放其占用的并发数
+    bool changed = pending.removeIf([](const auto &it) {
+        return it.value().entry.active && it.value().receiver.isNull();
+    }) > 0;
+    for (int p = 0; p < 3; ++p) {
+        QList<quint64> &queue = queues[p];
+        int i = 0;
+        while (i < queue.size()) {
+            if (static_cast<Priority>(p) != Priority::Playback && activeCount() >= maxActive) {
+                break;
+            }
+            quint64 id = queue[i];
+            auto it = pending.find(id);
+            if (it == pending.end() || it->receiver.isNull()) {
+                if (it != pending.end()) {
+                    pending.erase(it);
+                }
+                queue.removeAt(i);
+                changed = true;
+                continue;
+            }
+            // 已过期的 URL 先换新再下载，等待期间让后面的下载先开始
+            if (!it->refreshTried && it->entry.deadline.isValid()
+                && it->entry.deadline <= QDateTime::currentDateTimeUtc()) {
+                requestRefresh(*it);
+                changed = true;
+                continue;  // 重新取 queue[i]：应答可能已同步调整了队列
+            }
+            if (it->entry.refreshing) {
+                ++i;
+                continue;
+            }
+            queue.removeAt(i);
+            it->entry.active = true;
+            changed = true;
+            StartFunction start = it->start;
+            QString url = it->entry.url;
+            start(id, url);
+        }
+    }
+    dispatching = false;
+    if (changed) {
+        emit queueChanged();
+    }
+}
+
+int DownloadScheduler::activeCount() const {
+    int count = 0;
+    for (const Pending &item : pending) {
+        if (item.entry.active && !item.receiver.isNull()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int DownloadScheduler::queuedCount(Priority priority) const {
+    return queues[static_cast<int>(priority)].size();
+}
+
+QList<DownloadScheduler::Entry> DownloadScheduler::snapshot() const {
+    QList<Entry> result;
+    for (const Pending &item : pending) {
+        if (!item.receiver.isNull()) {
+            result.append(item.entry);
+        }
+    }
+    return result;
+}
+
+DownloadStats DownloadScheduler::stats() const {
+    return counters;
+}
+
+QString DownloadScheduler::priorityName(Priority priority) {
+    switch (priority) {
+        case Priority::Playback: return "播放";
+        case Priority::Fresh: return "新完成";
+        case Priority::Backfill: return "补全";
+    }
+    return QString();
+}
+
+double DownloadScheduler::bucketCapacity() const {
+    // 约 1/4 秒的突发，读取粒度较小的限速下也至少能放行一个读缓冲区
+    return qMax<double>(MIN_BUCKET_BYTES, limit / 4.0);
+}
+
+void DownloadScheduler::refill() {
+    if (!refillClock.isValid()) {
+        refillClock.start();
+        return;
+    }
+    qint64 elapsedMs = refillClock.restart();
+    tokens = qMin(bucketCapacity(), tokens + elapsedMs * limit / 1000.0);
+}
+
+double DownloadScheduler::reserveFor(quint64 id) const {
+    Priority own = id ? pending.value(id).entry.priority : Priority::Fresh;
+    for (const Pending &item : pending) {
+        if (item.entry.active && item.entry.priority < own && !item.receiver.isNull()) {
+            return bucketCapacity() / 2;
+        }
+    }
+    return 0;
+}
+
+qint64 DownloadScheduler::takeBytes(quint64 id, qint64 wanted) {
+    if (limit <= 0) {
+        countBytes(wanted);
+        return wanted;
+    }
+    refill();
+    qint64 available = static_cast<qint64>(tokens - reserveFor(id));
+    if (available <= 0) {
+        return 0;
+    }
+    qint64 granted = qMin(wanted, available);
+    tokens -= granted;
+    countBytes(granted);
+    return granted;
+}
+
+int DownloadScheduler::msUntilBytesAvailable(quint64 id) {
+    if (limit <= 0) {
+        return 0;
+    }
+    refill();
+    // 等到可以读取令牌桶的 1/8，避免以很小的块频繁读取
+    double needed = reserveFor(id) + bucketCapacity() / 8 - tokens;
+    int ms = static_cast<int>(needed * 1000 / limit) + 1;
+    return qBound(1, ms, MAX_THROTTLE_DELAY_MS);
+}
+
+void DownloadScheduler::consumeBytes(qint64 bytes) {
+    if (limit > 0) {
+        refill();
+        tokens -= bytes;
+    }
+    countBytes(bytes);
+}
+
+void DownloadScheduler::countBytes(qint64 bytes) {
+    windowBytes += bytes;
+    qint64 elapsed = rateWindow.elapsed();
+    if (elapsed >= 1000) {
+        measuredRate = windowBytes * 1000.0 / elapsed;
+        windowBytes = 0;
+        rateWindow.restart();
+    }
+}
+
+double DownloadScheduler::bytesPerSecond() {
+    // 一段时间没有数据时不再显示旧的速率
+    qint64 elapsed = rateWindow.elapsed();
+    if (elapsed >= 2000) {
+        measuredRate = windowBytes * 1000.0 / elapsed;
+        windowBytes = 0;
+        rateWindow.restart();
+    }
+    return measuredRate;
+}
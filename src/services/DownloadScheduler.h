@@ -0,0 +1,132 @@
+#ifndef DOWNLOADSCHEDULER_H
+#define DOWNLOADSCHEDULER_H
+
+#include "const/QtHeaders.h"
+#include <QElapsedTimer>
+#include <QPointer>
+#include <functional>
+
+// 统计信息
+struct DownloadStats {
+    quint64 completed = 0;
+    quint64 failed = 0;
+    quint64 missedWindow = 0;     // 失败时签名 URL 已过期的下载
+    quint64 urlRefreshes = 0;     // 因 URL 即将过期请求重新查询的次数
+    quint64 refreshFailures = 0;  // 重新查询失败或超时
+};
+
+// 全局视频下载调度器：所有视频下载经由这里排队启动。
+// 按优先级（播放 > 新完成 > 历史补全）和最大并发数启动下载，播放请求不受并发数限制；
+// 设置了带宽上限时，各下载读取数据前从共享的令牌桶申请字节数，
+// 有更高优先级的下载进行时，低优先级的下载只能使用令牌桶的上半部分。
+//
+// 视频 URL 是会过期的签名链接：同一优先级内按过期时间排队（先过期的先下载，
+// 无法解析过期时间的排在最后）。排队中的 URL 临近过期时发出 urlExpiring，
+// 由持有 API Key 的一方重新查询任务并以 updateUrl 换上新的 URL；
+// 已过期的 URL 在换到新 URL（或刷新失败、超时）之前不启动。
+class DownloadScheduler : public QObject {
+    Q_OBJECT
+public:
+    enum class Priority {
+        Playback,  // 用户正要播放的视频
+        Fresh,     // 刚生成完成的视频
+        Backfill   // 任务历史中补全、续传的旧视频
+    };
+
+    using StartFunction = std::function<void(quint64 id, const QString &url)>;
+
+    // 队列中一项的状态，供界面显示
+    struct Entry {
+        quint64 id = 0;
+        QString taskId;
+        Priority priority = Priority::Fresh;
+        QString url;
+        QDateTime deadline;       // 签名 URL 的过期时间，无法解析时无效
+        bool active = false;
+        bool refreshing = false;  // 正在等待新的 URL
+        qint64 bytesReceived = 0;
+        qint64 bytesTotal = 0;
+    };
+
+    explicit DownloadScheduler(QObject *parent = nullptr);
+
+    static DownloadScheduler *instance();  // 应用范围的共享实例
+
+    // 排队一个下载，轮到时以当前的 URL 调用 start(id, url)；下载结束后必须调用 finished(id, success)。
+    // receiver 销毁后不再启动，已启动的也不再占用并发数
+    quint64 enqueue(const QString &taskId, const QString &url, Priority priority, QObject *receiver, StartFunction start);
+    void finished(quint64 id, bool success);
+    void progress(quint64 id, qint64 bytesReceived, qint64 bytesTotal);
+    // 将 taskId 的下载提升到 priority；没有该任务的下载时返回 false
+    bool promote(const QString &taskId, Priority priority);
+    // urlExpiring 的应答：重新查询得到的 URL，或查询失败
+    void updateUrl(const QString &taskId, const QString &url);
+    void refreshFailed(const QString &taskId);
+
+    void setMaxConcurrent(int value);
+    int maxConcurrent() const;
+    void setBandwidthLimit(qint64 bytesPerSecond);  // 0 表示不限制
+    qint64 bandwidthLimit() const;
+    void reloadSettings();  // 重新读取并发数和带宽上限
+
+    // 带宽预算：下载（id 为 enqueue 的返回值，0 按新完成计）读取前申请，返回允许读取的字节数。
+    // 返回 0 时应在 msUntilBytesAvailable() 之后再读
+    qint64 takeBytes(quint64 id, qint64 wanted);
+    int msUntilBytesAvailable(quint64 id);
+    void consumeBytes(qint64 bytes);  // 不经申请已读取的数据（如请求结束时的剩余部分），可透支
+
+    int activeCount() const;
+    int queuedCount(Priority priority) const;
+    double bytesPerSecond();  // 最近一秒左右的合计下载速率
+    QList<Entry> snapshot() const;
+    DownloadStats stats() const;
+
+    static QString priorityName(Priority priority);
+
+    static constexpr qint64 MIN_BUCKET_BYTES = 64 * 1024;
+    static const int MAX_THROTTLE_DELAY_MS = 500;
+    static const int URL_REFRESH_MARGIN_SEC = 120;     // 距过期不足 2 分钟时重新查询
+    static const int URL_REFRESH_TIMEOUT_MS = 30000;
+    static const int EXPIRY_CHECK_INTERVAL_MS = 15000;
+
+signals:
+    void queueChanged();
+    void urlExpiring(const QString &taskId);  // 排队中的下载的 URL 即将或已经过期
+
+private:
+    struct Pending {
+        Entry entry;
+        QPointer<QObject> receiver;
+        StartFunction start;
+        bool refreshTried = false;   // 每个 URL 只请求一次刷新
+        QElapsedTimer refreshClock;
+    };
+
+    void dispatch();
+    void insertQueued(const Pending &item);  // 按过期时间插入所在优先级的队列
+    void checkExpiry();
+    void requestRefresh(Pending &item);
+    bool nearExpiry(const Pending &item) const;
+    void refill();
+    double bucketCapacity() const;
+    double reserveFor(quint64 id) const;  // 更高优先级的下载进行中时为其保留的令牌
+    void countBytes(qint64 bytes);
+
+    QMap<quint64, Pending> pending;  // 排队或进行中的下载
+    QList<quint64> queues[3];        // 按 Priority 排队的 id
+    quint64 nextId;
+    int maxActive;
+    bool dispatching;
+    QTimer *expiryTimer;
+    DownloadStats counters;
+
+    qint64 limit;          // 字节/秒
+    double tokens;
+    QElapsedTimer refillClock;
+
+    QElapsedTimer rateWindow;
+    qint64 windowBytes;
+    double measuredRate;
+};
+
+#endif // DOWNLOADSCHEDULER_H
@@ -0,0 +1,692 @@
+#include "GenerationTaskManager.h"
+#include "ApiService.h"
+#include "HistoryService.h"
+#include "TaskDatabaseService.h"
+#include "PollScheduler.h"
+#include "DownloadScheduler.h"
+#include "VideoStore.h"
+#include "const/AppConfig.h"
+#include "models/TaskItem.h"
+#include <QFile>
+
+GenerationTaskManager::GenerationTaskManager(ApiService *apiService, TaskDatabaseService *dbService,
+                                             HistoryService *historyService, QObject *parent)
+    : QObject(parent), apiService(apiService), dbService(dbService), historyService(historyService),
+      pollScheduler(PollScheduler::instance()), pollDeadlines(new TimingWheel(100, this)),
+      requestCache(dbService), useRequestCache(true), maxConcurrentTasks(Config::DEFAULT_MAX_CONCURRENT_TASKS), nextJobSeq(0) {
+
+    reloadSettings();
+    // 历史样本在数据库线程中读取；读取返回前的任务按默认节奏轮询
+    dbService->run([](TaskDatabase &db) { return db.getCompletedTasks(CompletionTimeModel::MAX_HISTORY); })
+        .then(this, [this](const QList<TaskItem> &tasks) { completionModel.load(tasks); });
+
+    connect(apiService, &ApiService::submissionSucceeded, this, &GenerationTaskManager::onSubmissionSucceeded);
+    connect(apiService, &ApiService::submissionFailed, this, &GenerationTaskManager::onSubmissionFailed);
+    connect(apiService, &ApiService::submissionRetrying, this, &GenerationTaskManager::onSubmissionRetrying);
+    connect(apiService, &ApiService::submissionMetrics, this, &GenerationTaskManager::onSubmissionMetrics);
+    connect(apiService, &ApiService::videoDownloadedForTask, this, &GenerationTaskManager::onVideoDownloaded);
+    connect(apiService, &ApiService::downloadFailed, this, &GenerationTaskManager::onDownloadFailed);
+
+    // 排队中的下载的签名 URL 临近过期时重新查询任务，取得新的 URL
+    connect(DownloadScheduler::instance(), &DownloadScheduler::urlExpiring, this, &GenerationTaskManager::onDownloadUrlExpiring);
+}
+
+QString GenerationTaskManager::enqueueTextToVideo(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params,
+                                                  const QString &batchId) {
+    GenerationJob job;
+    job.apiKey = apiKey;
+    job.prompt = prompt;
+    job.params = params;
+    job.batchId = batchId;
+    return enqueue(job);
+}
+
+QString GenerationTaskManager::enqueueImageToVideo(const QString &apiKey, const QString &prompt, const QString &imageData,
+                                                   const QString &lastImageData, const QMap<QString, QString> &params,
+                                                   const QString &batchId) {
+    GenerationJob job;
+    job.apiKey = apiKey;
+    job.prompt = prompt;
+    job.params = params;
+    job.batchId = batchId;
+    job.imageToVideo = true;
+    job.imageData = imageData;
+    job.lastImageData = lastImageData;
+    return enqueue(job);
+}
+
+QString GenerationTaskManager::enqueue(GenerationJob job) {
+    job.jobId = QString("job-%1").arg(++nextJobSeq);
+    job.state = GenerationState::Waiting;
+
+    // 提交前查找相同请求的已完成任务；图片数据此时还在，可参与计算地址
+    job.requestHash = RequestCache::requestHash(apiService->getSubmitUrl(), job.imageToVideo, job.prompt,
+                                                job.params, job.imageData, job.lastImageData);
+    bool lookup = false;
+    if (job.requestHash.isEmpty()) {
+        requestCache.recordUncacheable();
+    } else if (!useRequestCache) {
+        requestCache.recordBypass();
+    } else {
+        lookup = true;
+    }
+
+    jobs.insert(job.jobId, job);
+
+    if (!job.batchId.isEmpty()) {
+        BatchStats &stats = batches[job.batchId];
+        if (stats.total == 0) {
+            stats.batchId = job.batchId;
+            stats.startTime = QDateTime::currentDateTime();
+        }
+        stats.total++;
+        emit batchProgress(stats);
+    }
+
+    if (!lookup) {
+        emit requestCacheStatsChanged(requestCache.stats());
+        queueForSubmit(job.jobId);
+        return job.jobId;
+    }
+
+    // 在数据库线程中查找，调用方先拿到 jobId 再收到结果
+    emit jobStateChanged(job.jobId, GenerationState::Waiting, "正在查找结果缓存...");
+    requestCache.lookup(job.requestHash).then(this, [this, jobId = job.jobId](const TaskItem &cached) {
+        requestCache.recordLookup(!cached.taskId.isEmpty());
+        emit requestCacheStatsChanged(requestCache.stats());
+        if (!jobs.contains(jobId)) {
+            return;
+        }
+        if (cached.taskId.isEmpty()) {
+            queueForSubmit(jobId);
+            return;
+        }
+        emit jobStateChanged(jobId, GenerationState::Waiting, "命中结果缓存 (" + cached.taskId + ")");
+        completeFromCache(jobId, cached);
+    });
+    return job.jobId;
+}
+
+void GenerationTaskManager::queueForSubmit(const QString &jobId) {
+    waitingQueue.append(jobId);
+    emit jobStateChanged(jobId, GenerationState::Waiting, "等待空闲槽位...");
+    dispatch();
+}
+
+void GenerationTaskManager::completeFromCache(const QString &jobId, const TaskItem &cached) {
+    auto it = jobs.find(jobId);
+    if (it == jobs.end()) {
+        return;
+    }
+    GenerationJob &job = *it;
+    job.cacheHit = true;
+    job.taskId = cached.taskId;
+
+    if (!cached.localFilePath.isEmpty()) {
+        qDebug() << "Request cache hit for" << jobId << ": reusing" << cached.localFilePath << "of task" << cached.taskId;
+        job.localFilePath = cached.localFilePath;
+        // 与下载完成时一样加入画廊：原来的历史记录可能已被删除
+        historyService->add(job.prompt, cached.localFilePath);
+        emit jobProgress(jobId, 100);
+        finishJob(job, GenerationState::Saved);
+        return;
+    }
+
+    if (taskToJob.contains(cached.taskId)) {
+        // 该任务的视频正由另一个 job 下载，直接重新提交
+        job.cacheHit = false;
+        job.taskId.clear();
+        waitingQueue.append(jobId);
+        setState(job, GenerationState::Waiting, "等待空闲槽位...");
+        dispatch();
+        return;
+    }
+
+    // 本地文件已不在：按记录的视频 URL 重新下载，URL 失效时在 onDownloadFailed 中重新提交
+    qDebug() << "Request cache hit for" << jobId << ": downloading" << cached.taskId << "again";
+    taskToJob.insert(job.taskId, jobId);
+    job.videoUrl = cached.videoUrl;
+    startDownload(job, "命中结果缓存，正在重新下载视频...");
+    emit queueChanged(activeCount(), waitingQueue.size());
+}
+
+void GenerationTaskManager::setRequestCacheEnabled(bool enabled) {
+    useRequestCache = enabled;
+}
+
+bool GenerationTaskManager::requestCacheEnabled() const {
+    return useRequestCache;
+}
+
+RequestCacheStats GenerationTaskManager::requestCacheStats() const {
+    return requestCache.stats();
+}
+
+void GenerationTaskManager::setMaxConcurrent(int value) {
+    maxConcurrentTasks = qMax(1, value);
+    dispatch();
+}
+
+int GenerationTaskManager::maxConcurrent() const {
+    return maxConcurrentTasks;
+}
+
+void GenerationTaskManager::reloadSettings() {
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    setMaxConcurrent(settings.value(Config::KEY_MAX_CONCURRENT_TASKS, Config::DEFAULT_MAX_CONCURRENT_TASKS).toInt());
+    useRequestCache = settings.value(Config::KEY_USE_REQUEST_CACHE, true).toBool();
+}
+
+void GenerationTaskManager::resumeInterruptedDownloads() {
+    // 日志、暂存文件的检查和任务的读取在数据库线程中一次完成
+    dbService->run([](TaskDatabase &db) {
+        QList<std::pair<DownloadJournalEntry, TaskItem>> resumable;
+        const QList<DownloadJournalEntry> entries = db.getDownloadJournals();
+        for (const DownloadJournalEntry &entry : entries) {
+            if (!QFile::exists(entry.destPath + ".part")) {
+                // 暂存文件已丢失，无法续传
+                db.deleteDownloadJournal(entry.destPath);
+                continue;
+            }
+            if (entry.taskId.isEmpty()) {
+                continue;
+            }
+            TaskItem task = db.getTask(entry.taskId);
+            if (!task.taskId.isEmpty()) {
+                resumable.append({entry, task});
+            }
+        }
+        return resumable;
+    }).then(this, [this](const QList<std::pair<DownloadJournalEntry, TaskItem>> &resumable) {
+        for (const auto &[entry, task] : resumable) {
+            if (taskToJob.contains(task.taskId)) {
+                continue;
+            }
+
+            GenerationJob job;
+            job.jobId = QString("job-%1").arg(++nextJobSeq);
+            job.taskId = task.taskId;
+            job.apiKey = task.apiKey;
+            job.prompt = task.prompt;
+            job.videoUrl = task.videoUrl.isEmpty() ? entry.url : task.videoUrl;
+            job.localFilePath = entry.destPath;
+            jobs.insert(job.jobId, job);
+            taskToJob.insert(job.taskId, job.jobId);
+
+            qDebug() << "Resuming interrupted download for task" << job.taskId << "at" << entry.bytesDone << "bytes";
+            GenerationJob &inserted = jobs[job.jobId];
+            setState(inserted, GenerationState::Downloading, "正在续传未完成的下载...");
+            apiService->downloadVideo(inserted.videoUrl, inserted.localFilePath, inserted.taskId,
+                                      DownloadScheduler::Priority::Backfill);
+        }
+        emit queueChanged(activeCount(), waitingQueue.size());
+    });
+}
+
+BatchStats GenerationTaskManager::batch(const QString &batchId) const {
+    return batches.value(batchId);
+}
+
+int GenerationTaskManager::activeCount() const {
+    int count = 0;
+    for (const GenerationJob &job : jobs) {
+        if (job.isActive()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int GenerationTaskManager::waitingCount() const {
+    return waitingQueue.size();
+}
+
+GenerationJob GenerationTaskManager::job(const QString &jobId) const {
+    return jobs.value(jobId);
+}
+
+const TimingWheel *GenerationTaskManager::pollWheel() const {
+    return pollDeadlines;
+}
+
+QString GenerationTaskManager::stateString(GenerationState state) {
+    switch (state) {
+        case GenerationState::Waiting: return "等待中";
+        case GenerationState::Submitting: return "提交中";
+        case GenerationState::Queued: return "排队中";
+        case GenerationState::Processing: return "生成中";
+        case GenerationState::Downloading: return "下载中";
+        case GenerationState::Saved: return "已保存";
+        case GenerationState::Failed: return "失败";
+        default: return "未知";
+    }
+}
+
+void GenerationTaskManager::dispatch() {
+    while (!waitingQueue.isEmpty() && activeCount() < maxConcurrentTasks) {
+        QString jobId = waitingQueue.takeFirst();
+        auto it = jobs.find(jobId);
+        if (it == jobs.end()) {
+            continue;
+        }
+        submit(*it);
+    }
+    emit queueChanged(activeCount(), waitingQueue.size());
+}
+
+void GenerationTaskManager::submit(GenerationJob &job) {
+    setState(job, GenerationState::Submitting, job.imageToVideo ? "正在提交图生视频任务..." : "正在提交任务...");
+    emit jobProgress(job.jobId, 10);
+
+    if (job.imageToVideo) {
+        apiService->submitImageToVideoTask(job.apiKey, job.prompt, job.imageData, job.lastImageData, job.params, job.jobId);
+        // 图片数据只在提交时需要，提交后释放内存
+        job.imageData.clear();
+        job.lastImageData.clear();
+    } else {
+        apiService->submitTask(job.apiKey, job.prompt, job.params, job.jobId);
+    }
+}
+
+void GenerationTaskManager::onSubmissionSucceeded(const QString &requestTag, const QString &taskId) {
+    auto it = jobs.find(requestTag);
+    if (it == jobs.end()) {
+        return;  // 不是本调度器发起的提交
+    }
+    GenerationJob &job = *it;
+    job.taskId = taskId;
+    taskToJob.insert(taskId, job.jobId);
+
+    // 保存任务到数据库
+    TaskItem task;
+    task.taskId = taskId;
+    task.prompt = job.prompt;
+    task.apiKey = job.apiKey;
+
+    // 使用用户配置的参数，如果没有则使用默认值
+    task.width = job.params.value("width", "1280").toInt();
+    task.height = job.params.value("height", "720").toInt();
+    task.resolution = job.params.value("resolution", "1080p");
+    task.aspectRatio = job.params.value("aspect_ratio", "16:9");
+    task.duration = job.params.value("duration", "5").toInt();
+    task.cameraFixed = (job.params.value("camera_fixed", "false") == "true");
+    task.seed = job.params.value("seed", "123").toInt();
+    task.submitAttempts = qMax(1, job.submitAttempts);
+    task.submitLatencyMs = job.submitLatencyMs;
+    task.batchId = job.batchId;
+    task.requestHash = job.requestHash;
+
+    task.status = TaskStatus::Processing;
+    task.createTime = QDateTime::currentDateTime();
+    task.updateTime = task.createTime;
+
+    dbService->saveTaskAsync(task);  // 不等待写入，之后的读-改-写按提交顺序执行
+
+    setState(job, GenerationState::Queued, "任务已提交 (" + taskId + ")，正在生成...");
+    emit jobProgress(job.jobId, 30);
+
+    // 启动该任务的智能轮询
+    startSmartPolling(job);
+}
+
+void GenerationTaskManager::onSubmissionRetrying(const QString &requestTag, int attempt, int delayMs, const QString &error) {
+    auto it = jobs.find(requestTag);
+    if (it == jobs.end()) {
+        return;
+    }
+    setState(*it, GenerationState::Submitting,
+             QString("提交失败（%1），%2 秒后第 %3 次重试...").arg(error).arg((delayMs + 999) / 1000).arg(attempt + 1));
+}
+
+void GenerationTaskManager::onSubmissionMetrics(const QString &requestTag, int attempts, qint64 latencyMs) {
+    auto it = jobs.find(requestTag);
+    if (it == jobs.end()) {
+        return;
+    }
+    it->submitAttempts = attempts;
+    it->submitLatencyMs = latencyMs;
+    qDebug() << "Job" << requestTag << "submitted after" << attempts << "attempt(s) in" << latencyMs << "ms";
+}
+
+void GenerationTaskManager::onSubmissionFailed(const QString &requestTag, const QString &error) {
+    auto it = jobs.find(requestTag);
+    if (it == jobs.end()) {
+        return;
+    }
+    finishJob(*it, GenerationState::Failed, error);
+}
+
+void GenerationTaskManager::onPollResult(const PollResult &result) {
+    const QString &taskId = result.taskId;
+    const QString &videoUrl = result.videoUrl;
+    const QString &error = result.error;
+    GenerationJob *job = findByTaskId(taskId);
+    if (!job || (job->state != GenerationState::Queued && job->state != GenerationState::Processing)) {
+        return;
+    }
+
+    if (result.isPending()) {
+        if (result.status == "TASK_STATUS_PROCESSING" && job->state == GenerationState::Queued) {
+            setState(*job, GenerationState::Processing, QString("生成中 (%1%)").arg(result.progressPercent));
+        }
+    } else if (result.success) {
+        cancelPollDeadline(*job);
+        job->videoUrl = videoUrl;
+
+        // 计入完成时间模型，后续同参数任务据此安排轮询
+        completionModel.addSample(job->params.value("resolution", "1080p"), job->params.value("duration", "5").toInt(),
+                                  job->taskStartTime.msecsTo(QDateTime::currentDateTime()) / 1000.0);
+
+        // 更新数据库中的任务状态（在数据库线程中一次完成读-改-写，不等待结果）
+        dbService->run([=](TaskDatabase &db) {
+            TaskItem task = db.getTask(taskId);
+            if (!task.taskId.isEmpty()) {
+                task.status = TaskStatus::Completed;
+                task.videoUrl = videoUrl;
+                task.updateTime = QDateTime::currentDateTime();
+                task.completeTime = task.updateTime;
+                db.updateTask(task);
+            }
+        });
+
+        startDownload(*job, "生成成功，正在下载...");
+    } else if (result.failed) {
+        // 服务端明确返回失败：更新数据库中的任务状态为失败
+        dbService->run([=](TaskDatabase &db) {
+            TaskItem task = db.getTask(taskId);
+            if (!task.taskId.isEmpty()) {
+                task.status = TaskStatus::Failed;
+                task.errorMessage = error;
+                task.updateTime = QDateTime::currentDateTime();
+                task.completeTime = task.updateTime;
+                db.updateTask(task);
+            }
+        });
+
+        finishJob(*job, GenerationState::Failed, "生成失败: " + error);
+    } else {
+        // 网络错误或未知状态：不判定失败，到下一个查询时刻再查，整体受超时限制
+        qDebug() << "Poll of task" << taskId << "failed transiently:" << error;
+    }
+    // 如果还没完成，该任务的 Timer 会继续触发，这里不用处理
+}
+
+void GenerationTaskManager::startDownload(GenerationJob &job, const QString &message) {
+    // 下载到视频存储的 incoming 目录（经由同目录暂存文件原子提交），完成后按内容移入存储；
+    // 未设置存储时直接下载到保存目录
+    if (VideoStore *store = apiService->videoStore()) {
+        job.localFilePath = store->incomingPath(job.taskId);
+    } else {
+        QDir dir(historyService->getSavePath());
+        QString fileName = job.taskId + "_" + QString::number(QDateTime::currentSecsSinceEpoch()) + ".mp4";
+        job.localFilePath = dir.filePath(fileName);
+    }
+
+    setState(job, GenerationState::Downloading, message);
+    emit jobProgress(job.jobId, 80);
+    apiService->downloadVideo(job.videoUrl, job.localFilePath, job.taskId);
+}
+
+void GenerationTaskManager::onVideoDownloaded(const QString &taskId, const QString &localPath) {
+    GenerationJob *job = findByTaskId(taskId);
+    if (!job || job->state != GenerationState::Downloading) {
+        return;
+    }
+
+    // 更新数据库中的本地文件路径
+    dbService->run([=](TaskDatabase &db) {
+        TaskItem task = db.getTask(taskId);
+        if (!task.taskId.isEmpty()) {
+            task.localFilePath = localPath;
+            task.updateTime = QDateTime::currentDateTime();
+            db.updateTask(task);
+        }
+    });
+
+    historyService->add(job->prompt, localPath);
+    job->localFilePath = localPath;
+    emit jobProgress(job->jobId, 100);
+    finishJob(*job, GenerationState::Saved);
+}
+
+void GenerationTaskManager::onDownloadFailed(const QString &taskId, const QString &error) {
+    GenerationJob *job = findByTaskId(taskId);
+    if (!job || job->state != GenerationState::Downloading) {
+        return;
+    }
+    if (job->cacheHit) {
+        // 缓存中的视频 URL 已过期，按原请求重新提交
+        qDebug() << "Cached video of task" << taskId << "is no longer available:" << error;
+        taskToJob.remove(taskId);
+        job->cacheHit = false;
+        job->taskId.clear();
+        job->videoUrl.clear();
+        job->localFilePath.clear();
+        waitingQueue.prepend(job->jobId);
+        setState(*job, GenerationState::Waiting, "缓存的视频已失效，重新提交...");
+        dispatch();
+        return;
+    }
+    finishJob(*job, GenerationState::Failed, "下载失败: " + error);
+}
+
+void GenerationTaskManager::onDownloadUrlExpiring(const QString &taskId) {
+    // 任务历史发起的下载也在这里刷新：API Key 取自 tasks.db
+    dbService->getTaskAsync(taskId).then(this, [this, taskId](const TaskItem &task) {
+        if (task.taskId.isEmpty() || task.apiKey.isEmpty()) {
+            DownloadScheduler::instance()->refreshFailed(taskId);
+            return;
+        }
+        refreshDownloadUrl(task.apiKey, taskId);
+    });
+}
+
+void GenerationTaskManager::refreshDownloadUrl(const QString &apiKey, const QString &taskId) {
+    pollScheduler->poll(apiKey, taskId, this, [this](const PollResult &result) {
+        if (!result.success || result.videoUrl.isEmpty()) {
+            qDebug() << "Could not refresh video URL of task" << result.taskId << ":" << result.error;
+            DownloadScheduler::instance()->refreshFailed(result.taskId);
+            return;
+        }
+        dbService->run([result](TaskDatabase &db) {
+            TaskItem refreshed = db.getTask(result.taskId);
+            if (!refreshed.taskId.isEmpty()) {
+                refreshed.videoUrl = result.videoUrl;
+                refreshed.updateTime = QDateTime::currentDateTime();
+                db.updateTask(refreshed);
+            }
+        });
+        if (GenerationJob *job = findByTaskId(result.taskId)) {
+            job->videoUrl = result.videoUrl;
+        }
+        DownloadScheduler::instance()->updateUrl(result.taskId, result.videoUrl);
+    });
+}
+
+void GenerationTaskManager::startSmartPolling(GenerationJob &job) {
+    job.taskStartTime = QDateTime::currentDateTime();
+    job.pollAttempts = 0;
+    job.currentInterval = INITIAL_INTERVAL;
+
+    job.estimate = completionModel.estimate(job.params.value("resolution", "1080p"),
+                                            job.params.value("duration", "5").toInt());
+    if (job.estimate.valid) {
+        job.timeoutSeconds = qBound(MIN_TIMEOUT, static_cast<int>(job.estimate.p99 * TIMEOUT_FACTOR), MAX_TIMEOUT);
+        qDebug() << "Predicted completion for" << job.taskId << ": p10" << job.estimate.p10 << "p50" << job.estimate.p50
+                 << "p90" << job.estimate.p90 << "p99" << job.estimate.p99 << "s from" << job.estimate.samples
+                 << "samples, timeout" << job.timeoutSeconds << "s";
+    } else {
+        job.timeoutSeconds = MAX_WAIT_TIME;
+    }
+
+    // 立即进行第一次查询
+    smartPoll(job.jobId);
+}
+
+void GenerationTaskManager::smartPoll(const QString &jobId) {
+    auto it = jobs.find(jobId);
+    if (it == jobs.end()) {
+        return;
+    }
+    GenerationJob &job = *it;
+    if (job.state != GenerationState::Queued && job.state != GenerationState::Processing) {
+        return;
+    }
+
+    // 检查是否超时（有历史数据时取同参数任务完成时间的高分位）
+    qint64 elapsedMs = job.taskStartTime.msecsTo(QDateTime::currentDateTime());
+    int elapsedSeconds = static_cast<int>(elapsedMs / 1000);
+
+    if (elapsedSeconds > job.timeoutSeconds) {
+        // 超时，标记为失败并保存
+        QString timeoutText = QString("超过%1秒").arg(job.timeoutSeconds);
+        QString taskId = job.taskId;
+        dbService->run([=](TaskDatabase &db) {
+            TaskItem task = db.getTask(taskId);
+            if (!task.taskId.isEmpty()) {
+                task.status = TaskStatus::Failed;
+                task.errorMessage = "查询超时（" + timeoutText + "）";
+                task.updateTime = QDateTime::currentDateTime();
+                db.updateTask(task);
+            }
+        });
+
+        finishJob(job, GenerationState::Failed,
+                  "任务查询超时（" + timeoutText + "）\n"
+                  "任务 ID: " + job.taskId + "\n"
+                  "任务已保存到历史记录，可在任务历史窗口重新查询");
+        return;
+    }
+
+    // 更新等待时间显示
+    updateWaitingTime(job);
+
+    // 执行查询
+    job.pollAttempts++;
+    qDebug() << "Smart poll" << job.taskId << "attempt" << job.pollAttempts << "after" << elapsedSeconds
+             << "seconds, interval:" << job.currentInterval << "ms";
+    pollScheduler->poll(job.apiKey, job.taskId, this, [this](const PollResult &result) {
+        onPollResult(result);
+    });
+
+    // 计算下一次查询间隔
+    job.currentInterval = nextPollInterval(job, static_cast<int>(elapsedMs));
+
+    // 设置下一次查询
+    cancelPollDeadline(job);
+    QString nextJobId = job.jobId;
+    job.pollDeadline = pollDeadlines->schedule(job.currentInterval, [this, nextJobId]() {
+        auto it = jobs.find(nextJobId);
+        if (it != jobs.end()) {
+            it->pollDeadline = 0;
+            smartPoll(nextJobId);
+        }
+    });
+}
+
+int GenerationTaskManager::nextPollInterval(const GenerationJob &job, int elapsedMs) const {
+    if (!job.estimate.valid) {
+        // 没有历史数据：指数退避
+        // 间隔序列：3s, 5s, 8s, 13s, 21s, 30s(max)
+        if (job.pollAttempts >= 3) {
+            // 从第3次开始使用指数退避
+            return qMin(job.currentInterval * 1.6, (double)MAX_INTERVAL);
+        }
+        return job.currentInterval;
+    }
+
+    int p10 = static_cast<int>(job.estimate.p10 * 1000);
+    int p90 = static_cast<int>(job.estimate.p90 * 1000);
+    int dense = qBound(MIN_DENSE_INTERVAL, (p90 - p10) / DENSE_POLLS, MAX_DENSE_INTERVAL);
+
+    if (elapsedMs < p10) {
+        // 大多数同参数任务此时还没完成：直接等到 p10 附近（仍不超过最大间隔）
+        return qBound(MIN_DENSE_INTERVAL, p10 - elapsedMs, MAX_INTERVAL);
+    }
+    if (elapsedMs < p90) {
+        // 预测完成区间内密集查询，但不越过 p90 太多
+        return qMax(MIN_DENSE_INTERVAL, qMin(dense, p90 - elapsedMs + dense / 2));
+    }
+    // 超过 p90：从密集间隔开始指数退避
+    return qMin(qMax(job.currentInterval, dense) * 1.6, (double)MAX_INTERVAL);
+}
+
+void GenerationTaskManager::cancelPollDeadline(GenerationJob &job) {
+    if (job.pollDeadline) {
+        pollDeadlines->cancel(job.pollDeadline);
+        job.pollDeadline = 0;
+    }
+}
+
+void GenerationTaskManager::updateWaitingTime(const GenerationJob &job) {
+    int elapsedSeconds = job.taskStartTime.secsTo(QDateTime::currentDateTime());
+    int remainingSeconds = job.timeoutSeconds - elapsedSeconds;
+
+    int minutes = elapsedSeconds / 60;
+    int seconds = elapsedSeconds % 60;
+
+    QString timeStr = QString("已等待: %1分%2秒").arg(minutes).arg(seconds, 2, 10, QChar('0'));
+
+    if (remainingSeconds < 60) {
+        timeStr += QString(" (剩余: %1秒)").arg(remainingSeconds);
+    }
+
+    emit jobStateChanged(job.jobId, job.state, "正在生成视频... " + timeStr);
+
+    // 更新进度（基于时间，有预测时以 p90 为满刻度）
+    int span = job.estimate.valid ? qMax(1, static_cast<int>(job.estimate.p90)) : job.timeoutSeconds;
+    int progress = 30 + (elapsedSeconds * 50 / span); // 30-80%
+    progress = qMin(progress, 75); // 最多75%
+    emit jobProgress(job.jobId, progress);
+}
+
+void GenerationTaskManager::finishJob(GenerationJob &job, GenerationState state, const QString &error) {
+    cancelPollDeadline(job);
+    if (!job.taskId.isEmpty() && !job.cacheHit) {
+        pollScheduler->cancel(job.taskId, this);
+    }
+    job.errorMessage = error;
+
+    QString jobId = job.jobId;
+    QString localPath = job.localFilePath;
+    QString batchId = job.batchId;
+    QString savedMessage = job.cacheHit ? "完成（复用任务 " + job.taskId + " 的结果）" : "完成";
+    setState(job, state, state == GenerationState::Saved ? savedMessage : error);
+
+    // 任务结束后不再需要 taskId 映射和完整的任务记录；复用缓存的 job 可能没有登记映射
+    auto mapped = taskToJob.constFind(job.taskId);
+    if (mapped != taskToJob.constEnd() && *mapped == jobId) {
+        taskToJob.erase(mapped);
+    }
+    jobs.remove(jobId);
+
+    if (state == GenerationState::Saved) {
+        emit jobSaved(jobId, localPath);
+    } else {
+        emit jobFailed(jobId, error);
+    }
+
+    auto batchIt = batches.find(batchId);
+    if (batchIt != batches.end()) {
+        (state == GenerationState::Saved ? batchIt->saved : batchIt->failed)++;
+        batchIt->lastFinishTime = QDateTime::currentDateTime();
+        emit batchProgress(*batchIt);
+    }
+
+    // 释放槽位，启动下一个等待中的任务
+    dispatch();
+}
+
+void GenerationTaskManager::setState(GenerationJob &job, GenerationState state, const QString &message) {
+    job.state = state;
+    emit jobStateChanged(job.jobId, state, message);
+}
+
+GenerationJob *GenerationTaskManager::findByTaskId(const QString &taskId) {
+    auto jobIt = taskToJob.constFind(taskId);
+    if (jobIt == taskToJob.constEnd()) {
+        return nullptr;
+    }
+    auto it = jobs.find(*jobIt);
+    return it == jobs.end() ? nullptr : &(*it);
+}
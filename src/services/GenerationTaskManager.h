@@ -0,0 +1,183 @@
+#ifndef GENERATIONTASKMANAGER_H
+#define GENERATIONTASKMANAGER_H
+
+#include "const/QtHeaders.h"
+#include "TimingWheel.h"
+#include "CompletionTimeModel.h"
+#include "RequestCache.h"
+
+class ApiService;
+class HistoryService;
+class TaskDatabaseService;
+class PollScheduler;
+struct PollResult;
+
+// 单个生成任务在客户端的生命周期
+enum class GenerationState {
+    Waiting,      // 等待空闲并发槽位
+    Submitting,   // 正在提交
+    Queued,       // 服务端排队中
+    Processing,   // 服务端生成中
+    Downloading,  // 正在下载视频
+    Saved,        // 已保存到本地
+    Failed        // 失败（提交、生成、超时或下载）
+};
+
+struct GenerationJob {
+    QString jobId;   // 本地标识，提交成功前 taskId 为空
+    QString taskId;
+    QString batchId; // 参数扫描的批次，单独提交时为空
+    QString requestHash;    // 结果缓存的地址，随机种子的请求为空
+    bool cacheHit = false;  // 复用了已完成任务的结果，taskId 为该任务
+    GenerationState state = GenerationState::Waiting;
+
+    // 请求内容
+    QString apiKey;
+    QString prompt;
+    QMap<QString, QString> params;
+    bool imageToVideo = false;
+    QString imageData;
+    QString lastImageData;
+
+    // 智能轮询状态（每个任务独立的退避计划）
+    TimingWheel::TimerId pollDeadline = 0;  // 下一次查询在时间轮中的句柄
+    QDateTime taskStartTime;
+    int pollAttempts = 0;
+    int currentInterval = 0;
+    CompletionEstimate estimate;  // 按参数预测的完成时间，决定轮询节奏和超时
+    int timeoutSeconds = 0;
+
+    QString videoUrl;
+    QString localFilePath;
+    QString errorMessage;
+
+    // 提交统计（含重试）
+    int submitAttempts = 0;
+    qint64 submitLatencyMs = 0;
+
+    bool isActive() const {
+        return state == GenerationState::Submitting || state == GenerationState::Queued
+            || state == GenerationState::Processing || state == GenerationState::Downloading;
+    }
+};
+
+// 一个参数扫描批次的进度和吞吐
+struct BatchStats {
+    QString batchId;
+    int total = 0;
+    int saved = 0;
+    int failed = 0;
+    QDateTime startTime;       // 批次入队时间
+    QDateTime lastFinishTime;  // 最近一个任务结束的时间
+
+    int finished() const { return saved + failed; }
+    bool isDone() const { return finished() >= total; }
+    // 墙钟时间：入队到最后一个任务结束，进行中的批次计到当前时间
+    qint64 wallClockMs() const {
+        return startTime.msecsTo(isDone() && lastFinishTime.isValid() ? lastFinishTime : QDateTime::currentDateTime());
+    }
+    double throughputPerMinute() const {
+        qint64 ms = wallClockMs();
+        return ms > 0 ? finished() * 60000.0 / ms : 0.0;
+    }
+};
+
+// 多任务生成调度器：为每个任务维护独立的状态机和轮询退避，
+// 同时运行的任务数受 maxConcurrent 限制，超出的任务排队等待。
+class GenerationTaskManager : public QObject {
+    Q_OBJECT
+public:
+    GenerationTaskManager(ApiService *apiService, TaskDatabaseService *dbService,
+                          HistoryService *historyService, QObject *parent = nullptr);
+
+    // 返回本地 jobId；batchId 非空时计入该批次的统计并写入 tasks.db
+    QString enqueueTextToVideo(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params,
+                               const QString &batchId = "");
+    QString enqueueImageToVideo(const QString &apiKey, const QString &prompt, const QString &imageData,
+                                const QString &lastImageData, const QMap<QString, QString> &params,
+                                const QString &batchId = "");
+
+    void setMaxConcurrent(int value);
+    int maxConcurrent() const;
+    void reloadSettings();  // 从 QSettings 重新读取并发上限和是否使用结果缓存
+    void resumeInterruptedDownloads();  // 根据下载日志续传上次未完成的下载
+
+    // 关闭后新入队的请求不查找结果缓存，总是重新生成（结果仍会写入缓存）
+    void setRequestCacheEnabled(bool enabled);
+    bool requestCacheEnabled() const;
+    RequestCacheStats requestCacheStats() const;
+
+    int activeCount() const;
+    int waitingCount() const;
+    GenerationJob job(const QString &jobId) const;
+    BatchStats batch(const QString &batchId) const;
+    const TimingWheel *pollWheel() const;  // 轮询截止时间（每 tick 到期数等统计）
+
+    static QString stateString(GenerationState state);
+
+signals:
+    void jobStateChanged(const QString &jobId, GenerationState state, const QString &message);
+    void jobProgress(const QString &jobId, int percent);
+    void jobSaved(const QString &jobId, const QString &localPath);
+    void jobFailed(const QString &jobId, const QString &error);
+    void queueChanged(int active, int waiting);
+    void batchProgress(const BatchStats &stats);
+    void requestCacheStatsChanged(const RequestCacheStats &stats);
+
+private slots:
+    void onSubmissionSucceeded(const QString &requestTag, const QString &taskId);
+    void onSubmissionFailed(const QString &requestTag, const QString &error);
+    void onSubmissionRetrying(const QString &requestTag, int attempt, int delayMs, const QString &error);
+    void onSubmissionMetrics(const QString &requestTag, int attempts, qint64 latencyMs);
+    void onVideoDownloaded(const QString &taskId, const QString &localPath);
+    void onDownloadFailed(const QString &taskId, const QString &error);
+    void onDownloadUrlExpiring(const QString &taskId);
+
+private:
+    QString enqueue(GenerationJob job);
+    void queueForSubmit(const QString &jobId);  // 未命中结果缓存：排队等待空闲槽位
+    void dispatch();  // 在并发上限内启动等待中的任务
+    void submit(GenerationJob &job);
+    void completeFromCache(const QString &jobId, const TaskItem &cached);
+    void startDownload(GenerationJob &job, const QString &message);
+    void startSmartPolling(GenerationJob &job);
+    void cancelPollDeadline(GenerationJob &job);
+    void smartPoll(const QString &jobId);
+    int nextPollInterval(const GenerationJob &job, int elapsedMs) const;
+    void onPollResult(const PollResult &result);
+    void refreshDownloadUrl(const QString &apiKey, const QString &taskId);  // 重新查询任务以取得新的视频 URL
+    void finishJob(GenerationJob &job, GenerationState state, const QString &error = "");
+    void setState(GenerationJob &job, GenerationState state, const QString &message);
+    GenerationJob *findByTaskId(const QString &taskId);
+    void updateWaitingTime(const GenerationJob &job);
+
+    ApiService *apiService;
+    TaskDatabaseService *dbService;
+    HistoryService *historyService;
+    PollScheduler *pollScheduler;
+    TimingWheel *pollDeadlines;  // 所有任务的下一次查询共用一个 tick 驱动
+    CompletionTimeModel completionModel;
+    RequestCache requestCache;
+    bool useRequestCache;
+
+    QMap<QString, GenerationJob> jobs;  // jobId -> job
+    QList<QString> waitingQueue;        // 等待槽位的 jobId（FIFO）
+    QMap<QString, QString> taskToJob;   // taskId -> jobId
+    QMap<QString, BatchStats> batches;  // batchId -> 进度
+    int maxConcurrentTasks;
+    quint64 nextJobSeq;
+
+    static const int MAX_WAIT_TIME = 300;  // 无历史数据时的最大等待时间（秒）5分钟
+    static const int INITIAL_INTERVAL = 3000;  // 初始轮询间隔3秒
+    static const int MAX_INTERVAL = 30000;  // 最大轮询间隔30秒
+
+    // 预测轮询：在 [p10, p90] 之间密集查询，p90 之后退避；超时取 p99 × 1.5
+    static const int DENSE_POLLS = 8;  // [p10, p90] 区间内的查询次数
+    static const int MIN_DENSE_INTERVAL = 2000;
+    static const int MAX_DENSE_INTERVAL = 10000;
+    static constexpr double TIMEOUT_FACTOR = 1.5;
+    static const int MIN_TIMEOUT = 120;
+    static const int MAX_TIMEOUT = 1800;
+};
+
+#endif // GENERATIONTASKMANAGER_H
@@ -10,8 +10,20 @@
 HistoryService::HistoryService(QObject *parent) : QObject(parent) {}
 
 QString HistoryService::getSavePath() const {
+    if (!savePathOverride.isEmpty()) {
+        return savePathOverride;
+    }
+    // 未设置时与 README 中的默认位置一致
     QSettings settings(Config::ORG_NAME, Config::APP_NAME);
-    return settings.value(Config::KEY_SAVE_PATH).toString();
+    QString path = settings.value(Config::KEY_SAVE_PATH).toString();
+    if (path.isEmpty()) {
+        path = QStandardPaths::writableLocation(QStandardPaths::MoviesLocation) + "/" + Config::APP_NAME;
+    }
+    return path;
+}
+
+void HistoryService::setSavePathOverride(const QString &path) {
+    savePathOverride = path;
 }
 
 void HistoryService::load() {
@@ -50,12 +62,25 @@ void HistoryService::add(const QString &prompt, const QString &path) {
 
 void HistoryService::remove(int index) {
     if(index >= 0 && index < items.size()) {
-        QFile::remove(items[index].filePath); // 删除物理文件
+        // 只移除记录；视频文件可能被其他记录或任务共用，由 VideoStore::releaseVideo 决定是否删除
         items.removeAt(index);
         saveJson();
     }
 }
 
+void HistoryService::replacePath(const QString &oldPath, const QString &newPath) {
+    bool changed = false;
+    for (HistoryItem &item : items) {
+        if (item.filePath == oldPath) {
+            item.filePath = newPath;
+            changed = true;
+        }
+    }
+    if (changed) {
+        saveJson();
+    }
+}
+
 QList<HistoryItem> HistoryService::getItems() const {
     return items;
 }
\ No newline at end of file
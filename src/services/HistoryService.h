@@ -18,12 +18,15 @@ public:
     explicit HistoryService(QObject *parent = nullptr);
     void load();
     void add(const QString &prompt, const QString &path);
-    void remove(int index);
+    void remove(int index);  // 只移除记录，不删除视频文件（见 VideoStore::releaseVideo）
+    void replacePath(const QString &oldPath, const QString &newPath);  // 视频重新下载到了新位置
     QList<HistoryItem> getItems() const;
     QString getSavePath() const;
+    void setSavePathOverride(const QString &path);  // 仅本次运行有效，不写入设置（批处理模式）
 
 private:
     QList<HistoryItem> items;
+    QString savePathOverride;
     void saveJson();
 };
 
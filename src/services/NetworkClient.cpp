@@ -0,0 +1,140 @@
+#include "NetworkClient.h"
+#include "TrafficRecorder.h"
+#include "const/AppConfig.h"
+#include <QNetworkReply>
+#include <QCoreApplication>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+#include <QHttp1Configuration>
+#endif
+#include <memory>
+
+NetworkClient::NetworkClient(QObject *parent)
+    : QObject(parent), recorder(nullptr), connectionsPerHost(Config::DEFAULT_MAX_CONNECTIONS_PER_HOST) {
+    manager = new QNetworkAccessManager(this);
+    reloadSettings();
+}
+
+NetworkClient *NetworkClient::instance() {
+    static NetworkClient *shared = nullptr;
+    if (!shared) {
+        shared = new NetworkClient(QCoreApplication::instance());
+    }
+    return shared;
+}
+
+void NetworkClient::setMaxConnectionsPerHost(int value) {
+    connectionsPerHost = qMax(1, value);
+}
+
+int NetworkClient::maxConnectionsPerHost() const {
+    return connectionsPerHost;
+}
+
+void NetworkClient::reloadSettings() {
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    setMaxConnectionsPerHost(settings.value(Config::KEY_MAX_CONNECTIONS_PER_HOST,
+                                            Config::DEFAULT_MAX_CONNECTIONS_PER_HOST).toInt());
+}
+
+void NetworkClient::setTrafficRecorder(TrafficRecorder *value) {
+    recorder = value;
+}
+
+TrafficRecorder *NetworkClient::trafficRecorder() const {
+    return recorder;
+}
+
+NetworkStats NetworkClient::stats() const {
+    return counters;
+}
+
+QNetworkAccessManager *NetworkClient::networkAccessManager() const {
+    return manager;
+}
+
+void NetworkClient::warmUp(const QUrl &url) {
+    if (recorder && recorder->mode() == TrafficRecorder::Mode::Replay) {
+        return;
+    }
+    if (url.scheme() == "https") {
+        manager->connectToHostEncrypted(url.host(), url.port(443));
+    } else if (url.scheme() == "http") {
+        manager->connectToHost(url.host(), url.port(80));
+    }
+}
+
+QNetworkReply *NetworkClient::get(const QNetworkRequest &request, Traffic traffic) {
+    if (recorder && recorder->mode() == TrafficRecorder::Mode::Replay) {
+        counters.requests++;
+        return recorder->replay(QNetworkAccessManager::GetOperation, request, manager);
+    }
+    QNetworkReply *reply = manager->get(prepare(request, traffic));
+    track(reply);
+    if (recorder) {
+        recorder->record(reply, QByteArray(), traffic == Traffic::Download || traffic == Traffic::Segmented);
+    }
+    return reply;
+}
+
+QNetworkReply *NetworkClient::post(const QNetworkRequest &request, const QByteArray &data, Traffic traffic) {
+    if (recorder && recorder->mode() == TrafficRecorder::Mode::Replay) {
+        counters.requests++;
+        return recorder->replay(QNetworkAccessManager::PostOperation, request, manager);
+    }
+    QNetworkReply *reply = manager->post(prepare(request, traffic), data);
+    track(reply);
+    if (recorder) {
+        recorder->record(reply, data, traffic == Traffic::Download || traffic == Traffic::Segmented);
+    }
+    return reply;
+}
+
+QNetworkRequest NetworkClient::prepare(const QNetworkRequest &request, Traffic traffic) const {
+    QNetworkRequest prepared(request);
+
+    // 分段下载依赖多个独立连接并行传输，不能被 HTTP/2 合并到同一连接上；
+    // 其余流量在服务器支持时使用 HTTP/2 多路复用
+    prepared.setAttribute(QNetworkRequest::Http2AllowedAttribute, traffic != Traffic::Segmented);
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    // 每个主机的 HTTP/1.1 连接数上限（Qt 默认 6）
+    QHttp1Configuration http1;
+    http1.setNumberOfConnectionsPerHost(connectionsPerHost);
+    prepared.setHttp1Configuration(http1);
+#endif
+
+    return prepared;
+}
+
+void NetworkClient::track(QNetworkReply *reply) {
+    counters.requests++;
+
+    // 每个请求只计一次：发送前触发了新连接则计为新建，否则计为复用
+    auto openedConnection = std::make_shared<bool>(false);
+    auto counted = std::make_shared<bool>(false);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [this, openedConnection]() {
+        if (!*openedConnection) {
+            *openedConnection = true;
+            counters.connectionsOpened++;
+        }
+    });
+    connect(reply, &QNetworkReply::requestSent, this, [this, openedConnection, counted]() {
+        if (!*counted) {
+            *counted = true;
+            if (!*openedConnection) {
+                counters.connectionsReused++;
+            }
+        }
+    });
+#endif
+    connect(reply, &QNetworkReply::encrypted, this, [this]() {
+        counters.tlsHandshakes++;
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool()) {
+            counters.http2Requests++;
+        }
+        emit statsChanged(counters);
+    });
+}
@@ -0,0 +1,66 @@
+#ifndef NETWORKCLIENT_H
+#define NETWORKCLIENT_H
+
+#include "const/QtHeaders.h"
+#include <QNetworkRequest>
+
+class QNetworkReply;
+class TrafficRecorder;
+
+// 网络连接统计
+struct NetworkStats {
+    quint64 requests = 0;
+    quint64 connectionsOpened = 0;   // 新建的 TCP 连接
+    quint64 connectionsReused = 0;   // 复用已有连接（keep-alive / HTTP/2 多路复用）发出的请求
+    quint64 tlsHandshakes = 0;
+    quint64 http2Requests = 0;
+};
+
+// 应用内共享的网络客户端：所有 API 请求和视频下载都经由同一个 QNetworkAccessManager，
+// 共享连接池、DNS 缓存和 TLS 会话，避免每次调用重新建立连接。
+class NetworkClient : public QObject {
+    Q_OBJECT
+public:
+    // 不同类型流量的连接策略
+    enum class Traffic {
+        Api,        // 提交任务
+        Poll,       // 轮询任务状态，优先 HTTP/2 多路复用
+        Download,   // 单连接视频下载
+        Segmented   // 分段下载，每段需要独立的 HTTP/1.1 连接
+    };
+
+    explicit NetworkClient(QObject *parent = nullptr);
+
+    static NetworkClient *instance();  // 应用范围的共享实例
+
+    QNetworkReply *get(const QNetworkRequest &request, Traffic traffic);
+    QNetworkReply *post(const QNetworkRequest &request, const QByteArray &data, Traffic traffic);
+
+    // 预先建立到 API 主机的连接（含 TLS 握手），首个请求无需等待
+    void warmUp(const QUrl &url);
+
+    void setMaxConnectionsPerHost(int value);
+    int maxConnectionsPerHost() const;
+    void reloadSettings();
+
+    // 录制模式下记录每个请求；回放模式下不访问网络，由录制数据应答
+    void setTrafficRecorder(TrafficRecorder *recorder);
+    TrafficRecorder *trafficRecorder() const;
+
+    NetworkStats stats() const;
+    QNetworkAccessManager *networkAccessManager() const;
+
+signals:
+    void statsChanged(const NetworkStats &stats);
+
+private:
+    QNetworkRequest prepare(const QNetworkRequest &request, Traffic traffic) const;
+    void track(QNetworkReply *reply);
+
+    QNetworkAccessManager *manager;
+    TrafficRecorder *recorder;
+    int connectionsPerHost;
+    NetworkStats counters;
+};
+
+#endif // NETWORKCLIENT_H
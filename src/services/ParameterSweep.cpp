@@ -0,0 +1,76 @@
+#include "ParameterSweep.h"
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+
+QStringList ParameterSweep::values(const QString &value) {
+    QStringList result;
+    for (const QString &part : value.split(',', Qt::SkipEmptyParts)) {
+        QString item = part.trimmed();
+        static const QRegularExpression range(R"(^(-?\d+)\s*\.\.\s*(-?\d+)$)");
+        QRegularExpressionMatch match = range.match(item);
+        if (match.hasMatch()) {
+            qint64 from = match.captured(1).toLongLong();
+            qint64 to = match.captured(2).toLongLong();
+            qint64 step = from <= to ? 1 : -1;
+            if (qAbs(to - from) < MAX_RANGE) {
+                for (qint64 v = from; v != to + step; v += step) {
+                    result.append(QString::number(v));
+                }
+                continue;
+            }
+        }
+        if (!item.isEmpty()) {
+            result.append(item);
+        }
+    }
+    if (result.isEmpty()) {
+        result.append(value.trimmed());
+    }
+    return result;
+}
+
+QMap<QString, QStringList> ParameterSweep::axes(const QMap<QString, QString> &params) {
+    QMap<QString, QStringList> result;
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+        result.insert(it.key(), values(it.value()));
+    }
+    return result;
+}
+
+int ParameterSweep::combinationCount(const QMap<QString, QString> &params) {
+    qint64 count = 1;
+    for (const QStringList &axis : axes(params)) {
+        count *= axis.size();
+        if (count > MAX_COMBINATIONS) {
+            return MAX_COMBINATIONS + 1;  // 只需知道超出上限
+        }
+    }
+    return static_cast<int>(count);
+}
+
+QList<QMap<QString, QString>> ParameterSweep::expand(const QMap<QString, QString> &params) {
+    QList<QMap<QString, QString>> combinations{QMap<QString, QString>()};
+    const QMap<QString, QStringList> all = axes(params);
+    for (auto it = all.constBegin(); it != all.constEnd(); ++it) {
+        QList<QMap<QString, QString>> next;
+        for (const QMap<QString, QString> &partial : combinations) {
+            for (const QString &value : it.value()) {
+                QMap<QString, QString> combination = partial;
+                combination.insert(it.key(), value);
+                next.append(combination);
+            }
+        }
+        combinations = next;
+        if (combinations.size() > MAX_COMBINATIONS) {
+            return {};
+        }
+    }
+    return combinations;
+}
+
+QString ParameterSweep::newBatchId() {
+    return QString("batch-%1-%2")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"))
+        .arg(QRandomGenerator::global()->bounded(0x10000), 4, 16, QChar('0'));
+}
@@ -0,0 +1,27 @@
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+// 参数扫描：参数值中用逗号分隔多个取值（seed = 1,2,3），或用 a..b 表示整数范围
+// （seed = 1..8），展开为所有取值的笛卡尔积，每个组合对应一个任务。
+class ParameterSweep {
+public:
+    // 每个参数的取值列表；单一取值的参数也包含在内
+    static QMap<QString, QStringList> axes(const QMap<QString, QString> &params);
+    static int combinationCount(const QMap<QString, QString> &params);
+    // 按参数名顺序展开，最后一个参数变化最快
+    static QList<QMap<QString, QString>> expand(const QMap<QString, QString> &params);
+
+    static QString newBatchId();
+
+    static const int MAX_COMBINATIONS = 256;  // 单个批次的任务数上限
+    static const int MAX_RANGE = 1000;        // a..b 范围的最大长度
+
+private:
+    static QStringList values(const QString &value);
+};
+
+#endif // PARAMETERSWEEP_H
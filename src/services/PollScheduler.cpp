@@ -0,0 +1,189 @@
+#include "PollScheduler.h"
+#include "ApiService.h"
+#include "const/AppConfig.h"
+#include <QCoreApplication>
+
+PollScheduler::PollScheduler(QObject *parent, ApiService *api)
+    : QObject(parent), api(api ? api : new ApiService(this)),
+      rate(Config::DEFAULT_POLL_REQUESTS_PER_SECOND), inFlight(0) {
+    dispatchTimer = new QTimer(this);
+    dispatchTimer->setSingleShot(true);
+    connect(dispatchTimer, &QTimer::timeout, this, &PollScheduler::sendNext);
+
+    // 专用的 ApiService，其轮询信号只由本调度器消费
+    connect(this->api, &ApiService::taskStatusUpdated, this, &PollScheduler::onTaskStatusUpdated);
+    connect(this->api, &ApiService::taskPolled, this, &PollScheduler::onTaskPolled);
+
+    reloadSettings();
+}
+
+PollScheduler *PollScheduler::instance() {
+    static PollScheduler *shared = nullptr;
+    if (!shared) {
+        shared = new PollScheduler(QCoreApplication::instance());
+    }
+    return shared;
+}
+
+void PollScheduler::setRequestsPerSecond(double value) {
+    rate = qMax(0.1, value);
+}
+
+double PollScheduler::requestsPerSecond() const {
+    return rate;
+}
+
+void PollScheduler::reloadSettings() {
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    setRequestsPerSecond(settings.value(Config::KEY_POLL_REQUESTS_PER_SECOND,
+                                        Config::DEFAULT_POLL_REQUESTS_PER_SECOND).toDouble());
+    api->reloadApiUrls();
+}
+
+int PollScheduler::queuedCount() const {
+    return interactiveQueue.size() + backgroundQueue.size();
+}
+
+int PollScheduler::inFlightCount() const {
+    return inFlight;
+}
+
+PollStats PollScheduler::stats() const {
+    return counters;
+}
+
+void PollScheduler::poll(const QString &apiKey, const QString &taskId, QObject *receiver, Callback callback,
+                         Priority priority) {
+    counters.requested++;
+
+    auto it = pending.find(taskId);
+    if (it == pending.end()) {
+        PendingPoll entry;
+        entry.apiKey = apiKey;
+        entry.priority = priority;
+        entry.subscribers.append({receiver, callback});
+        pending.insert(taskId, entry);
+        (priority == Priority::Interactive ? interactiveQueue : backgroundQueue).append(taskId);
+        emit queueChanged(queuedCount(), inFlight);
+        scheduleNext();
+        return;
+    }
+
+    // 已在排队或请求中：合并，结果返回时一起分发
+    counters.coalesced++;
+    PendingPoll &entry = *it;
+    bool subscribed = false;
+    for (Subscriber &subscriber : entry.subscribers) {
+        if (subscriber.receiver == receiver) {
+            subscriber.callback = callback;  // 同一订阅者重复请求只回调一次
+            subscribed = true;
+            break;
+        }
+    }
+    if (!subscribed) {
+        entry.subscribers.append({receiver, callback});
+    }
+
+    // 后台排队中的任务被交互请求时提前
+    if (!entry.inFlight && priority == Priority::Interactive && entry.priority == Priority::Background) {
+        entry.priority = Priority::Interactive;
+        backgroundQueue.removeOne(taskId);
+        interactiveQueue.append(taskId);
+    }
+}
+
+void PollScheduler::cancel(const QString &taskId, QObject *receiver) {
+    auto it = pending.find(taskId);
+    if (it == pending.end()) {
+        return;
+    }
+    it->subscribers.removeIf([receiver](const Subscriber &subscriber) {
+        return subscriber.receiver == receiver;
+    });
+    // 请求已发出时保留条目，等结果返回后再清理
+    if (it->subscribers.isEmpty() && !it->inFlight) {
+        pending.erase(it);
+        removeFromQueues(taskId);
+        emit queueChanged(queuedCount(), inFlight);
+    }
+}
+
+void PollScheduler::removeFromQueues(const QString &taskId) {
+    interactiveQueue.removeOne(taskId);
+    backgroundQueue.removeOne(taskId);
+}
+
+void PollScheduler::scheduleNext() {
+    if (dispatchTimer->isActive() || queuedCount() == 0) {
+        return;
+    }
+    // 按全局预算匀速发出，避免大量待查询任务同时涌向服务器
+    qint64 interval = static_cast<qint64>(1000.0 / rate);
+    qint64 delay = lastSent.isValid() ? qMax<qint64>(0, interval - lastSent.elapsed()) : 0;
+    dispatchTimer->start(static_cast<int>(delay));
+}
+
+void PollScheduler::sendNext() {
+    while (queuedCount() > 0) {
+        QString taskId = !interactiveQueue.isEmpty() ? interactiveQueue.takeFirst() : backgroundQueue.takeFirst();
+        auto it = pending.find(taskId);
+        if (it == pending.end()) {
+            continue;
+        }
+
+        // 所有订阅者都已销毁，不必再查询
+        it->subscribers.removeIf([](const Subscriber &subscriber) {
+            return subscriber.receiver.isNull();
+        });
+        if (it->subscribers.isEmpty()) {
+            pending.erase(it);
+            continue;
+        }
+
+        it->inFlight = true;
+        inFlight++;
+        counters.sent++;
+        lastSent.start();
+        api->pollTask(it->apiKey, taskId);
+        break;
+    }
+    emit queueChanged(queuedCount(), inFlight);
+    scheduleNext();
+}
+
+void PollScheduler::onTaskStatusUpdated(const QString &taskId, const QString &status, int progressPercent) {
+    auto it = pending.find(taskId);
+    if (it == pending.end() || !it->inFlight) {
+        return;
+    }
+    it->status = status;
+    it->progressPercent = progressPercent;
+}
+
+void PollScheduler::onTaskPolled(const QString &taskId, bool success, const QString &videoUrl, const QString &error,
+                                 bool failed) {
+    auto it = pending.find(taskId);
+    if (it == pending.end() || !it->inFlight) {
+        return;
+    }
+    // 先移出表，回调中可以立即为同一任务发起下一次查询
+    PendingPoll entry = it.value();
+    pending.erase(it);
+    inFlight--;
+    emit queueChanged(queuedCount(), inFlight);
+
+    PollResult result;
+    result.taskId = taskId;
+    result.success = success;
+    result.videoUrl = videoUrl;
+    result.error = error;
+    result.failed = failed;
+    result.status = entry.status;
+    result.progressPercent = entry.progressPercent;
+
+    for (const Subscriber &subscriber : entry.subscribers) {
+        if (subscriber.receiver) {
+            subscriber.callback(result);
+        }
+    }
+}
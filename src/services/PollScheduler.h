@@ -0,0 +1,100 @@
+#ifndef POLLSCHEDULER_H
+#define POLLSCHEDULER_H
+
+#include "const/QtHeaders.h"
+#include <QElapsedTimer>
+#include <QPointer>
+#include <functional>
+
+class ApiService;
+
+// 单次任务状态查询的结果
+struct PollResult {
+    QString taskId;
+    bool success = false;
+    QString videoUrl;
+    QString error;            // "STATUS_PROCESSING" 表示仍在排队或生成中
+    QString status;           // 服务端原始状态（排队/处理中时有效）
+    bool failed = false;      // 服务端明确返回 TASK_STATUS_FAILED；网络错误和未知状态为 false，可再次查询
+    int progressPercent = 0;
+
+    bool isPending() const { return error == "STATUS_PROCESSING"; }
+};
+
+// 统计信息
+struct PollStats {
+    quint64 requested = 0;   // poll() 调用次数
+    quint64 sent = 0;        // 实际发出的 HTTP 请求
+    quint64 coalesced = 0;   // 与排队中或进行中的同一任务合并的调用
+};
+
+// 全局任务状态查询调度器：所有轮询都经由这里发出。
+// 同一 task_id 在排队或请求进行中时只保留一个请求，结果分发给所有订阅者；
+// 请求按全局每秒预算匀速发出，交互请求（当前生成任务、手动查询）优先于后台刷新。
+class PollScheduler : public QObject {
+    Q_OBJECT
+public:
+    enum class Priority {
+        Interactive,  // 正在进行的生成任务或用户手动查询
+        Background    // 任务历史的定时刷新、批量重试
+    };
+
+    using Callback = std::function<void(const PollResult &result)>;
+
+    // api 为空时内部创建一个专用的 ApiService
+    explicit PollScheduler(QObject *parent = nullptr, ApiService *api = nullptr);
+
+    static PollScheduler *instance();  // 应用范围的共享实例
+
+    // 请求查询 taskId，结果通过 callback 回调；receiver 销毁后不再回调
+    void poll(const QString &apiKey, const QString &taskId, QObject *receiver, Callback callback,
+              Priority priority = Priority::Interactive);
+    // 取消 receiver 对 taskId 的订阅，没有其他订阅者时从队列中移除
+    void cancel(const QString &taskId, QObject *receiver);
+
+    void setRequestsPerSecond(double value);
+    double requestsPerSecond() const;
+    void reloadSettings();  // 重新读取速率上限和 API URL
+
+    int queuedCount() const;
+    int inFlightCount() const;
+    PollStats stats() const;
+
+signals:
+    void queueChanged(int queued, int inFlight);
+
+private slots:
+    void onTaskStatusUpdated(const QString &taskId, const QString &status, int progressPercent);
+    void onTaskPolled(const QString &taskId, bool success, const QString &videoUrl, const QString &error, bool failed);
+
+private:
+    struct Subscriber {
+        QPointer<QObject> receiver;
+        Callback callback;
+    };
+
+    struct PendingPoll {
+        QString apiKey;
+        Priority priority = Priority::Background;
+        bool inFlight = false;
+        QString status;
+        int progressPercent = 0;
+        QList<Subscriber> subscribers;
+    };
+
+    void scheduleNext();
+    void sendNext();
+    void removeFromQueues(const QString &taskId);
+
+    ApiService *api;
+    QMap<QString, PendingPoll> pending;  // taskId -> 排队或进行中的查询
+    QList<QString> interactiveQueue;
+    QList<QString> backgroundQueue;
+    QTimer *dispatchTimer;
+    QElapsedTimer lastSent;
+    double rate;
+    int inFlight;
+    PollStats counters;
+};
+
+#endif // POLLSCHEDULER_H
@@ -0,0 +1,208 @@
+#include "RateLimiter.h"
+#include <QCoreApplication>
+#include <cmath>
+
+RateLimiter::RateLimiter(QObject *parent) : QObject(parent) {
+    clock.start();
+}
+
+RateLimiter *RateLimiter::instance() {
+    static RateLimiter *shared = nullptr;
+    if (!shared) {
+        shared = new RateLimiter(QCoreApplication::instance());
+    }
+    return shared;
+}
+
+QString RateLimiter::endpointName(Endpoint endpoint) {
+    switch (endpoint) {
+        case Endpoint::Submit: return "提交";
+        case Endpoint::Poll: return "查询";
+        default: return "未知";
+    }
+}
+
+bool RateLimiter::isThrottleStatus(int httpStatus) {
+    return httpStatus == 429 || httpStatus == 503;
+}
+
+qint64 RateLimiter::parseRetryAfter(const QByteArray &value) {
+    QByteArray trimmed = value.trimmed();
+    if (trimmed.isEmpty()) {
+        return -1;
+    }
+    // delta-seconds
+    bool ok = false;
+    qint64 seconds = trimmed.toLongLong(&ok);
+    if (ok) {
+        return qMax<qint64>(0, seconds) * 1000;
+    }
+    // HTTP-date，例如 "Wed, 21 Oct 2015 07:28:00 GMT"
+    QDateTime date = QDateTime::fromString(QString::fromLatin1(trimmed), Qt::RFC2822Date);
+    if (date.isValid()) {
+        return qMax<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date));
+    }
+    return -1;
+}
+
+QString RateLimiter::bucketKey(Endpoint endpoint, const QString &apiKey) {
+    return QString::number(static_cast<int>(endpoint)) + "|" + apiKey;
+}
+
+RateLimiter::Bucket &RateLimiter::bucket(Endpoint endpoint, const QString &apiKey) {
+    QString key = bucketKey(endpoint, apiKey);
+    auto it = buckets.find(key);
+    if (it != buckets.end()) {
+        return *it;
+    }
+
+    Bucket created;
+    created.endpoint = endpoint;
+    created.apiKey = apiKey;
+    const Limits &limits = endpoint == Endpoint::Submit ? submitLimits : pollLimits;
+    created.maxRate = limits.rate;
+    created.burst = limits.burst;
+    created.maxConcurrency = limits.concurrency;
+    created.rate = created.maxRate;
+    created.tokens = created.burst;
+    created.concurrencyLimit = created.maxConcurrency;
+    created.lastRefill = clock.elapsed();
+    return *buckets.insert(key, created);
+}
+
+void RateLimiter::setLimits(Endpoint endpoint, double rate, int burst, int concurrency) {
+    Limits &limits = endpoint == Endpoint::Submit ? submitLimits : pollLimits;
+    limits = {qMax(MIN_RATE, rate), qMax(1, burst), qMax(1, concurrency)};
+
+    QStringList affected;
+    for (auto it = buckets.begin(); it != buckets.end(); ++it) {
+        if (it->endpoint != endpoint) {
+            continue;
+        }
+        refill(*it, clock.elapsed());
+        it->maxRate = limits.rate;
+        it->rate = qMin(it->rate, limits.rate);
+        it->burst = limits.burst;
+        it->maxConcurrency = limits.concurrency;
+        it->concurrencyLimit = qMin<double>(it->concurrencyLimit, limits.concurrency);
+        affected.append(it.key());
+    }
+    // pump 可能重入 acquire 并插入新桶，遍历结束后再处理
+    for (const QString &key : affected) {
+        pump(key);
+    }
+}
+
+void RateLimiter::refill(Bucket &bucket, qint64 now) {
+    bucket.tokens = qMin<double>(bucket.burst, bucket.tokens + (now - bucket.lastRefill) * bucket.rate / 1000.0);
+    bucket.lastRefill = now;
+}
+
+void RateLimiter::acquire(Endpoint endpoint, const QString &apiKey, QObject *context, std::function<void()> send) {
+    Bucket &b = bucket(endpoint, apiKey);
+    b.queue.append({context, std::move(send)});
+    pump(bucketKey(endpoint, apiKey));
+}
+
+void RateLimiter::release(Endpoint endpoint, const QString &apiKey, int httpStatus, const QByteArray &retryAfter) {
+    Bucket &b = bucket(endpoint, apiKey);
+    b.inFlight = qMax(0, b.inFlight - 1);
+
+    if (isThrottleStatus(httpStatus)) {
+        // 乘性减：速率和并发减半，并按 Retry-After 暂停整个桶
+        qint64 delay = parseRetryAfter(retryAfter);
+        if (delay < 0) {
+            delay = DEFAULT_RETRY_AFTER_MS;
+        }
+        delay = qMin<qint64>(delay, MAX_RETRY_AFTER_MS);
+
+        qint64 now = clock.elapsed();
+        refill(b, now);
+        b.blockedUntil = qMax(b.blockedUntil, now + delay);
+        b.rate = qMax(MIN_RATE, b.rate * DECREASE_FACTOR);
+        b.concurrencyLimit = qMax(1.0, b.concurrencyLimit * DECREASE_FACTOR);
+        b.tokens = qMin(b.tokens, 0.0);
+        b.throttleEvents++;
+
+        qDebug() << "Rate limited on" << endpointName(endpoint) << "(HTTP" << httpStatus << "), pausing" << delay
+                 << "ms, rate" << b.rate << "/s, concurrency" << b.concurrencyLimit;
+        emit throttled(endpointName(endpoint), delay);
+    } else if (httpStatus >= 200 && httpStatus < 300) {
+        // 加性增：每个成功响应恢复一点速率，并发上限每轮增加 1
+        b.rate = qMin(b.maxRate, b.rate + b.maxRate * 0.05);
+        b.concurrencyLimit = qMin<double>(b.maxConcurrency, b.concurrencyLimit + 1.0 / b.concurrencyLimit);
+    }
+
+    pump(bucketKey(endpoint, apiKey));
+}
+
+void RateLimiter::pump(const QString &key) {
+    while (true) {
+        auto it = buckets.find(key);
+        if (it == buckets.end() || it->queue.isEmpty()) {
+            break;
+        }
+        Bucket &b = *it;
+
+        if (b.queue.first().context.isNull()) {
+            b.queue.removeFirst();
+            continue;
+        }
+
+        qint64 now = clock.elapsed();
+        if (now < b.blockedUntil) {
+            schedulePump(key, b.blockedUntil - now);
+            break;
+        }
+        if (b.inFlight >= static_cast<int>(b.concurrencyLimit)) {
+            break;  // release 时继续
+        }
+        refill(b, now);
+        if (b.tokens < 1.0) {
+            schedulePump(key, static_cast<qint64>(std::ceil((1.0 - b.tokens) * 1000.0 / b.rate)));
+            break;
+        }
+
+        b.tokens -= 1.0;
+        b.inFlight++;
+        Waiter waiter = b.queue.takeFirst();
+        // send 可能重入 acquire/release，之后重新查找桶
+        waiter.send();
+    }
+    emit stateChanged();
+}
+
+void RateLimiter::schedulePump(const QString &key, qint64 delayMs) {
+    QTimer *timer = pumpTimers.value(key);
+    if (!timer) {
+        timer = new QTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, &QTimer::timeout, this, [this, key]() {
+            pump(key);
+        });
+        pumpTimers.insert(key, timer);
+    }
+    if (timer->isActive() && timer->remainingTime() <= delayMs) {
+        return;
+    }
+    timer->start(static_cast<int>(qMax<qint64>(1, delayMs)));
+}
+
+QList<RateLimiterState> RateLimiter::snapshot() const {
+    QList<RateLimiterState> states;
+    qint64 now = clock.elapsed();
+    for (const Bucket &b : buckets) {
+        RateLimiterState state;
+        state.endpoint = endpointName(b.endpoint);
+        state.apiKeyTag = b.apiKey.right(4);
+        state.tokens = qMin<double>(b.burst, b.tokens + (now - b.lastRefill) * b.rate / 1000.0);
+        state.rate = b.rate;
+        state.concurrencyLimit = static_cast<int>(b.concurrencyLimit);
+        state.inFlight = b.inFlight;
+        state.queued = b.queue.size();
+        state.throttleEvents = b.throttleEvents;
+        state.blockedForMs = qMax<qint64>(0, b.blockedUntil - now);
+        states.append(state);
+    }
+    return states;
+}
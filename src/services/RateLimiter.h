@@ -0,0 +1,110 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include "const/QtHeaders.h"
+#include <QElapsedTimer>
+#include <QPointer>
+#include <functional>
+
+// 单个 (端点, API Key) 限流桶的状态快照，供 UI 显示
+struct RateLimiterState {
+    QString endpoint;
+    QString apiKeyTag;         // API Key 末 4 位
+    double tokens = 0;
+    double rate = 0;           // 当前每秒令牌数（AIMD 调整后）
+    int concurrencyLimit = 0;  // 当前并发上限（AIMD 调整后）
+    int inFlight = 0;
+    int queued = 0;
+    quint64 throttleEvents = 0;  // 收到 429/503 的次数
+    qint64 blockedForMs = 0;     // Retry-After 剩余等待时间
+};
+
+// API 请求限流器：每个 (端点, API Key) 一个令牌桶，外加自适应并发上限。
+// 收到 429/503 时按 Retry-After 暂停该桶，并将速率和并发上限减半（乘性减）；
+// 成功响应逐步恢复（加性增），直到配置的上限。
+class RateLimiter : public QObject {
+    Q_OBJECT
+public:
+    enum class Endpoint {
+        Submit,  // 提交任务（文生视频 / 图生视频）
+        Poll     // 查询任务状态
+    };
+
+    explicit RateLimiter(QObject *parent = nullptr);
+
+    static RateLimiter *instance();  // 应用范围的共享实例
+
+    // 有令牌和并发槽位时调用 send；context 销毁后不再调用。
+    // 每次 send 之后必须调用一次 release。
+    void acquire(Endpoint endpoint, const QString &apiKey, QObject *context, std::function<void()> send);
+    // 请求结束：httpStatus 为 429/503 时按 retryAfter 退避
+    void release(Endpoint endpoint, const QString &apiKey, int httpStatus, const QByteArray &retryAfter = QByteArray());
+
+    QList<RateLimiterState> snapshot() const;
+
+    // 修改端点的配置上限（默认见下方常量），已有的桶立即生效
+    void setLimits(Endpoint endpoint, double rate, int burst, int concurrency);
+
+    static QString endpointName(Endpoint endpoint);
+    static bool isThrottleStatus(int httpStatus);
+    static qint64 parseRetryAfter(const QByteArray &value);  // 毫秒，无法解析时返回 -1
+
+    // 每个端点的配置上限
+    static constexpr double SUBMIT_RATE = 1.0;   // 每秒提交数
+    static const int SUBMIT_BURST = 3;
+    static const int SUBMIT_CONCURRENCY = 4;
+    static constexpr double POLL_RATE = 10.0;    // 每秒查询数
+    static const int POLL_BURST = 10;
+    static const int POLL_CONCURRENCY = 8;
+
+    static constexpr double MIN_RATE = 0.1;
+    static constexpr double DECREASE_FACTOR = 0.5;
+    static const int DEFAULT_RETRY_AFTER_MS = 5000;  // 429/503 未带 Retry-After 时的暂停时间
+    static const int MAX_RETRY_AFTER_MS = 300000;
+
+signals:
+    void stateChanged();
+    void throttled(const QString &endpoint, qint64 retryAfterMs);
+
+private:
+    struct Limits {
+        double rate;
+        int burst;
+        int concurrency;
+    };
+
+    struct Waiter {
+        QPointer<QObject> context;
+        std::function<void()> send;
+    };
+
+    struct Bucket {
+        Endpoint endpoint = Endpoint::Submit;
+        QString apiKey;
+        double tokens = 0;
+        double rate = 0;
+        double maxRate = 0;
+        int burst = 1;
+        double concurrencyLimit = 1;  // 以小数累积加性增长
+        int maxConcurrency = 1;
+        int inFlight = 0;
+        quint64 throttleEvents = 0;
+        qint64 blockedUntil = 0;  // clock 毫秒
+        qint64 lastRefill = 0;
+        QList<Waiter> queue;
+    };
+
+    Bucket &bucket(Endpoint endpoint, const QString &apiKey);
+    void refill(Bucket &bucket, qint64 now);
+    void pump(const QString &key);
+    void schedulePump(const QString &key, qint64 delayMs);
+    static QString bucketKey(Endpoint endpoint, const QString &apiKey);
+
+    Limits submitLimits{SUBMIT_RATE, SUBMIT_BURST, SUBMIT_CONCURRENCY};
+    Limits pollLimits{POLL_RATE, POLL_BURST, POLL_CONCURRENCY};
+    QMap<QString, Bucket> buckets;
+    QMap<QString, QTimer *> pumpTimers;
+    QElapsedTimer clock;
+};
+
+#endif // RATELIMITER_H
@@ -0,0 +1,110 @@
+#include "RequestCache.h"
+#include "TaskDatabaseService.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+QString sha256(const QByteArray &data) {
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+// 按 ApiService 发送时的类型和默认值规范化，使省略参数和显式写出默认值得到同一个地址
+QJsonObject normalizeParams(const QMap<QString, QString> &params, bool imageToVideo) {
+    QJsonObject result;
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+        const QString &name = it.key();
+        QString value = it.value().trimmed();
+        if (name == "width" || name == "height" || name == "duration" || name == "seed") {
+            result[name] = value.toLongLong();
+        } else if (name == "camera_fixed") {
+            result[name] = value == "true";
+        } else {
+            result[name] = value;
+        }
+    }
+
+    auto setDefault = [&result](const QString &name, const QJsonValue &value) {
+        if (!result.contains(name)) {
+            result[name] = value;
+        }
+    };
+    if (!imageToVideo) {
+        setDefault("width", 1280);
+    }
+    setDefault("resolution", "1080p");
+    setDefault("aspect_ratio", "16:9");
+    setDefault("duration", 5);
+    setDefault("camera_fixed", false);
+    setDefault("seed", 123);
+    return result;
+}
+
+} // namespace
+
+RequestCache::RequestCache(TaskDatabaseService *dbService) : dbService(dbService) {
+}
+
+QString RequestCache::requestHash(const QString &endpoint, bool imageToVideo, const QString &prompt,
+                                  const QMap<QString, QString> &params,
+                                  const QString &imageData, const QString &lastImageData) {
+    QJsonObject normalizedParams = normalizeParams(params, imageToVideo);
+    if (normalizedParams["seed"].toInteger() < 0) {
+        return QString();
+    }
+
+    QJsonObject request;
+    request["endpoint"] = endpoint;
+    request["mode"] = imageToVideo ? "i2v" : "t2v";
+    request["prompt"] = prompt.trimmed();
+    request["params"] = normalizedParams;
+    if (imageToVideo) {
+        request["image"] = sha256(imageData.toUtf8());
+        if (!lastImageData.isEmpty()) {
+            request["last_image"] = sha256(lastImageData.toUtf8());
+        }
+    }
+    // QJsonObject 按键名排序，序列化结果与参数的插入顺序无关
+    return sha256(QJsonDocument(request).toJson(QJsonDocument::Compact));
+}
+
+QFuture<TaskItem> RequestCache::lookup(const QString &requestHash) {
+    // 文件是否存在也在数据库线程中检查
+    return dbService->run([requestHash](TaskDatabase &db) {
+        TaskItem fallback;
+        const QList<TaskItem> candidates = db.getCompletedTasksByRequestHash(requestHash);
+        for (const TaskItem &task : candidates) {
+            if (!task.localFilePath.isEmpty() && QFile::exists(task.localFilePath)) {
+                return task;
+            }
+            if (fallback.taskId.isEmpty() && !task.videoUrl.isEmpty()) {
+                fallback = task;
+            }
+        }
+
+        // 本地文件已删除时重新下载；视频 URL 过期时由调用方回退为重新提交
+        fallback.localFilePath.clear();
+        return fallback;
+    });
+}
+
+void RequestCache::recordLookup(bool hit) {
+    counters.lookups++;
+    if (hit) {
+        counters.hits++;
+    }
+}
+
+void RequestCache::recordBypass() {
+    counters.bypassed++;
+}
+
+void RequestCache::recordUncacheable() {
+    counters.uncacheable++;
+}
+
+RequestCacheStats RequestCache::stats() const {
+    return counters;
+}
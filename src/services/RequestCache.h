@@ -0,0 +1,47 @@
+#ifndef REQUESTCACHE_H
+#define REQUESTCACHE_H
+
+#include "const/QtHeaders.h"
+#include "models/TaskItem.h"
+#include <QFuture>
+
+class TaskDatabaseService;
+
+// 结果缓存的命中统计（本次运行）
+struct RequestCacheStats {
+    quint64 lookups = 0;   // 查找次数（不含跳过缓存的请求）
+    quint64 hits = 0;
+    quint64 bypassed = 0;  // 显式跳过缓存的请求
+    quint64 uncacheable = 0;  // 随机种子等无法缓存的请求
+
+    double hitRate() const { return lookups > 0 ? static_cast<double>(hits) / lookups : 0.0; }
+};
+
+// 生成请求的结果缓存：以规范化请求的 SHA-256 作为内容地址，存在 tasks.db 的
+// request_hash 列中。提交前按地址查找已完成的任务，命中时直接复用其本地视频或视频 URL。
+//
+// 规范化：提示词去掉首尾空白；参数按类型解析（数值、布尔），省略的参数按 ApiService
+// 的默认值补齐；图生视频的首帧和尾帧以内容摘要参与计算。键按名称排序后序列化为 JSON。
+class RequestCache {
+public:
+    explicit RequestCache(TaskDatabaseService *dbService);
+
+    // seed 为负数（由服务端随机）的请求每次结果不同，返回空字符串
+    static QString requestHash(const QString &endpoint, bool imageToVideo, const QString &prompt,
+                               const QMap<QString, QString> &params,
+                               const QString &imageData = "", const QString &lastImageData = "");
+
+    // 在数据库线程中查找可复用的已完成任务：优先本地文件仍存在的，其次有视频 URL 的；
+    // 未命中时 taskId 为空。结果返回后由调用方用 recordLookup 计入统计
+    QFuture<TaskItem> lookup(const QString &requestHash);
+    void recordLookup(bool hit);
+    void recordBypass();
+    void recordUncacheable();
+    RequestCacheStats stats() const;
+
+private:
+    TaskDatabaseService *dbService;
+    RequestCacheStats counters;
+};
+
+#endif // REQUESTCACHE_H
@@ -0,0 +1,44 @@
+#include "RetryPolicy.h"
+#include <QRandomGenerator>
+
+RetryPolicy::RetryPolicy(int maxAttempts, int baseDelayMs, int maxDelayMs)
+    : attempts(qMax(1, maxAttempts)), baseDelay(qMax(1, baseDelayMs)), maxDelay(qMax(baseDelayMs, maxDelayMs)) {
+}
+
+bool RetryPolicy::isRetryable(QNetworkReply::NetworkError error, int httpStatus) {
+    if (httpStatus > 0) {
+        // 服务器已给出响应：5xx、408 超时和 429 可重试，其余 4xx 是请求本身的问题
+        return httpStatus >= 500 || httpStatus == 408 || httpStatus == 429;
+    }
+
+    switch (error) {
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::OperationCanceledError:  // 传输超时也以取消的形式报告
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyConnectionClosedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool RetryPolicy::shouldRetry(int attempt, QNetworkReply::NetworkError error, int httpStatus) const {
+    return attempt < attempts && isRetryable(error, httpStatus);
+}
+
+int RetryPolicy::delayForAttempt(int attempt) const {
+    // full jitter：在 [0, min(上限, 基数 × 2^(attempt-1))] 内均匀取值，最少等待半个基数
+    qint64 ceiling = qMin<qint64>(maxDelay, qint64(baseDelay) << qMin(attempt - 1, 20));
+    qint64 jittered = QRandomGenerator::global()->bounded(ceiling + 1);
+    return static_cast<int>(qMax<qint64>(baseDelay / 2, jittered));
+}
+
+int RetryPolicy::maxAttempts() const {
+    return attempts;
+}
@@ -0,0 +1,26 @@
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+#include <QNetworkReply>
+
+// 请求重试策略：区分可重试错误（超时、5xx、连接被重置等）和致命错误（4xx 参数校验等），
+// 可重试错误按带上限的指数退避重试，延迟使用 full jitter 打散，避免多个任务同时重试。
+class RetryPolicy {
+public:
+    RetryPolicy(int maxAttempts = 5, int baseDelayMs = 1000, int maxDelayMs = 30000);
+
+    // 429/503 由 RateLimiter 按 Retry-After 处理，这里只在限流重排用尽后视为可重试
+    static bool isRetryable(QNetworkReply::NetworkError error, int httpStatus);
+
+    bool shouldRetry(int attempt, QNetworkReply::NetworkError error, int httpStatus) const;  // attempt 从 1 开始
+    int delayForAttempt(int attempt) const;  // 第 attempt 次失败后的等待时间（毫秒）
+
+    int maxAttempts() const;
+
+private:
+    int attempts;
+    int baseDelay;
+    int maxDelay;
+};
+
+#endif // RETRYPOLICY_H
@@ -0,0 +1,362 @@
+#include "SegmentedDownload.h"
+#include "VideoDownload.h"
+#include "NetworkClient.h"
+#include "DownloadScheduler.h"
+#include "utils/Mp4Verifier.h"
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <algorithm>
+
+SegmentedDownload::SegmentedDownload(NetworkClient *network, const QUrl &url, const QString &destPath,
+                                     int segmentCount, QObject *parent)
+    : QObject(parent), network(network), sourceUrl(url), destPath(destPath), segmentCount(qMax(1, segmentCount)),
+      journal(nullptr), schedulerId(0), probeReply(nullptr), singleStream(nullptr), integrityError(false), totalSize(-1),
+      totalWritten(0), done(false) {
+    stagingFile.setFileName(stagingPath());
+}
+
+SegmentedDownload::~SegmentedDownload() {
+    if (probeReply) {
+        probeReply->abort();
+    }
+    abortSegments();
+}
+
+void SegmentedDownload::setJournal(TaskDatabaseService *journal, const QString &taskId) {
+    this->journal = journal;
+    this->taskId = taskId;
+}
+
+QString SegmentedDownload::destinationPath() const {
+    return destPath;
+}
+
+QString SegmentedDownload::stagingPath() const {
+    return destPath + ".part";
+}
+
+bool SegmentedDownload::isSegmented() const {
+    return !segments.isEmpty();
+}
+
+void SegmentedDownload::setSchedulerId(quint64 id) {
+    schedulerId = id;
+}
+
+QByteArray SegmentedDownload::contentHash() const {
+    return singleStream ? singleStream->contentHash() : digest;
+}
+
+bool SegmentedDownload::integrityFailed() const {
+    return singleStream ? singleStream->integrityFailed() : integrityError;
+}
+
+void SegmentedDownload::start() {
+    if (segmentCount <= 1) {
+        startSingleStream();
+        return;
+    }
+
+    // 探测：请求第一个字节，206 + Content-Range 同时给出 Range 支持和文件总大小。
+    // 不用 HEAD，因为签名 URL 通常只对 GET 有效。
+    QNetworkRequest request{sourceUrl};
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setRawHeader("Range", "bytes=0-0");
+    probeReply = network->get(request, NetworkClient::Traffic::Download);
+    probeReply->setReadBufferSize(READ_BUFFER_SIZE);
+    connect(probeReply, &QNetworkReply::finished, this, &SegmentedDownload::onProbeFinished);
+    connect(probeReply, &QNetworkReply::metaDataChanged, this, [this]() {
+        // 服务器忽略 Range 返回完整内容时立即中止，避免把整个文件下载一遍
+        int status = probeReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status == 200) {
+            probeReply->abort();
+        }
+    });
+}
+
+void SegmentedDownload::onProbeFinished() {
+    QNetworkReply *reply = probeReply;
+    probeReply = nullptr;
+    reply->deleteLater();
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray contentRange = reply->rawHeader("Content-Range");
+    qint64 size = -1;
+    int slash = contentRange.indexOf('/');
+    if (status == 206 && contentRange.startsWith("bytes ") && slash > 0) {
+        size = contentRange.mid(slash + 1).toLongLong();  // "*" 解析为 0
+    }
+
+    if (size < MIN_SEGMENTED_SIZE) {
+        qDebug() << "Segmented download not used for" << destPath << "(status" << status
+                 << ", size" << size << "), falling back to single stream";
+        startSingleStream();
+        return;
+    }
+
+    QByteArray etag = reply->rawHeader("ETag");
+    validator = (!etag.isEmpty() && !etag.startsWith("W/")) ? etag : reply->rawHeader("Last-Modified");
+    startSegments(size);
+}
+
+void SegmentedDownload::startSingleStream() {
+    singleStream = new VideoDownload(network, sourceUrl, destPath, this);
+    if (journal) {
+        singleStream->setJournal(journal, taskId);
+    }
+    singleStream->setSchedulerId(schedulerId);
+    connect(singleStream, &VideoDownload::progress, this, &SegmentedDownload::progress);
+    connect(singleStream, &VideoDownload::finished, this, &SegmentedDownload::finished);
+    connect(singleStream, &VideoDownload::failed, this, &SegmentedDownload::failed);
+    singleStream->start();
+}
+
+void SegmentedDownload::startSegments(qint64 size) {
+    QDir dir = QFileInfo(destPath).absoluteDir();
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+
+    // 预分配完整大小，各段直接写到自己的偏移处
+    if (!stagingFile.open(QIODevice::ReadWrite | QIODevice::Truncate) || !stagingFile.resize(size)) {
+        fail("无法创建暂存文件: " + stagingFile.errorString());
+        return;
+    }
+
+    totalSize = size;
+    int count = static_cast<int>(qMin<qint64>(segmentCount, size / (MIN_SEGMENTED_SIZE / 4)));
+    count = qMax(1, count);
+    qint64 segmentSize = size / count;
+
+    segments.resize(count);
+    for (int i = 0; i < count; ++i) {
+        segments[i].start = i * segmentSize;
+        segments[i].end = (i == count - 1) ? size - 1 : (i + 1) * segmentSize - 1;
+    }
+
+    qDebug() << "Segmented download of" << destPath << ":" << size << "bytes in" << count << "segments";
+    for (int i = 0; i < count; ++i) {
+        requestSegment(i);
+    }
+}
+
+void SegmentedDownload::requestSegment(int index) {
+    Segment &segment = segments[index];
+    QNetworkRequest request{sourceUrl};
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setRawHeader("Range", "bytes=" + QByteArray::number(segment.start + segment.written)
+                         + "-" + QByteArray::number(segment.end));
+    if (!validator.isEmpty()) {
+        request.setRawHeader("If-Range", validator);
+    }
+    // 并行度同时受 NetworkClient 的每主机连接上限约束
+    segment.reply = network->get(request, NetworkClient::Traffic::Segmented);
+    segment.reply->setReadBufferSize(READ_BUFFER_SIZE);
+    connect(segment.reply, &QNetworkReply::readyRead, this, [this, index]() {
+        onSegmentReadyRead(index);
+    });
+    connect(segment.reply, &QNetworkReply::finished, this, [this, index]() {
+        onSegmentFinished(index);
+    });
+}
+
+void SegmentedDownload::onSegmentReadyRead(int index) {
+    if (!writeSegment(index, segments[index].reply, true)) {
+        handleSegmentWriteFailure();
+        return;
+    }
+    emit progress(totalWritten, totalSize);
+}
+
+bool SegmentedDownload::writeSegment(int index, QNetworkReply *reply, bool throttled) {
+    Segment &segment = segments[index];
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status >= 400) {
+        // 错误响应体丢弃，错误由 finished 处理（可重试）
+        reply->skip(reply->bytesAvailable());
+        return true;
+    }
+    if (status != 206) {
+        // 200 表示 If-Range 校验失败（文件已变化）或服务器不再接受 Range
+        return false;
+    }
+
+    // 单线程事件循环中 seek + write 不会与其他段交错
+    DownloadScheduler *scheduler = DownloadScheduler::instance();
+    char buffer[64 * 1024];
+    while (reply->bytesAvailable() > 0 && !segment.isDone()) {
+        qint64 wanted = std::min({static_cast<qint64>(sizeof(buffer)), segment.length() - segment.written,
+                                  reply->bytesAvailable()});
+        if (throttled) {
+            wanted = scheduler->takeBytes(schedulerId, wanted);
+            if (wanted == 0) {
+                scheduleThrottledRead(index);
+                break;
+            }
+        }
+        qint64 n = reply->read(buffer, wanted);
+        if (n <= 0) {
+            break;
+        }
+        if (!throttled) {
+            scheduler->consumeBytes(n);
+        }
+        if (!stagingFile.seek(segment.start + segment.written) || stagingFile.write(buffer, n) != n) {
+            return false;
+        }
+        segment.written += n;
+        totalWritten += n;
+    }
+    return true;
+}
+
+void SegmentedDownload::scheduleThrottledRead(int index) {
+    // 缓冲区中已有的数据不会再触发 readyRead，需要自行安排下一次读取
+    if (segments[index].readPending) {
+        return;
+    }
+    segments[index].readPending = true;
+    QTimer::singleShot(DownloadScheduler::instance()->msUntilBytesAvailable(schedulerId), this, [this, index]() {
+        // 期间可能已退化为单连接（segments 被清空）或已结束
+        if (done || index >= segments.size()) {
+            return;
+        }
+        segments[index].readPending = false;
+        if (segments[index].reply && segments[index].reply->bytesAvailable() > 0) {
+            onSegmentReadyRead(index);
+        }
+    });
+}
+
+void SegmentedDownload::handleSegmentWriteFailure() {
+    if (stagingFile.error() != QFileDevice::NoError) {
+        fail("写入暂存文件失败: " + stagingFile.errorString());
+        return;
+    }
+    // 服务器不再按范围返回，放弃分段，改为单连接从头下载
+    qDebug() << "Server stopped honoring ranges for" << destPath << ", falling back to single stream";
+    abortSegments();
+    stagingFile.close();
+    stagingFile.remove();
+    segments.clear();
+    totalWritten = 0;
+    startSingleStream();
+}
+
+void SegmentedDownload::onSegmentFinished(int index) {
+    if (done) {
+        return;
+    }
+    Segment &segment = segments[index];
+    QNetworkReply *reply = segment.reply;
+    segment.reply = nullptr;
+    reply->deleteLater();
+
+    // 请求已结束，限速时留在缓冲区中的剩余数据直接读完（计入带宽预算）
+    if (reply->error() == QNetworkReply::NoError && !writeSegment(index, reply, false)) {
+        handleSegmentWriteFailure();
+        return;
+    }
+
+    if (!segment.isDone()) {
+        if (segment.retries < MAX_SEGMENT_RETRIES
+            && (reply->error() == QNetworkReply::NoError || VideoDownload::isResumableError(reply->error()))) {
+            // 只重新请求该段剩余的部分
+            segment.retries++;
+            qDebug() << "Segment" << index << "incomplete (" << reply->errorString() << "), retry" << segment.retries;
+            requestSegment(index);
+            return;
+        }
+        fail("分段下载失败: " + reply->errorString());
+        return;
+    }
+
+    emit progress(totalWritten, totalSize);
+    for (const Segment &s : segments) {
+        if (!s.isDone()) {
+            return;
+        }
+    }
+    finishSegmented();
+}
+
+void SegmentedDownload::finishSegmented() {
+    done = true;
+    if (!stagingFile.flush()) {
+        fail("写入暂存文件失败: " + stagingFile.errorString());
+        return;
+    }
+    // 哈希和结构检查共用一次顺序读取
+    QCryptographicHash hasher(QCryptographicHash::Sha256);
+    Mp4Verifier verifier;
+    stagingFile.seek(0);
+    char buffer[64 * 1024];
+    qint64 n;
+    while ((n = stagingFile.read(buffer, sizeof(buffer))) > 0) {
+        hasher.addData(QByteArrayView(buffer, n));
+        verifier.addData(buffer, n);
+    }
+    digest = hasher.result();
+    stagingFile.close();
+
+    QString problem;
+    if (totalWritten != totalSize || verifier.bytesSeen() != totalSize) {
+        problem = QString("收到 %1 字节，应为 %2 字节").arg(totalWritten).arg(totalSize);
+    }
+    if (!problem.isEmpty() || !verifier.finish(&problem)) {
+        integrityError = true;
+        qWarning() << "Downloaded file" << destPath << "failed verification:" << problem;
+        stagingFile.remove();
+        emit failed("下载的视频不完整或已损坏: " + problem);
+        return;
+    }
+
+    if (!VideoDownload::atomicReplace(stagingPath(), destPath)) {
+        stagingFile.remove();
+        emit failed("无法保存视频文件: " + destPath);
+        return;
+    }
+    emit finished(destPath);
+}
+
+void SegmentedDownload::abort() {
+    if (singleStream) {
+        singleStream->abort();
+        return;
+    }
+    if (probeReply) {
+        probeReply->abort();
+        return;
+    }
+    if (!segments.isEmpty()) {
+        fail("下载已取消");
+    }
+}
+
+void SegmentedDownload::abortSegments() {
+    for (Segment &segment : segments) {
+        if (segment.reply) {
+            QNetworkReply *reply = segment.reply;
+            segment.reply = nullptr;
+            reply->disconnect(this);
+            reply->abort();
+            reply->deleteLater();
+        }
+    }
+}
+
+void SegmentedDownload::fail(const QString &error) {
+    if (done) {
+        return;
+    }
+    done = true;
+    abortSegments();
+    if (stagingFile.isOpen()) {
+        stagingFile.close();
+    }
+    stagingFile.remove();
+    emit failed(error);
+}
@@ -0,0 +1,94 @@
+#ifndef SEGMENTEDDOWNLOAD_H
+#define SEGMENTEDDOWNLOAD_H
+
+#include "const/QtHeaders.h"
+#include <QFile>
+#include <QUrl>
+#include <QVector>
+
+class QNetworkReply;
+class TaskDatabaseService;
+class NetworkClient;
+class VideoDownload;
+
+// 多连接分段下载：先用 "Range: bytes=0-0" 探测文件大小和 Range 支持，
+// 再把文件切成 K 段并行请求，按偏移写入预分配的暂存文件，全部完成后原子重命名。
+// 服务器不支持 Range、文件过小或 K <= 1 时退化为单连接的 VideoDownload（支持断点续传）。
+// 分段乱序到达，无法边写边算：完成后顺序读一遍暂存文件，同时计算 SHA-256 和检查 MP4 结构。
+class SegmentedDownload : public QObject {
+    Q_OBJECT
+public:
+    SegmentedDownload(NetworkClient *network, const QUrl &url, const QString &destPath,
+                      int segmentCount, QObject *parent = nullptr);
+    ~SegmentedDownload();
+
+    void setJournal(TaskDatabaseService *journal, const QString &taskId);  // 仅单连接模式使用
+    void setSchedulerId(quint64 id);  // DownloadScheduler 中的编号，带宽预算按其优先级分配
+    void start();
+    void abort();
+
+    QString destinationPath() const;
+    QString stagingPath() const;
+    bool isSegmented() const;  // 探测后是否采用了分段模式
+    QByteArray contentHash() const;  // 完成后有效：文件内容的 SHA-256
+    bool integrityFailed() const;    // 失败原因是内容不完整或已损坏（可重新下载）
+
+    static constexpr qint64 MIN_SEGMENTED_SIZE = 4 * 1024 * 1024;  // 小于 4MB 不分段
+    static constexpr qint64 READ_BUFFER_SIZE = 256 * 1024;
+    static const int MAX_SEGMENT_RETRIES = 3;
+
+signals:
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
+    void finished(const QString &localPath);
+    void failed(const QString &error);
+
+private slots:
+    void onProbeFinished();
+
+private:
+    struct Segment {
+        qint64 start = 0;
+        qint64 end = 0;       // 包含
+        qint64 written = 0;
+        int retries = 0;
+        QNetworkReply *reply = nullptr;
+        bool readPending = false;  // 带宽预算不足，已安排稍后读取
+
+        qint64 length() const { return end - start + 1; }
+        bool isDone() const { return written >= length(); }
+    };
+
+    void startSingleStream();
+    void startSegments(qint64 totalSize);
+    void requestSegment(int index);
+    void onSegmentReadyRead(int index);
+    // throttled 为 true 时只读取带宽预算允许的部分，其余稍后再读
+    bool writeSegment(int index, QNetworkReply *reply, bool throttled);
+    void scheduleThrottledRead(int index);
+    void handleSegmentWriteFailure();
+    void onSegmentFinished(int index);
+    void abortSegments();
+    void finishSegmented();
+    void fail(const QString &error);
+
+    NetworkClient *network;
+    QUrl sourceUrl;
+    QString destPath;
+    int segmentCount;
+    TaskDatabaseService *journal;
+    QString taskId;
+    quint64 schedulerId;
+
+    QNetworkReply *probeReply;
+    VideoDownload *singleStream;
+    QFile stagingFile;
+    QVector<Segment> segments;
+    QByteArray digest;     // 分段乱序写入，完成后读一遍暂存文件计算
+    bool integrityError;
+    QByteArray validator;  // 探测得到的 ETag/Last-Modified，用于 If-Range 保证各段来自同一文件
+    qint64 totalSize;
+    qint64 totalWritten;
+    bool done;
+};
+
+#endif // SEGMENTEDDOWNLOAD_H
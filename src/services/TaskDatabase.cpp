@@ -0,0 +1,1077 @@
+#include "TaskDatabase.h"
+#include "utils/SignedUrl.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QDebug>
+#include <iterator>
+
+namespace {
+
+// 各投影的列按固定顺序选出，解码时按序号读取，不再逐行逐列按名称查找。
+// 枚举顺序必须与列清单一致
+
+// 详情投影：TaskItem 的全部列
+const QString TASK_COLUMNS =
+    "task_id, prompt, api_key, width, height, resolution, aspect_ratio, duration, camera_fixed, seed, "
+    "status, error_message, video_url, local_file_path, create_time, update_time, complete_time, "
+    "last_played_time, submit_attempts, submit_latency_ms, batch_id, request_hash, video_hash, video_url_expires";
+
+enum TaskColumn {
+    TaskId, Prompt, ApiKey, Width, Height, Resolution, AspectRatio, Duration, CameraFixed, Seed,
+    Status, ErrorMessage, VideoUrl, LocalFilePath, CreateTime, UpdateTime, CompleteTime,
+    LastPlayedTime, SubmitAttempts, SubmitLatencyMs, BatchId, RequestHash, VideoHash, VideoUrlExpires
+};
+
+// 列表投影：TaskSummary，提示词只取预览长度
+const QString SUMMARY_COLUMNS =
+    QString("task_id, substr(prompt, 1, %1), status, video_url, local_file_path, create_time, complete_time")
+        .arg(TaskSummary::PROMPT_PREVIEW_LENGTH + 1);
+
+enum SummaryColumn {
+    SummaryTaskId, SummaryPrompt, SummaryStatus, SummaryVideoUrl, SummaryLocalFilePath,
+    SummaryCreateTime, SummaryCompleteTime
+};
+
+// 轮询投影：PendingTask
+const QString PENDING_COLUMNS = "task_id, api_key, status";
+
+enum PendingColumn {
+    PendingTaskId, PendingApiKey, PendingStatus
+};
+
+// 断点续传日志：DownloadJournalEntry
+const QString JOURNAL_COLUMNS = "dest_path, task_id, url, bytes_done, total_bytes, etag, last_modified, update_time";
+
+enum JournalColumn {
+    JournalDestPath, JournalTaskId, JournalUrl, JournalBytesDone, JournalTotalBytes, JournalEtag,
+    JournalLastModified, JournalUpdateTime
+};
+
+// 视频存储：VideoBlob。淘汰候选在三列之后多选出 last_used
+const QString BLOB_COLUMNS = "hash, path, size";
+
+enum BlobColumn {
+    BlobHash, BlobPath, BlobSize, BlobLastUsed
+};
+
+} // namespace
+
+TaskDatabase::TaskDatabase(QObject *parent) : QObject(parent) {
+}
+
+TaskDatabase::~TaskDatabase() {
+    close();
+}
+
+bool TaskDatabase::open(const QString &dbPath, const QString &connectionName, StorageProfile profile) {
+    qDebug() << "Database path:" << dbPath;
+    this->profile = profile;
+
+    // 每个实例使用独立命名的连接，连接只能在创建它的线程中使用
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(dbPath);
+    // 批处理与界面同时打开 tasks.db 时等待对方的写事务，而不是立即报 "database is locked"
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (!db.open()) {
+        emit databaseError("无法打开数据库: " + db.lastError().text());
+        return false;
+    }
+
+    return applyProfile() && migrate();
+}
+
+bool TaskDatabase::applyProfile() {
+    if (profile != StorageProfile::Tuned) {
+        return true;
+    }
+    QSqlQuery query(db);
+    // WAL：读写互不阻塞，提交只追加日志；synchronous=NORMAL 时只在检查点 fsync，
+    // 断电最多丢失最近的事务，数据库不会损坏
+    if (!query.exec("PRAGMA journal_mode=WAL") || !query.next()) {
+        emit databaseError("设置数据库日志模式失败: " + query.lastError().text());
+        return false;
+    }
+    if (query.value(0).toString().compare("wal", Qt::CaseInsensitive) != 0) {
+        qDebug() << "WAL not available, journal mode is" << query.value(0).toString();  // 如网络文件系统
+    }
+    query.finish();
+    query.exec("PRAGMA synchronous=NORMAL");
+    query.exec(QString("PRAGMA cache_size=-%1").arg(CACHE_SIZE_KB));  // 负数表示 KB
+    query.exec(QString("PRAGMA mmap_size=%1").arg(MMAP_SIZE));
+    query.exec("PRAGMA temp_store=MEMORY");
+    return true;
+}
+
+QSqlQuery &TaskDatabase::statement(const QString &sql) {
+    if (profile != StorageProfile::Tuned) {
+        scratch = std::make_unique<QSqlQuery>(db);
+        scratch->prepare(sql);
+        return *scratch;
+    }
+    auto it = statements.find(sql);
+    if (it == statements.end()) {
+        auto query = std::make_unique<QSqlQuery>(db);
+        query->prepare(sql);
+        it = statements.emplace(sql, std::move(query)).first;
+    }
+    return *it->second;
+}
+
+bool TaskDatabase::transaction(const std::function<bool()> &work) {
+    if (!db.transaction()) {
+        emit databaseError("开始事务失败: " + db.lastError().text());
+        return false;
+    }
+    if (!work()) {
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        emit databaseError("提交事务失败: " + db.lastError().text());
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool TaskDatabase::updateTasks(const QList<TaskItem> &tasks) {
+    return transaction([&]() {
+        for (const TaskItem &task : tasks) {
+            if (!updateTask(task)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+void TaskDatabase::close() {
+    // 语句必须在连接关闭前释放
+    statements.clear();
+    scratch.reset();
+    if (!db.isValid()) {
+        return;
+    }
+    QString connectionName = db.connectionName();
+    db.close();
+    db = QSqlDatabase();  // removeDatabase 前释放对连接的引用
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool TaskDatabase::migrate() {
+    struct Migration {
+        int version;
+        const char *description;
+        bool (TaskDatabase::*apply)();
+    };
+    // 只追加，不修改已发布的迁移；最后一项的版本即 SCHEMA_VERSION
+    static const Migration migrations[] = {
+        {1, "时间列改为毫秒时间戳，重建索引", &TaskDatabase::migrateToEpochMs},
+        {2, "列表索引改为 (create_time, task_id) 键集分页", &TaskDatabase::migrateListKeyset},
+        {3, "列表索引只保留分页键", &TaskDatabase::migrateListIndexKeyOnly},
+    };
+    static_assert(std::size(migrations) == SCHEMA_VERSION);
+
+    int version = schemaVersion();
+    if (version < 0) {
+        return false;
+    }
+    if (version > SCHEMA_VERSION) {
+        // 较新版本的程序升级过的数据库，旧程序按旧结构写入会损坏数据
+        emit databaseError(QString("数据库版本 %1 高于程序支持的版本 %2，请升级程序").arg(version).arg(SCHEMA_VERSION));
+        return false;
+    }
+    if (version == 0 && !createBaseline()) {
+        return false;
+    }
+
+    for (const Migration &migration : migrations) {
+        if (migration.version <= version) {
+            continue;
+        }
+        qDebug() << "Migrating tasks.db to version" << migration.version << ":" << migration.description;
+        // 迁移和版本号在同一个事务中提交，中途失败时数据库保持原版本，下次启动重新迁移
+        bool ok = transaction([&]() {
+            if (!(this->*migration.apply)()) {
+                return false;
+            }
+            QSqlQuery query(db);
+            if (!query.exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+                emit databaseError("更新数据库版本失败: " + query.lastError().text());
+                return false;
+            }
+            return true;
+        });
+        if (!ok) {
+            emit databaseError(QString("数据库升级到版本 %1 失败").arg(migration.version));
+            return false;
+        }
+        version = migration.version;
+    }
+    return true;
+}
+
+int TaskDatabase::schemaVersion() {
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        emit databaseError("读取数据库版本失败: " + query.lastError().text());
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+bool TaskDatabase::createBaseline() {
+    QSqlQuery query(db);
+
+    QString createTableSQL = R"(
+        CREATE TABLE IF NOT EXISTS tasks (
+            task_id TEXT PRIMARY KEY,
+            prompt TEXT NOT NULL,
+            api_key TEXT,
+            width INTEGER,
+            height INTEGER,
+            resolution TEXT,
+            aspect_ratio TEXT,
+            duration INTEGER,
+            camera_fixed INTEGER,
+            seed INTEGER,
+            status INTEGER,
+            error_message TEXT,
+            video_url TEXT,
+            local_file_path TEXT,
+            create_time TEXT,
+            update_time TEXT,
+            complete_time TEXT,
+            submit_attempts INTEGER DEFAULT 1,
+            submit_latency_ms INTEGER DEFAULT 0,
+            batch_id TEXT,
+            request_hash TEXT,
+            video_hash TEXT,
+            last_played_time TEXT,
+            video_url_expires TEXT
+        )
+    )";
+
+    if (!query.exec(createTableSQL)) {
+        emit databaseError("创建表失败: " + query.lastError().text());
+        return false;
+    }
+
+    // 旧版本数据库补充新增的列
+    if (!addColumnIfMissing("tasks", "submit_attempts", "INTEGER DEFAULT 1")
+        || !addColumnIfMissing("tasks", "submit_latency_ms", "INTEGER DEFAULT 0")
+        || !addColumnIfMissing("tasks", "batch_id", "TEXT")
+        || !addColumnIfMissing("tasks", "request_hash", "TEXT")
+        || !addColumnIfMissing("tasks", "video_hash", "TEXT")
+        || !addColumnIfMissing("tasks", "last_played_time", "TEXT")
+        || !addColumnIfMissing("tasks", "video_url_expires", "TEXT")) {
+        return false;
+    }
+
+    // 内容寻址存储中的视频：每个不同的内容一行，任务通过 tasks.video_hash 引用
+    QString createBlobsSQL = R"(
+        CREATE TABLE IF NOT EXISTS video_blobs (
+            hash TEXT PRIMARY KEY,
+            path TEXT,
+            size INTEGER,
+            create_time TEXT
+        )
+    )";
+
+    if (!query.exec(createBlobsSQL)) {
+        emit databaseError("创建视频存储表失败: " + query.lastError().text());
+        return false;
+    }
+    if (!addColumnIfMissing("video_blobs", "path", "TEXT")) {
+        return false;
+    }
+
+    // 断点续传日志：每个未完成的下载一行
+    QString createJournalSQL = R"(
+        CREATE TABLE IF NOT EXISTS download_journal (
+            dest_path TEXT PRIMARY KEY,
+            task_id TEXT,
+            url TEXT NOT NULL,
+            bytes_done INTEGER,
+            total_bytes INTEGER,
+            etag TEXT,
+            last_modified TEXT,
+            update_time TEXT
+        )
+    )";
+
+    if (!query.exec(createJournalSQL)) {
+        emit databaseError("创建下载日志表失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+bool TaskDatabase::migrateToEpochMs() {
+    // create_time 等列从 ISO 8601 文本改为毫秒时间戳（INTEGER，无值为 NULL）：
+    // 读取时不再逐行解析字符串，按时间排序比较整数
+    QString tasksSQL = R"(
+        CREATE TABLE %1 (
+            task_id TEXT PRIMARY KEY,
+            prompt TEXT NOT NULL,
+            api_key TEXT,
+            width INTEGER,
+            height INTEGER,
+            resolution TEXT,
+            aspect_ratio TEXT,
+            duration INTEGER,
+            camera_fixed INTEGER,
+            seed INTEGER,
+            status INTEGER,
+            error_message TEXT,
+            video_url TEXT,
+            local_file_path TEXT,
+            create_time INTEGER,
+            update_time INTEGER,
+            complete_time INTEGER,
+            submit_attempts INTEGER DEFAULT 1,
+            submit_latency_ms INTEGER DEFAULT 0,
+            batch_id TEXT,
+            request_hash TEXT,
+            video_hash TEXT,
+            last_played_time INTEGER,
+            video_url_expires INTEGER
+        )
+    )";
+    QString blobsSQL = R"(
+        CREATE TABLE %1 (
+            hash TEXT PRIMARY KEY,
+            path TEXT,
+            size INTEGER,
+            create_time INTEGER
+        )
+    )";
+    QString journalSQL = R"(
+        CREATE TABLE %1 (
+            dest_path TEXT PRIMARY KEY,
+            task_id TEXT,
+            url TEXT NOT NULL,
+            bytes_done INTEGER,
+            total_bytes INTEGER,
+            etag TEXT,
+            last_modified TEXT,
+            update_time INTEGER
+        )
+    )";
+
+    if (!rebuildTable("tasks", tasksSQL,
+                      {"create_time", "update_time", "complete_time", "last_played_time", "video_url_expires"})
+        || !rebuildTable("video_blobs", blobsSQL, {"create_time"})
+        || !rebuildTable("download_journal", journalSQL, {"update_time"})) {
+        return false;
+    }
+
+    // 旧索引随旧表删除。列表按创建时间倒序分页（附带的状态和完成时间列在版本 3 中去掉）；
+    // 未完成任务只占少数，部分索引只收录它们
+    const char *indexes[] = {
+        "CREATE INDEX idx_tasks_list ON tasks(create_time DESC, task_id, status, complete_time)",
+        "CREATE INDEX idx_tasks_pending ON tasks(create_time DESC) WHERE status IN (0, 1)",
+        "CREATE INDEX idx_tasks_completed ON tasks(complete_time DESC) WHERE status = 2",
+        "CREATE INDEX idx_tasks_batch ON tasks(batch_id, create_time) WHERE batch_id IS NOT NULL",
+        "CREATE INDEX idx_tasks_request_hash ON tasks(request_hash, status)",
+        "CREATE INDEX idx_tasks_video_hash ON tasks(video_hash)",
+        "CREATE INDEX idx_tasks_local_file_path ON tasks(local_file_path)",
+    };
+    QSqlQuery query(db);
+    for (const char *sql : indexes) {
+        if (!query.exec(sql)) {
+            emit databaseError("创建索引失败: " + query.lastError().text());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TaskDatabase::migrateListKeyset() {
+    // 列表按 (create_time, task_id) 键集分页，两列同向的索引可正反两个方向扫描，
+    // 升序和降序都不需要排序。分页键不能为空：补齐缺少创建时间的任务
+    const char *statements[] = {
+        "UPDATE tasks SET create_time = COALESCE(update_time, 0) WHERE create_time IS NULL",
+        "DROP INDEX IF EXISTS idx_tasks_list",
+        "CREATE INDEX idx_tasks_list ON tasks(create_time, task_id, status, complete_time)",
+    };
+    QSqlQuery query(db);
+    for (const char *sql : statements) {
+        if (!query.exec(sql)) {
+            emit databaseError("更新列表索引失败: " + query.lastError().text());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TaskDatabase::migrateListIndexKeyOnly() {
+    // 列表投影还要读取提示词、视频 URL 和本地路径，无论如何都要回表，索引中附带的
+    // 状态和完成时间列只会增大索引和写入开销；分页和排序只用到前两列
+    const char *statements[] = {
+        "DROP INDEX IF EXISTS idx_tasks_list",
+        "CREATE INDEX idx_tasks_list ON tasks(create_time, task_id)",
+    };
+    QSqlQuery query(db);
+    for (const char *sql : statements) {
+        if (!query.exec(sql)) {
+            emit databaseError("更新列表索引失败: " + query.lastError().text());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TaskDatabase::rebuildTable(const QString &table, const QString &createSQL, const QStringList &timeColumns) {
+    // SQLite 不能修改列类型：按新结构建表，逐行复制同名列，再替换旧表
+    QString newTable = table + "_new";
+    QSqlQuery query(db);
+    if (!query.exec(createSQL.arg(newTable))) {
+        emit databaseError("重建表失败: " + query.lastError().text());
+        return false;
+    }
+
+    auto columnsOf = [&](const QString &name) {
+        QStringList columns;
+        QSqlQuery info(db);
+        if (info.exec("PRAGMA table_info(" + name + ")")) {
+            while (info.next()) {
+                columns.append(info.value("name").toString());
+            }
+        }
+        return columns;
+    };
+    QStringList oldColumns = columnsOf(table);
+    QStringList columns;
+    for (const QString &column : columnsOf(newTable)) {
+        if (oldColumns.contains(column)) {
+            columns.append(column);
+        }
+    }
+
+    QList<bool> isTime;
+    for (const QString &column : columns) {
+        isTime.append(timeColumns.contains(column));
+    }
+    QStringList placeholders(columns.size(), "?");
+    QSqlQuery insert(db);
+    if (!insert.prepare(QString("INSERT INTO %1 (%2) VALUES (%3)")
+                            .arg(newTable, columns.join(", "), placeholders.join(", ")))) {
+        emit databaseError("重建表失败: " + insert.lastError().text());
+        return false;
+    }
+
+    query.setForwardOnly(true);
+    if (!query.exec(QString("SELECT %1 FROM %2").arg(columns.join(", "), table))) {
+        emit databaseError("重建表失败: " + query.lastError().text());
+        return false;
+    }
+    while (query.next()) {
+        for (int i = 0; i < columns.size(); ++i) {
+            QVariant value = query.value(i);
+            if (isTime[i]) {
+                QDateTime time = QDateTime::fromString(value.toString(), Qt::ISODate);
+                value = timeValue(time);
+            }
+            insert.bindValue(i, value);
+        }
+        if (!insert.exec()) {
+            emit databaseError("重建表失败: " + insert.lastError().text());
+            return false;
+        }
+    }
+    query.finish();
+
+    if (!query.exec("DROP TABLE " + table) || !query.exec(QString("ALTER TABLE %1 RENAME TO %2").arg(newTable, table))) {
+        emit databaseError("重建表失败: " + query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+bool TaskDatabase::addColumnIfMissing(const QString &table, const QString &column, const QString &definition) {
+    QSqlQuery query(db);
+    if (query.exec("PRAGMA table_info(" + table + ")")) {
+        while (query.next()) {
+            if (query.value("name").toString() == column) {
+                return true;
+            }
+        }
+    }
+
+    if (!query.exec("ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition)) {
+        emit databaseError("升级表结构失败: " + query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+QVariant TaskDatabase::timeValue(const QDateTime &time) {
+    return time.isValid() ? QVariant(time.toMSecsSinceEpoch()) : QVariant();
+}
+
+QDateTime TaskDatabase::timeFromValue(const QVariant &value) {
+    return value.isNull() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(value.toLongLong());
+}
+
+QVariant TaskDatabase::urlExpiryValue(const QString &videoUrl) {
+    // 过期时间总是从 URL 解析，与 video_url 一起写入，不会与之不一致
+    return timeValue(SignedUrl::expiry(videoUrl));
+}
+
+bool TaskDatabase::saveTask(const TaskItem &task) {
+    QSqlQuery &query = statement(R"(
+        INSERT INTO tasks (
+            task_id, prompt, api_key, width, height, resolution, aspect_ratio,
+            duration, camera_fixed, seed, status, error_message, video_url,
+            local_file_path, create_time, update_time, complete_time,
+            submit_attempts, submit_latency_ms, batch_id, request_hash, video_url_expires
+        ) VALUES (
+            :task_id, :prompt, :api_key, :width, :height, :resolution, :aspect_ratio,
+            :duration, :camera_fixed, :seed, :status, :error_message, :video_url,
+            :local_file_path, :create_time, :update_time, :complete_time,
+            :submit_attempts, :submit_latency_ms, :batch_id, :request_hash, :video_url_expires
+        )
+    )");
+
+    query.bindValue(":task_id", task.taskId);
+    query.bindValue(":prompt", task.prompt);
+    query.bindValue(":api_key", task.apiKey);
+    query.bindValue(":width", task.width);
+    query.bindValue(":height", task.height);
+    query.bindValue(":resolution", task.resolution);
+    query.bindValue(":aspect_ratio", task.aspectRatio);
+    query.bindValue(":duration", task.duration);
+    query.bindValue(":camera_fixed", task.cameraFixed ? 1 : 0);
+    query.bindValue(":seed", task.seed);
+    query.bindValue(":status", static_cast<int>(task.status));
+    query.bindValue(":error_message", task.errorMessage);
+    query.bindValue(":video_url", task.videoUrl);
+    query.bindValue(":local_file_path", task.localFilePath);
+    query.bindValue(":create_time", timeValue(task.createTime));
+    query.bindValue(":update_time", timeValue(task.updateTime));
+    query.bindValue(":complete_time", timeValue(task.completeTime));
+    query.bindValue(":submit_attempts", task.submitAttempts);
+    query.bindValue(":submit_latency_ms", task.submitLatencyMs);
+    query.bindValue(":batch_id", task.batchId.isEmpty() ? QVariant() : QVariant(task.batchId));
+    query.bindValue(":request_hash", task.requestHash.isEmpty() ? QVariant() : QVariant(task.requestHash));
+    query.bindValue(":video_url_expires", urlExpiryValue(task.videoUrl));
+
+    if (!query.exec()) {
+        qDebug() << "Save task error:" << query.lastError().text();
+        emit databaseError("保存任务失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+bool TaskDatabase::updateTask(const TaskItem &task) {
+    QSqlQuery &query = statement(R"(
+        UPDATE tasks SET
+            prompt = :prompt,
+            status = :status,
+            error_message = :error_message,
+            video_url = :video_url,
+            video_url_expires = :video_url_expires,
+            local_file_path = :local_file_path,
+            update_time = :update_time,
+            complete_time = :complete_time
+        WHERE task_id = :task_id
+    )");
+
+    query.bindValue(":task_id", task.taskId);
+    query.bindValue(":prompt", task.prompt);
+    query.bindValue(":status", static_cast<int>(task.status));
+    query.bindValue(":error_message", task.errorMessage);
+    query.bindValue(":video_url", task.videoUrl);
+    query.bindValue(":video_url_expires", urlExpiryValue(task.videoUrl));
+    query.bindValue(":local_file_path", task.localFilePath);
+    query.bindValue(":update_time", timeValue(task.updateTime));
+    query.bindValue(":complete_time", timeValue(task.completeTime));
+
+    if (!query.exec()) {
+        qDebug() << "Update task error:" << query.lastError().text();
+        emit databaseError("更新任务失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+TaskItem TaskDatabase::getTask(const QString &taskId) {
+    static const QString sql = QString("SELECT %1 FROM tasks WHERE task_id = :task_id").arg(TASK_COLUMNS);
+    QSqlQuery &query = statement(sql);
+    query.bindValue(":task_id", taskId);
+
+    TaskItem task;
+    if (query.exec() && query.next()) {
+        task = taskFromQuery(query);
+    }
+    query.finish();  // 缓存的语句读完后释放读快照
+
+    return task;
+}
+
+QList<TaskItem> TaskDatabase::getAllTasks() {
+    QList<TaskItem> tasks;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);  // 只向前读，驱动不缓存已读的行
+
+    if (query.exec(QString("SELECT %1 FROM tasks ORDER BY create_time DESC").arg(TASK_COLUMNS))) {
+        while (query.next()) {
+            tasks.append(taskFromQuery(query));
+        }
+    }
+
+    return tasks;
+}
+
+QList<TaskSummary> TaskDatabase::getTaskSummaries() {
+    QList<TaskSummary> tasks;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    if (query.exec(QString("SELECT %1 FROM tasks ORDER BY create_time DESC").arg(SUMMARY_COLUMNS))) {
+        while (query.next()) {
+            tasks.append(summaryFromQuery(query));
+        }
+    }
+
+    return tasks;
+}
+
+QList<TaskSummary> TaskDatabase::getTaskSummaryPage(const TaskPageKey &from, bool inclusive, bool descending, int limit) {
+    // 行值比较与 idx_tasks_list 的两列对应，从分页键处开始扫描索引，与页的位置无关
+    QString condition;
+    if (!from.isNull()) {
+        const char *op = descending ? (inclusive ? "<=" : "<") : (inclusive ? ">=" : ">");
+        condition = QString("WHERE (create_time, task_id) %1 (:create_time, :task_id)").arg(op);
+    }
+    const char *direction = descending ? "DESC" : "ASC";
+    QSqlQuery &query = statement(QString("SELECT %1 FROM tasks %2 ORDER BY create_time %3, task_id %3 LIMIT :limit")
+                                     .arg(SUMMARY_COLUMNS, condition, direction));
+    if (!from.isNull()) {
+        query.bindValue(":create_time", from.createTime);
+        query.bindValue(":task_id", from.taskId);
+    }
+    query.bindValue(":limit", limit);
+
+    QList<TaskSummary> tasks;
+    if (query.exec()) {
+        while (query.next()) {
+            tasks.append(summaryFromQuery(query));
+        }
+    }
+    query.finish();
+
+    return tasks;
+}
+
+int TaskDatabase::countTasks() {
+    QSqlQuery query(db);
+    if (query.exec("SELECT COUNT(*) FROM tasks") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+QList<PendingTask> TaskDatabase::getPendingTasks() {
+    QList<PendingTask> tasks;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // 状态 0 = Pending, 1 = Processing；条件与部分索引 idx_tasks_pending 一致才会用到它
+    if (query.exec(QString("SELECT %1 FROM tasks WHERE status IN (0, 1) ORDER BY create_time DESC").arg(PENDING_COLUMNS))) {
+        while (query.next()) {
+            tasks.append(pendingFromQuery(query));
+        }
+    }
+
+    return tasks;
+}
+
+QList<TaskItem> TaskDatabase::getCompletedTasks(int limit) {
+    QList<TaskItem> tasks;
+    QSqlQuery query(db);
+
+    // 状态 2 = Completed
+    query.prepare(QString("SELECT %1 FROM tasks WHERE status = 2 AND complete_time IS NOT NULL "
+                          "ORDER BY complete_time DESC LIMIT :limit").arg(TASK_COLUMNS));
+    query.bindValue(":limit", limit);
+    if (query.exec()) {
+        while (query.next()) {
+            tasks.append(taskFromQuery(query));
+        }
+    }
+
+    return tasks;
+}
+
+QList<TaskItem> TaskDatabase::getBatchTasks(const QString &batchId) {
+    QList<TaskItem> tasks;
+    QSqlQuery query(db);
+
+    query.prepare(QString("SELECT %1 FROM tasks WHERE batch_id = :batch_id ORDER BY create_time").arg(TASK_COLUMNS));
+    query.bindValue(":batch_id", batchId);
+    if (query.exec()) {
+        while (query.next()) {
+            tasks.append(taskFromQuery(query));
+        }
+    }
+
+    return tasks;
+}
+
+QList<TaskItem> TaskDatabase::getCompletedTasksByRequestHash(const QString &requestHash) {
+    QList<TaskItem> tasks;
+    QSqlQuery query(db);
+
+    // 有本地文件的排在前面，其次是最近完成的（视频 URL 更可能仍然有效）
+    query.prepare(QString(R"(
+        SELECT %1 FROM tasks
+        WHERE request_hash = :request_hash AND status = :status
+        ORDER BY (local_file_path IS NOT NULL AND local_file_path != '') DESC, complete_time DESC
+    )").arg(TASK_COLUMNS));
+    query.bindValue(":request_hash", requestHash);
+    query.bindValue(":status", static_cast<int>(TaskStatus::Completed));
+    if (query.exec()) {
+        while (query.next()) {
+            tasks.append(taskFromQuery(query));
+        }
+    }
+
+    return tasks;
+}
+
+TaskItem TaskDatabase::getTaskByLocalPath(const QString &localPath) {
+    static const QString sql = QString(R"(
+        SELECT %1 FROM tasks WHERE local_file_path = :local_file_path
+        ORDER BY (video_url IS NOT NULL AND video_url != '') DESC, complete_time DESC
+        LIMIT 1
+    )").arg(TASK_COLUMNS);
+    QSqlQuery &query = statement(sql);
+    query.bindValue(":local_file_path", localPath);
+
+    TaskItem task;
+    if (query.exec() && query.next()) {
+        task = taskFromQuery(query);
+    }
+    query.finish();
+
+    return task;
+}
+
+bool TaskDatabase::markVideoPlayed(const QString &localPath) {
+    QSqlQuery &query = statement("UPDATE tasks SET last_played_time = :last_played_time WHERE local_file_path = :local_file_path");
+    query.bindValue(":last_played_time", timeValue(QDateTime::currentDateTime()));
+    query.bindValue(":local_file_path", localPath);
+
+    if (!query.exec()) {
+        emit databaseError("更新播放时间失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+bool TaskDatabase::deleteTask(const QString &taskId) {
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM tasks WHERE task_id = :task_id");
+    query.bindValue(":task_id", taskId);
+
+    if (!query.exec()) {
+        emit databaseError("删除任务失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+bool TaskDatabase::saveDownloadJournal(const DownloadJournalEntry &entry) {
+    QSqlQuery &query = statement(R"(
+        INSERT OR REPLACE INTO download_journal (
+            dest_path, task_id, url, bytes_done, total_bytes, etag, last_modified, update_time
+        ) VALUES (
+            :dest_path, :task_id, :url, :bytes_done, :total_bytes, :etag, :last_modified, :update_time
+        )
+    )");
+
+    query.bindValue(":dest_path", entry.destPath);
+    query.bindValue(":task_id", entry.taskId);
+    query.bindValue(":url", entry.url);
+    query.bindValue(":bytes_done", entry.bytesDone);
+    query.bindValue(":total_bytes", entry.totalBytes);
+    query.bindValue(":etag", entry.etag);
+    query.bindValue(":last_modified", entry.lastModified);
+    query.bindValue(":update_time", timeValue(entry.updateTime));
+
+    if (!query.exec()) {
+        qDebug() << "Save download journal error:" << query.lastError().text();
+        emit databaseError("保存下载日志失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+DownloadJournalEntry TaskDatabase::getDownloadJournal(const QString &destPath) {
+    static const QString sql = QString("SELECT %1 FROM download_journal WHERE dest_path = :dest_path").arg(JOURNAL_COLUMNS);
+    QSqlQuery &query = statement(sql);
+    query.bindValue(":dest_path", destPath);
+
+    DownloadJournalEntry entry;
+    if (query.exec() && query.next()) {
+        entry = journalFromQuery(query);
+    }
+    query.finish();
+
+    return entry;
+}
+
+QList<DownloadJournalEntry> TaskDatabase::getDownloadJournals() {
+    QList<DownloadJournalEntry> entries;
+    QSqlQuery query(db);
+
+    if (query.exec(QString("SELECT %1 FROM download_journal ORDER BY update_time").arg(JOURNAL_COLUMNS))) {
+        while (query.next()) {
+            entries.append(journalFromQuery(query));
+        }
+    }
+
+    return entries;
+}
+
+bool TaskDatabase::deleteDownloadJournal(const QString &destPath) {
+    QSqlQuery &query = statement("DELETE FROM download_journal WHERE dest_path = :dest_path");
+    query.bindValue(":dest_path", destPath);
+
+    if (!query.exec()) {
+        emit databaseError("删除下载日志失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+bool TaskDatabase::addVideoBlob(const QString &hash, const QString &path, qint64 size) {
+    QSqlQuery &query = statement(R"(
+        INSERT INTO video_blobs (hash, path, size, create_time) VALUES (:hash, :path, :size, :create_time)
+        ON CONFLICT(hash) DO UPDATE SET path = excluded.path, size = excluded.size
+    )");
+    query.bindValue(":hash", hash);
+    query.bindValue(":path", path);
+    query.bindValue(":size", size);
+    query.bindValue(":create_time", timeValue(QDateTime::currentDateTime()));
+
+    if (!query.exec()) {
+        emit databaseError("保存视频记录失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+bool TaskDatabase::setTaskVideo(const QString &taskId, const QString &hash, const QString &localPath) {
+    QSqlQuery &query = statement(R"(
+        UPDATE tasks SET video_hash = :video_hash, local_file_path = :local_file_path, update_time = :update_time
+        WHERE task_id = :task_id
+    )");
+    query.bindValue(":task_id", taskId);
+    query.bindValue(":video_hash", hash);
+    query.bindValue(":local_file_path", localPath);
+    query.bindValue(":update_time", timeValue(QDateTime::currentDateTime()));
+
+    if (!query.exec()) {
+        emit databaseError("更新任务视频失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+bool TaskDatabase::deleteVideoBlob(const QString &hash) {
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM video_blobs WHERE hash = :hash");
+    query.bindValue(":hash", hash);
+
+    if (!query.exec()) {
+        emit databaseError("删除视频记录失败: " + query.lastError().text());
+        return false;
+    }
+
+    return true;
+}
+
+qint64 TaskDatabase::videoStoreSize() {
+    QSqlQuery query(db);
+    if (query.exec("SELECT COALESCE(SUM(size), 0) FROM video_blobs") && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+QList<VideoBlob> TaskDatabase::getVideoBlobs() {
+    QList<VideoBlob> blobs;
+    QSqlQuery query(db);
+    if (query.exec(QString("SELECT %1 FROM video_blobs ORDER BY hash").arg(BLOB_COLUMNS))) {
+        while (query.next()) {
+            blobs.append(blobFromQuery(query));
+        }
+    }
+
+    return blobs;
+}
+
+bool TaskDatabase::hasVideoBlob(const QString &hash) {
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM video_blobs WHERE hash = :hash");
+    query.bindValue(":hash", hash);
+    return query.exec() && query.next();
+}
+
+QList<VideoBlob> TaskDatabase::getEvictionCandidates(int limit) {
+    QList<VideoBlob> blobs;
+    QSqlQuery query(db);
+
+    // 没有引用任务的视频无法重新下载，不参与淘汰
+    // 列顺序与 BLOB_COLUMNS 一致，last_used 为第 BlobLastUsed 列
+    query.prepare(R"(
+        SELECT b.hash, b.path, b.size,
+               MAX(COALESCE(t.last_played_time, t.complete_time, b.create_time)) AS last_used
+        FROM video_blobs b JOIN tasks t ON t.video_hash = b.hash
+        GROUP BY b.hash
+        HAVING SUM(t.video_url IS NOT NULL AND t.video_url != '') > 0
+        ORDER BY last_used
+        LIMIT :limit
+    )");
+    query.bindValue(":limit", limit);
+    if (query.exec()) {
+        while (query.next()) {
+            VideoBlob blob = blobFromQuery(query);
+            blob.lastUsed = timeFromValue(query.value(BlobLastUsed));
+            blobs.append(blob);
+        }
+    }
+
+    return blobs;
+}
+
+bool TaskDatabase::releaseVideo(const QString &path, const QString &prompt) {
+    bool release = false;
+    bool committed = transaction([&]() {
+        // 最多读两个引用任务：两个以上，或唯一的一个不是该记录自己的任务时，文件仍在使用
+        QSqlQuery query(db);
+        query.prepare(R"(
+            SELECT prompt FROM tasks
+            WHERE local_file_path = :local_file_path
+               OR video_hash IN (SELECT hash FROM video_blobs WHERE path = :blob_path)
+            LIMIT 2
+        )");
+        query.bindValue(":local_file_path", path);
+        query.bindValue(":blob_path", path);
+        if (!query.exec()) {
+            emit databaseError("查询视频引用失败: " + query.lastError().text());
+            return false;
+        }
+        QStringList owners;
+        while (query.next()) {
+            owners.append(query.value(0).toString());
+        }
+        owners.removeOne(prompt);
+        if (!owners.isEmpty()) {
+            return true;
+        }
+
+        query.prepare("DELETE FROM video_blobs WHERE path = :path");
+        query.bindValue(":path", path);
+        if (!query.exec()) {
+            emit databaseError("删除视频记录失败: " + query.lastError().text());
+            return false;
+        }
+        release = true;
+        return true;
+    });
+    return committed && release;
+}
+
+DownloadJournalEntry TaskDatabase::journalFromQuery(const QSqlQuery &query) {
+    DownloadJournalEntry entry;
+    entry.destPath = query.value(JournalDestPath).toString();
+    entry.taskId = query.value(JournalTaskId).toString();
+    entry.url = query.value(JournalUrl).toString();
+    entry.bytesDone = query.value(JournalBytesDone).toLongLong();
+    entry.totalBytes = query.value(JournalTotalBytes).toLongLong();
+    entry.etag = query.value(JournalEtag).toString();
+    entry.lastModified = query.value(JournalLastModified).toString();
+    entry.updateTime = timeFromValue(query.value(JournalUpdateTime));
+
+    return entry;
+}
+
+VideoBlob TaskDatabase::blobFromQuery(const QSqlQuery &query) {
+    VideoBlob blob;
+    blob.hash = query.value(BlobHash).toString();
+    blob.path = query.value(BlobPath).toString();
+    blob.size = query.value(BlobSize).toLongLong();
+
+    return blob;
+}
+
+TaskItem TaskDatabase::taskFromQuery(const QSqlQuery &query) {
+    TaskItem task;
+    task.taskId = query.value(TaskId).toString();
+    task.prompt = query.value(Prompt).toString();
+    task.apiKey = query.value(ApiKey).toString();
+    task.width = query.value(Width).toInt();
+    task.height = query.value(Height).toInt();
+    task.resolution = query.value(Resolution).toString();
+    task.aspectRatio = query.value(AspectRatio).toString();
+    task.duration = query.value(Duration).toInt();
+    task.cameraFixed = query.value(CameraFixed).toInt() == 1;
+    task.seed = query.value(Seed).toInt();
+    task.status = static_cast<TaskStatus>(query.value(Status).toInt());
+    task.errorMessage = query.value(ErrorMessage).toString();
+    task.videoUrl = query.value(VideoUrl).toString();
+    task.localFilePath = query.value(LocalFilePath).toString();
+    task.createTime = timeFromValue(query.value(CreateTime));
+    task.updateTime = timeFromValue(query.value(UpdateTime));
+    task.completeTime = timeFromValue(query.value(CompleteTime));
+    task.lastPlayedTime = timeFromValue(query.value(LastPlayedTime));
+    task.submitAttempts = query.value(SubmitAttempts).toInt();
+    task.submitLatencyMs = query.value(SubmitLatencyMs).toLongLong();
+    task.batchId = query.value(BatchId).toString();
+    task.requestHash = query.value(RequestHash).toString();
+    task.videoHash = query.value(VideoHash).toString();
+    task.videoUrlExpires = timeFromValue(query.value(VideoUrlExpires));
+    if (!task.videoUrlExpires.isValid() && !task.videoUrl.isEmpty()) {
+        task.videoUrlExpires = SignedUrl::expiry(task.videoUrl);  // 新增该列之前保存的任务
+    }
+
+    return task;
+}
+
+TaskSummary TaskDatabase::summaryFromQuery(const QSqlQuery &query) {
+    TaskSummary summary;
+    summary.taskId = query.value(SummaryTaskId).toString();
+    summary.prompt = query.value(SummaryPrompt).toString();
+    summary.status = static_cast<TaskStatus>(query.value(SummaryStatus).toInt());
+    summary.videoUrl = query.value(SummaryVideoUrl).toString();
+    summary.localFilePath = query.value(SummaryLocalFilePath).toString();
+    summary.createTime = timeFromValue(query.value(SummaryCreateTime));
+    summary.completeTime = timeFromValue(query.value(SummaryCompleteTime));
+
+    return summary;
+}
+
+PendingTask TaskDatabase::pendingFromQuery(const QSqlQuery &query) {
+    PendingTask task;
+    task.taskId = query.value(PendingTaskId).toString();
+    task.apiKey = query.value(PendingApiKey).toString();
+    task.status = static_cast<TaskStatus>(query.value(PendingStatus).toInt());
+
+    return task;
+}
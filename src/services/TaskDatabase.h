@@ -0,0 +1,116 @@
+#ifndef TASKDATABASE_H
+#define TASKDATABASE_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QList>
+#include <QStringList>
+#include "models/TaskItem.h"
+#include "models/TaskSummary.h"
+#include "models/PendingTask.h"
+#include "models/DownloadJournalEntry.h"
+#include "models/VideoBlob.h"
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+class QSqlQuery;
+
+// tasks.db 的 SQL 访问，只在数据库线程中使用（见 TaskDatabaseService）
+class TaskDatabase : public QObject {
+    Q_OBJECT
+
+public:
+    enum class StorageProfile {
+        Default,  // SQLite 默认设置：回滚日志，每次提交都 fsync，每次调用重新 prepare
+        Tuned     // WAL + synchronous=NORMAL、加大页缓存和 mmap，常用语句只 prepare 一次
+    };
+
+    // 表结构版本，保存在 PRAGMA user_version 中，open() 时按顺序执行尚未执行的迁移
+    static constexpr int SCHEMA_VERSION = 3;
+    static constexpr int CACHE_SIZE_KB = 16 * 1024;
+    static constexpr qint64 MMAP_SIZE = 256LL * 1024 * 1024;
+
+    explicit TaskDatabase(QObject *parent = nullptr);
+    ~TaskDatabase();
+
+    // 打开数据库，创建表或迁移到 SCHEMA_VERSION；数据库版本高于程序时拒绝打开
+    bool open(const QString &dbPath, const QString &connectionName, StorageProfile profile = StorageProfile::Tuned);
+    void close();
+
+    // 任务操作
+    bool saveTask(const TaskItem &task);
+    bool updateTask(const TaskItem &task);
+    TaskItem getTask(const QString &taskId);  // 返回 TaskItem 的查询都读取全部列（详情投影）
+    QList<TaskItem> getAllTasks();
+    QList<TaskSummary> getTaskSummaries();  // 列表投影，按创建时间倒序
+    // 列表的一页：按 (create_time, task_id) 排序，从 from 之后（inclusive 时含 from）读取至多 limit 行；
+    // from 为空时从头开始
+    QList<TaskSummary> getTaskSummaryPage(const TaskPageKey &from, bool inclusive, bool descending, int limit);
+    int countTasks();
+    QList<PendingTask> getPendingTasks();  // 未完成的任务（轮询投影）
+    QList<TaskItem> getCompletedTasks(int limit);  // 最近完成且有完成时间的任务（用于完成时间统计）
+    QList<TaskItem> getBatchTasks(const QString &batchId);  // 同一次参数扫描的任务，按创建时间排序
+    QList<TaskItem> getCompletedTasksByRequestHash(const QString &requestHash);  // 相同请求的已完成任务，有本地文件的优先
+    TaskItem getTaskByLocalPath(const QString &localPath);  // 有视频 URL 的优先
+    bool markVideoPlayed(const QString &localPath);  // 记录引用该文件的任务的播放时间
+    bool deleteTask(const QString &taskId);
+
+    // 批量写入：在一个事务中执行 work，work 返回 false 或提交失败时回滚。
+    // WAL 下每个事务提交一次，一轮查询结果的多次更新合并后只写一次日志
+    bool transaction(const std::function<bool()> &work);
+    bool updateTasks(const QList<TaskItem> &tasks);
+
+    // 断点续传日志
+    bool saveDownloadJournal(const DownloadJournalEntry &entry);
+    DownloadJournalEntry getDownloadJournal(const QString &destPath);
+    QList<DownloadJournalEntry> getDownloadJournals();
+    bool deleteDownloadJournal(const QString &destPath);
+
+    // 内容寻址的视频存储
+    bool addVideoBlob(const QString &hash, const QString &path, qint64 size);  // 已存在时更新路径和大小
+    bool setTaskVideo(const QString &taskId, const QString &hash, const QString &localPath);
+    bool deleteVideoBlob(const QString &hash);
+    qint64 videoStoreSize();  // 存储中视频的总大小
+    QList<VideoBlob> getVideoBlobs();  // 存储中的全部视频（lastUsed 不填），按哈希排序
+    bool hasVideoBlob(const QString &hash);
+    // 最久未使用、且至少一个引用任务仍有视频 URL（可重新下载）的视频
+    QList<VideoBlob> getEvictionCandidates(int limit);
+    // 画廊删除一条记录后释放它的视频文件。除该记录自己的任务（提示词为 prompt）外还有任务
+    // 引用该文件或其内容时返回 false；否则删除文件的 video_blobs 记录（如有）并返回 true，
+    // 由调用方删除文件
+    bool releaseVideo(const QString &path, const QString &prompt);
+
+signals:
+    void databaseError(const QString &error);
+
+private:
+    QSqlDatabase db;
+    StorageProfile profile = StorageProfile::Tuned;
+    // Tuned 下按 SQL 文本缓存已 prepare 的语句；Default 下每次重新 prepare
+    std::unordered_map<QString, std::unique_ptr<QSqlQuery>> statements;
+    std::unique_ptr<QSqlQuery> scratch;
+
+    QSqlQuery &statement(const QString &sql);
+    bool applyProfile();
+    bool migrate();
+    int schemaVersion();  // 失败时返回 -1
+    bool createBaseline();  // 版本 0：引入版本号之前的表结构，补齐旧数据库缺少的列
+    bool migrateToEpochMs();  // 版本 1
+    bool migrateListKeyset();  // 版本 2
+    bool migrateListIndexKeyOnly();  // 版本 3
+    bool rebuildTable(const QString &table, const QString &createSQL, const QStringList &timeColumns);
+    bool addColumnIfMissing(const QString &table, const QString &column, const QString &definition);
+    // 按列序号解码，列清单见 TaskDatabase.cpp 中的 TASK_COLUMNS 等
+    static TaskItem taskFromQuery(const QSqlQuery &query);
+    static TaskSummary summaryFromQuery(const QSqlQuery &query);
+    static PendingTask pendingFromQuery(const QSqlQuery &query);
+    static DownloadJournalEntry journalFromQuery(const QSqlQuery &query);
+    static VideoBlob blobFromQuery(const QSqlQuery &query);  // lastUsed 不填
+    // 时间列保存毫秒时间戳，无效时间为 NULL
+    static QVariant timeValue(const QDateTime &time);
+    static QDateTime timeFromValue(const QVariant &value);
+    static QVariant urlExpiryValue(const QString &videoUrl);  // video_url_expires 列的值
+};
+
+#endif // TASKDATABASE_H
@@ -2,10 +2,23 @@
 #define TASKDATABASESERVICE_H
 
 #include <QObject>
-#include <QSqlDatabase>
+#include <QFuture>
+#include <QPromise>
+#include <QThread>
 #include <QList>
-#include "models/TaskItem.h"
+#include "TaskDatabase.h"
+#include <memory>
+#include <type_traits>
 
+// tasks.db 的访问入口。SQLite 在专用的数据库线程中以独立的连接执行，界面线程不做磁盘 I/O。
+//
+// 除 initialize() 外只提供异步接口（xxxAsync / run）：立即返回 QFuture，结果用
+// future.then(context, ...) 在 context 所在线程中处理，context 销毁后不再回调。
+// 基准程序直接使用 TaskDatabase。
+//
+// 所有请求按提交顺序在同一线程中执行：先提交的写入对后提交的读取总是可见。
+// 读-改-写应通过 run() 在数据库线程中一次完成，避免两次往返之间被其他写入插入；
+// 多条相关的写入用 TaskDatabase::transaction 合并为一个事务。
 class TaskDatabaseService : public QObject {
     Q_OBJECT
 
@@ -13,26 +26,54 @@ public:
     explicit TaskDatabaseService(QObject *parent = nullptr);
     ~TaskDatabaseService();
 
-    // 初始化数据库
+    // 初始化数据库（同步）
     bool initialize();
 
-    // 任务操作
-    bool saveTask(const TaskItem &task);
-    bool updateTask(const TaskItem &task);
-    TaskItem getTask(const QString &taskId);
-    QList<TaskItem> getAllTasks();
-    QList<TaskItem> getPendingTasks();  // 获取未完成的任务
-    bool deleteTask(const QString &taskId);
+    // 在数据库线程中执行 work(TaskDatabase &)，返回其结果
+    template <typename F>
+    auto run(F work) -> QFuture<std::invoke_result_t<F, TaskDatabase &>>;
+
+    // 任务操作（异步）
+    QFuture<bool> saveTaskAsync(const TaskItem &task);
+    QFuture<bool> updateTaskAsync(const TaskItem &task);
+    QFuture<bool> updateTasksAsync(const QList<TaskItem> &tasks);  // 一个事务
+    QFuture<TaskItem> getTaskAsync(const QString &taskId);
+    QFuture<QList<TaskItem>> getAllTasksAsync();
+    QFuture<QList<TaskSummary>> getTaskSummariesAsync();
+    QFuture<QList<TaskSummary>> getTaskSummaryPageAsync(const TaskPageKey &from, bool inclusive, bool descending, int limit);
+    QFuture<int> countTasksAsync();
+    QFuture<QList<PendingTask>> getPendingTasksAsync();
+    QFuture<QList<TaskItem>> getBatchTasksAsync(const QString &batchId);
+    QFuture<bool> markVideoPlayedAsync(const QString &localPath);
+    QFuture<bool> deleteTaskAsync(const QString &taskId);
+    QFuture<bool> saveDownloadJournalAsync(const DownloadJournalEntry &entry);
+    QFuture<DownloadJournalEntry> getDownloadJournalAsync(const QString &destPath);
+    QFuture<bool> deleteDownloadJournalAsync(const QString &destPath);
 
 signals:
     void databaseError(const QString &error);
 
 private:
-    QSqlDatabase db;
-
-    bool createTables();
-    TaskItem taskFromQuery(class QSqlQuery &query);
+    QThread *thread;
+    TaskDatabase *database;  // 属于数据库线程
 };
 
-#endif // TASKDATABASESERVICE_H
+template <typename F>
+auto TaskDatabaseService::run(F work) -> QFuture<std::invoke_result_t<F, TaskDatabase &>> {
+    using Result = std::invoke_result_t<F, TaskDatabase &>;
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+    TaskDatabase *target = database;
+    QMetaObject::invokeMethod(database, [promise, target, work = std::move(work)]() mutable {
+        if constexpr (std::is_void_v<Result>) {
+            work(*target);
+        } else {
+            promise->addResult(work(*target));
+        }
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+}
 
+#endif // TASKDATABASESERVICE_H
@@ -0,0 +1,171 @@
+#include "TimingWheel.h"
+
+TimingWheel::TimingWheel(int tickMs, QObject *parent)
+    : QObject(parent), tickMs(qMax(1, tickMs)), currentTick(0), nextId(0), lastDue(0), maxDue(0), fired(0) {
+    tickTimer = new QTimer(this);
+    tickTimer->setInterval(this->tickMs);
+    tickTimer->setTimerType(Qt::CoarseTimer);
+    connect(tickTimer, &QTimer::timeout, this, &TimingWheel::onTick);
+    clock.start();
+}
+
+TimingWheel::~TimingWheel() {
+    qDeleteAll(entries);
+}
+
+TimingWheel::TimerId TimingWheel::schedule(qint64 delayMs, Callback callback) {
+    if (entries.isEmpty()) {
+        // 空闲期间定时器已停止，直接对齐到当前时间
+        currentTick = nowTick();
+    }
+
+    qint64 ticks = qMax<qint64>(1, (delayMs + tickMs - 1) / tickMs);
+    auto *entry = new Entry;
+    entry->id = ++nextId;
+    entry->expiry = nowTick() + ticks;
+    entry->callback = std::move(callback);
+    place(entry);
+    entries.insert(entry->id, entry);
+
+    if (!tickTimer->isActive()) {
+        tickTimer->start();
+    }
+    return entry->id;
+}
+
+bool TimingWheel::cancel(TimerId id) {
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return false;
+    }
+    Entry *entry = it.value();
+    entries.erase(it);
+    unlink(entry);
+    delete entry;
+
+    if (entries.isEmpty()) {
+        tickTimer->stop();
+    }
+    return true;
+}
+
+bool TimingWheel::isScheduled(TimerId id) const {
+    return entries.contains(id);
+}
+
+int TimingWheel::tickInterval() const {
+    return tickMs;
+}
+
+int TimingWheel::pendingCount() const {
+    return entries.size();
+}
+
+int TimingWheel::lastDueCount() const {
+    return lastDue;
+}
+
+int TimingWheel::maxDueCount() const {
+    return maxDue;
+}
+
+quint64 TimingWheel::firedCount() const {
+    return fired;
+}
+
+qint64 TimingWheel::nowTick() const {
+    return clock.elapsed() / tickMs;
+}
+
+void TimingWheel::place(Entry *entry) {
+    qint64 expiry = entry->expiry;
+    qint64 delta = expiry - currentTick;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (qint64(1) << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    qint64 span = qint64(1) << (SLOT_BITS * LEVELS);
+    if (delta >= span) {
+        // 超出时间轮范围：先放在最远的槽，下放时重新计算
+        expiry = currentTick + span - 1;
+    }
+
+    int index = static_cast<int>((expiry >> (SLOT_BITS * level)) & (SLOTS - 1));
+    Entry **head = &slots[level][index];
+    entry->head = head;
+    entry->prev = nullptr;
+    entry->next = *head;
+    if (*head) {
+        (*head)->prev = entry;
+    }
+    *head = entry;
+}
+
+void TimingWheel::unlink(Entry *entry) {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        *entry->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    }
+    entry->prev = nullptr;
+    entry->next = nullptr;
+    entry->head = nullptr;
+}
+
+void TimingWheel::cascade(int level) {
+    // 把上层当前槽中的项按剩余时间重新放到下层
+    int index = static_cast<int>((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    Entry *entry = slots[level][index];
+    slots[level][index] = nullptr;
+    while (entry) {
+        Entry *next = entry->next;
+        place(entry);
+        entry = next;
+    }
+}
+
+void TimingWheel::advance() {
+    currentTick++;
+
+    for (int level = 1; level < LEVELS; ++level) {
+        if ((currentTick & ((qint64(1) << (SLOT_BITS * level)) - 1)) != 0) {
+            break;
+        }
+        cascade(level);
+    }
+
+    // 第 0 层当前槽中的项都在本 tick 到期；回调中可以安全地插入或取消其他项
+    Entry **head = &slots[0][currentTick & (SLOTS - 1)];
+    int due = 0;
+    while (*head) {
+        Entry *entry = *head;
+        unlink(entry);
+        entries.remove(entry->id);
+        Callback callback = std::move(entry->callback);
+        delete entry;
+        due++;
+        fired++;
+        callback();
+    }
+
+    lastDue = due;
+    maxDue = qMax(maxDue, due);
+    if (due > 0) {
+        emit ticked(due);
+    }
+}
+
+void TimingWheel::onTick() {
+    // 事件循环繁忙导致 tick 延迟时补齐错过的 tick
+    qint64 target = nowTick();
+    while (currentTick < target && !entries.isEmpty()) {
+        advance();
+    }
+    if (entries.isEmpty()) {
+        tickTimer->stop();
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include "const/QtHeaders.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <functional>
+
+// 分层时间轮：大量任务的截止时间共用一个粗粒度的 tick 定时器驱动。
+// 4 层 × 64 槽，tick 为 100ms 时可覆盖约 19 天；插入和取消均为 O(1)，
+// 每个 tick 只处理当前槽（以及每 64 个 tick 一次的上层槽下放）。
+class TimingWheel : public QObject {
+    Q_OBJECT
+public:
+    using TimerId = quint64;  // 0 表示无效
+    using Callback = std::function<void()>;
+
+    explicit TimingWheel(int tickMs = 100, QObject *parent = nullptr);
+    ~TimingWheel();
+
+    // delayMs 后调用 callback（向上取整到 tick，至少一个 tick）
+    TimerId schedule(qint64 delayMs, Callback callback);
+    bool cancel(TimerId id);
+    bool isScheduled(TimerId id) const;
+
+    int tickInterval() const;
+    int pendingCount() const;
+    int lastDueCount() const;      // 最近一个 tick 到期的数量
+    int maxDueCount() const;       // 单个 tick 到期数量的峰值
+    quint64 firedCount() const;
+
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+signals:
+    void ticked(int due);  // 每个有到期项的 tick 发出一次
+
+private slots:
+    void onTick();
+
+private:
+    struct Entry {
+        TimerId id = 0;
+        qint64 expiry = 0;  // 绝对 tick
+        Callback callback;
+        Entry *prev = nullptr;
+        Entry *next = nullptr;
+        Entry **head = nullptr;  // 所在槽的链表头，用于 O(1) 摘除
+    };
+
+    void place(Entry *entry);
+    void unlink(Entry *entry);
+    void cascade(int level);
+    void advance();  // 前进一个 tick 并触发到期项
+    qint64 nowTick() const;
+
+    Entry *slots[LEVELS][SLOTS] = {};
+    QHash<TimerId, Entry *> entries;
+    QTimer *tickTimer;
+    QElapsedTimer clock;
+    int tickMs;
+    qint64 currentTick;
+    TimerId nextId;
+    int lastDue;
+    int maxDue;
+    quint64 fired;
+};
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,367 @@
+#include "TrafficRecorder.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkReply>
+#include <QRegularExpression>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+// 按录制数据模拟的响应：首字节时间到达后发出响应头，内容在剩余时间内分块送达
+class ReplayReply : public QNetworkReply {
+public:
+    ReplayReply(const RecordedExchange &exchange, QNetworkAccessManager::Operation operation,
+                const QNetworkRequest &request, double speed, QObject *parent)
+        : QNetworkReply(parent), exchange(exchange), offset(0), delivered(0), aborted(false) {
+        setOperation(operation);
+        setRequest(request);
+        setUrl(request.url());
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+        firstByteMs = static_cast<int>(exchange.firstByteMs / speed);
+        remainingMs = static_cast<int>(qMax<qint64>(0, exchange.durationMs - exchange.firstByteMs) / speed);
+
+        timer = new QTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, &QTimer::timeout, this, [this]() { deliverHeaders(); });
+        timer->start(firstByteMs);
+    }
+
+    void abort() override {
+        if (isFinished() || aborted) {
+            return;
+        }
+        aborted = true;
+        timer->stop();
+        setError(OperationCanceledError, "Operation canceled");
+        emit errorOccurred(OperationCanceledError);
+        setFinished(true);
+        emit finished();
+    }
+
+    qint64 bytesAvailable() const override {
+        return buffer.size() - offset + QNetworkReply::bytesAvailable();
+    }
+
+    bool isSequential() const override {
+        return true;
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override {
+        qint64 n = qMin<qint64>(maxSize, buffer.size() - offset);
+        if (n <= 0) {
+            return isFinished() ? -1 : 0;
+        }
+        std::memcpy(data, buffer.constData() + offset, n);
+        offset += n;
+        if (offset == buffer.size()) {
+            buffer.clear();
+            offset = 0;
+        }
+        return n;
+    }
+
+private:
+    void deliverHeaders() {
+        if (exchange.status > 0) {
+            setAttribute(QNetworkRequest::HttpStatusCodeAttribute, exchange.status);
+            for (const auto &header : exchange.headers) {
+                setRawHeader(header.first, header.second);
+            }
+            emit metaDataChanged();
+        }
+
+        // 内容按 CHUNK_SIZE 分块，在剩余时间内均匀送达，模拟原始的传输速率
+        int chunks = static_cast<int>(qMax<qint64>(1, (exchange.bodySize + CHUNK_SIZE - 1) / CHUNK_SIZE));
+        int interval = remainingMs / chunks;
+        disconnect(timer, nullptr, this, nullptr);
+        connect(timer, &QTimer::timeout, this, [this, interval]() { deliverChunk(interval); });
+        timer->start(0);
+    }
+
+    void deliverChunk(int interval) {
+        qint64 size = qMin<qint64>(CHUNK_SIZE, exchange.bodySize - delivered);
+        if (size > 0) {
+            // 录制时只保存了开头部分，其余以零填充
+            QByteArray chunk = exchange.body.mid(delivered, size);
+            chunk.append(QByteArray(size - chunk.size(), '\0'));
+            buffer.append(chunk);
+            delivered += size;
+            emit downloadProgress(delivered, exchange.bodySize);
+            emit readyRead();
+        }
+        if (delivered < exchange.bodySize) {
+            timer->start(interval);
+            return;
+        }
+
+        if (exchange.error != NoError) {
+            setError(static_cast<NetworkError>(exchange.error), exchange.errorString);
+            emit errorOccurred(static_cast<NetworkError>(exchange.error));
+        }
+        setFinished(true);
+        emit finished();
+    }
+
+    static const qint64 CHUNK_SIZE = 64 * 1024;
+
+    RecordedExchange exchange;
+    QTimer *timer;
+    QByteArray buffer;
+    qint64 offset;
+    qint64 delivered;
+    int firstByteMs;
+    int remainingMs;
+    bool aborted;
+};
+
+QString matchKey(const QByteArray &method, const QString &pathAndQuery, const QByteArray &range) {
+    return QString::fromLatin1(method) + " " + pathAndQuery + (range.isEmpty() ? QString() : " " + QString::fromLatin1(range));
+}
+
+QByteArray methodName(QNetworkAccessManager::Operation operation) {
+    switch (operation) {
+        case QNetworkAccessManager::GetOperation: return "GET";
+        case QNetworkAccessManager::PostOperation: return "POST";
+        case QNetworkAccessManager::PutOperation: return "PUT";
+        case QNetworkAccessManager::DeleteOperation: return "DELETE";
+        case QNetworkAccessManager::HeadOperation: return "HEAD";
+        default: return "CUSTOM";
+    }
+}
+
+} // namespace
+
+TrafficRecorder::TrafficRecorder(QObject *parent)
+    : QObject(parent), currentMode(Mode::Off), replaySpeed(1.0) {
+}
+
+TrafficRecorder::~TrafficRecorder() {
+    if (file.isOpen()) {
+        file.close();
+    }
+}
+
+TrafficRecorder::Mode TrafficRecorder::mode() const {
+    return currentMode;
+}
+
+QString TrafficRecorder::pathAndQuery(const QUrl &url) {
+    return url.path() + (url.hasQuery() ? "?" + url.query(QUrl::FullyEncoded) : QString());
+}
+
+bool TrafficRecorder::startRecording(const QString &path) {
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open traffic recording" << path << ":" << file.errorString();
+        return false;
+    }
+    QJsonObject header{{"format", "isee-traffic"}, {"version", 1},
+                       {"recorded", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)}};
+    write(header);
+    clock.start();
+    currentMode = Mode::Record;
+    qDebug() << "Recording API traffic to" << path;
+    return true;
+}
+
+bool TrafficRecorder::loadReplay(const QString &path, double speed) {
+    QFile input(path);
+    if (!input.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open traffic recording" << path << ":" << input.errorString();
+        return false;
+    }
+
+    exchanges.clear();
+    nextPost.clear();
+    int count = 0;
+    while (!input.atEnd()) {
+        QJsonObject obj = QJsonDocument::fromJson(input.readLine()).object();
+        if (obj.isEmpty() || obj.contains("format")) {
+            continue;
+        }
+
+        RecordedExchange exchange;
+        exchange.startedMs = obj["t"].toInteger();
+        exchange.method = obj["method"].toString().toLatin1();
+        exchange.pathAndQuery = pathAndQuery(QUrl(obj["url"].toString()));
+        exchange.range = obj["range"].toString().toLatin1();
+        exchange.status = obj["status"].toInt();
+        exchange.error = obj["error"].toInt();
+        exchange.errorString = obj["errorString"].toString();
+        QJsonObject headers = obj["headers"].toObject();
+        for (auto it = headers.begin(); it != headers.end(); ++it) {
+            exchange.headers.append({it.key().toLatin1(), it.value().toString().toLatin1()});
+        }
+        exchange.firstByteMs = obj["firstByteMs"].toInteger();
+        exchange.durationMs = obj["durationMs"].toInteger();
+        exchange.body = obj.contains("bodyBase64") ? QByteArray::fromBase64(obj["bodyBase64"].toString().toLatin1())
+                                                   : obj["body"].toString().toUtf8();
+        exchange.bodySize = obj.contains("bodySize") ? obj["bodySize"].toInteger() : exchange.body.size();
+
+        exchanges[matchKey(exchange.method, exchange.pathAndQuery, exchange.range)].append(exchange);
+        count++;
+    }
+
+    replaySpeed = qMax(0.01, speed);
+    clock.start();
+    currentMode = Mode::Replay;
+    qDebug() << "Replaying" << count << "recorded exchanges from" << path << "at speed" << replaySpeed;
+    return true;
+}
+
+void TrafficRecorder::record(QNetworkReply *reply, const QByteArray &requestBody, bool binaryBody) {
+    if (currentMode != Mode::Record) {
+        return;
+    }
+
+    QElapsedTimer sent;
+    sent.start();
+    auto entry = std::make_shared<QJsonObject>();
+    (*entry)["t"] = clock.elapsed();
+    (*entry)["method"] = QString::fromLatin1(methodName(reply->operation()));
+    (*entry)["url"] = reply->url().toString();
+    QByteArray range = reply->request().rawHeader("Range");
+    if (!range.isEmpty()) {
+        (*entry)["range"] = QString::fromLatin1(range);
+    }
+    if (!requestBody.isEmpty()) {
+        (*entry)["requestBody"] = QString::fromUtf8(redactBody(requestBody));
+    }
+
+    connect(reply, &QNetworkReply::metaDataChanged, this, [entry, sent]() {
+        if (!entry->contains("firstByteMs")) {
+            (*entry)["firstByteMs"] = sent.elapsed();
+        }
+    });
+    if (binaryBody) {
+        // 视频内容只保存开头部分；调用方随后才读取，此时数据仍在缓冲区中
+        connect(reply, &QNetworkReply::readyRead, this, [entry, reply]() {
+            if (!entry->contains("bodyBase64")) {
+                (*entry)["bodyBase64"] = QString::fromLatin1(reply->peek(MAX_BODY_HEAD).toBase64());
+            }
+        });
+        connect(reply, &QNetworkReply::downloadProgress, this, [entry](qint64 received, qint64) {
+            (*entry)["bodySize"] = received;
+        });
+    }
+    connect(reply, &QNetworkReply::finished, this, [this, entry, reply, sent, binaryBody]() {
+        (*entry)["durationMs"] = sent.elapsed();
+        if (!entry->contains("firstByteMs")) {
+            (*entry)["firstByteMs"] = sent.elapsed();
+        }
+        (*entry)["status"] = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (reply->error() != QNetworkReply::NoError) {
+            (*entry)["error"] = static_cast<int>(reply->error());
+            (*entry)["errorString"] = reply->errorString();
+        }
+        QJsonObject headers;
+        for (const auto &header : reply->rawHeaderPairs()) {
+            headers[QString::fromLatin1(header.first)] = QString::fromLatin1(header.second);
+        }
+        (*entry)["headers"] = headers;
+        if (!binaryBody) {
+            // 在调用方的 finished 处理之前执行，内容尚未被读取
+            (*entry)["body"] = QString::fromUtf8(reply->peek(reply->bytesAvailable()));
+        }
+        write(*entry);
+    });
+}
+
+QNetworkReply *TrafficRecorder::replay(QNetworkAccessManager::Operation operation, const QNetworkRequest &request,
+                                       QObject *parent) {
+    QByteArray method = methodName(operation);
+    const RecordedExchange *exchange = match(method, pathAndQuery(request.url()), request.rawHeader("Range"));
+    if (exchange) {
+        return new ReplayReply(*exchange, operation, request, replaySpeed, parent);
+    }
+
+    qDebug() << "No recorded response for" << method << request.url().toString();
+    RecordedExchange missing;
+    missing.error = QNetworkReply::ContentNotFoundError;
+    missing.errorString = "回放文件中没有该请求的录制响应";
+    return new ReplayReply(missing, operation, request, replaySpeed, parent);
+}
+
+const RecordedExchange *TrafficRecorder::match(const QByteArray &method, const QString &pathAndQuery, const QByteArray &range) {
+    QString key = matchKey(method, pathAndQuery, range);
+    auto it = exchanges.constFind(key);
+    if (it == exchanges.constEnd() && !range.isEmpty()) {
+        // 分段数与录制时不同，退回到不带 Range 的录制
+        key = matchKey(method, pathAndQuery, QByteArray());
+        it = exchanges.constFind(key);
+    }
+    if (it == exchanges.constEnd() || it->isEmpty()) {
+        return nullptr;
+    }
+    const QList<RecordedExchange> &candidates = *it;
+
+    if (method == "POST") {
+        // 每次提交对应录制中的下一次提交，用完后重复最后一条
+        int index = qMin<int>(nextPost.value(key, 0), candidates.size() - 1);
+        nextPost[key] = index + 1;
+        return &candidates[index];
+    }
+
+    // 查询和下载：取录制时间不晚于当前回放时间的最后一条
+    qint64 now = static_cast<qint64>(clock.elapsed() * replaySpeed);
+    const RecordedExchange *chosen = &candidates.first();
+    for (const RecordedExchange &candidate : candidates) {
+        if (candidate.startedMs > now) {
+            break;
+        }
+        chosen = &candidate;
+    }
+    return chosen;
+}
+
+void TrafficRecorder::write(const QJsonObject &entry) {
+    file.write(QJsonDocument(entry).toJson(QJsonDocument::Compact));
+    file.write("\n");
+    file.flush();
+}
+
+QJsonValue TrafficRecorder::redactValue(const QString &key, const QJsonValue &value) {
+    if (value.isObject()) {
+        QJsonObject obj = value.toObject();
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            it.value() = redactValue(it.key(), it.value());
+        }
+        return obj;
+    }
+    if (value.isArray()) {
+        QJsonArray array = value.toArray();
+        for (auto it = array.begin(); it != array.end(); ++it) {
+            *it = redactValue(key, *it);
+        }
+        return array;
+    }
+    if (!value.isString()) {
+        return value;
+    }
+
+    QString text = value.toString();
+    QString lowerKey = key.toLower();
+    if (lowerKey.contains("key") || lowerKey.contains("token") || lowerKey == "authorization") {
+        return QString("<redacted>");
+    }
+    static const QRegularExpression base64(R"(^(data:[^,]*,)?[A-Za-z0-9+/=\r\n]+$)");
+    if (text.size() >= REDACT_MIN_LENGTH && base64.match(text).hasMatch()) {
+        return QString("<redacted base64, %1 chars>").arg(text.size());
+    }
+    return value;
+}
+
+QByteArray TrafficRecorder::redactBody(const QByteArray &body) {
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        return QString("<%1 bytes, not JSON>").arg(body.size()).toUtf8();
+    }
+    if (doc.isObject()) {
+        return QJsonDocument(redactValue(QString(), doc.object()).toObject()).toJson(QJsonDocument::Compact);
+    }
+    return QJsonDocument(redactValue(QString(), doc.array()).toArray()).toJson(QJsonDocument::Compact);
+}
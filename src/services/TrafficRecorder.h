@@ -0,0 +1,75 @@
+#ifndef TRAFFICRECORDER_H
+#define TRAFFICRECORDER_H
+
+#include "const/QtHeaders.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+
+class QNetworkReply;
+
+// 录制的一次 HTTP 交换
+struct RecordedExchange {
+    qint64 startedMs = 0;      // 相对录制开始的发出时间
+    QByteArray method;
+    QString pathAndQuery;      // 回放时按路径和查询参数匹配，忽略主机
+    QByteArray range;          // 请求的 Range 头（分段下载）
+    int status = 0;            // HTTP 状态码，网络错误时为 0
+    int error = 0;             // QNetworkReply::NetworkError
+    QString errorString;
+    QList<QPair<QByteArray, QByteArray>> headers;  // 响应头
+    qint64 firstByteMs = 0;    // 发出到收到响应头
+    qint64 durationMs = 0;     // 发出到结束
+    QByteArray body;           // API 响应的完整内容；视频下载只保存开头部分
+    qint64 bodySize = 0;       // 响应内容的实际大小
+};
+
+// API 流量的录制和回放，挂在 NetworkClient 上，对 ApiService 及其上层透明。
+//
+// 录制：每个请求结束后向文件追加一行紧凑 JSON，包含时间、状态、响应头和响应内容。
+// 不保存 Authorization 头；请求体中的 Base64 图片和 API Key 字段被替换为占位符；
+// 视频下载只保存开头 MAX_BODY_HEAD 字节和总大小。
+//
+// 回放：不访问网络，按请求的方法、路径和查询参数找到录制的响应，按原始的首字节时间
+// 和总耗时（除以 speed）返回。POST 按录制顺序依次取用；GET 取录制时间不晚于当前
+// 回放时间的最后一条，使任务状态的变化与录制时一致。视频内容在开头之后以零填充。
+class TrafficRecorder : public QObject {
+    Q_OBJECT
+public:
+    enum class Mode { Off, Record, Replay };
+
+    explicit TrafficRecorder(QObject *parent = nullptr);
+    ~TrafficRecorder();
+
+    bool startRecording(const QString &path);
+    bool loadReplay(const QString &path, double speed = 1.0);
+    Mode mode() const;
+
+    // 录制模式：在调用方连接 reply 的信号之前调用
+    void record(QNetworkReply *reply, const QByteArray &requestBody, bool binaryBody);
+    // 回放模式：返回按录制数据模拟的 reply
+    QNetworkReply *replay(QNetworkAccessManager::Operation operation, const QNetworkRequest &request, QObject *parent);
+
+    // 将请求体中的 Base64 图片和 API Key 替换为占位符
+    static QByteArray redactBody(const QByteArray &body);
+
+    static const int MAX_BODY_HEAD = 64 * 1024;
+    static const int REDACT_MIN_LENGTH = 256;  // 超过此长度的 Base64 字符串视为图片数据
+
+private:
+    void write(const QJsonObject &entry);
+    const RecordedExchange *match(const QByteArray &method, const QString &pathAndQuery, const QByteArray &range);
+    static QString pathAndQuery(const QUrl &url);
+    static QJsonValue redactValue(const QString &key, const QJsonValue &value);
+
+    Mode currentMode;
+    QFile file;
+    QElapsedTimer clock;
+    double replaySpeed;
+    QMap<QString, QList<RecordedExchange>> exchanges;  // 匹配键 -> 按录制时间排序
+    QMap<QString, int> nextPost;                       // POST 匹配键 -> 下一条的下标
+};
+
+#endif // TRAFFICRECORDER_H
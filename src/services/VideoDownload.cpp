@@ -0,0 +1,404 @@
+#include "VideoDownload.h"
+#include "TaskDatabaseService.h"
+#include "NetworkClient.h"
+#include "DownloadScheduler.h"
+#include <QNetworkRequest>
+#include <QFileInfo>
+#include <filesystem>
+#include <system_error>
+
+VideoDownload::VideoDownload(NetworkClient *network, const QUrl &url, const QString &destPath, QObject *parent)
+    : QObject(parent), network(network), sourceUrl(url), destPath(destPath),
+      hasher(QCryptographicHash::Sha256), reply(nullptr), received(0),
+      resumeOffset(0), responseChecked(false), discardBody(false), resumeAttempts(0),
+      schedulerId(0), throttledReadPending(false), integrityError(false),
+      aborted(false), journal(nullptr), journaledBytes(0) {
+    stagingFile.setFileName(stagingPath());
+}
+
+VideoDownload::~VideoDownload() {
+    if (reply) {
+        reply->abort();
+    }
+}
+
+void VideoDownload::setJournal(TaskDatabaseService *journal, const QString &taskId) {
+    this->journal = journal;
+    journalEntry.destPath = destPath;
+    journalEntry.taskId = taskId;
+}
+
+QUrl VideoDownload::url() const {
+    return sourceUrl;
+}
+
+QString VideoDownload::destinationPath() const {
+    return destPath;
+}
+
+QString VideoDownload::stagingPath() const {
+    return destPath + ".part";
+}
+
+qint64 VideoDownload::bytesReceived() const {
+    return received;
+}
+
+QByteArray VideoDownload::contentHash() const {
+    return digest;
+}
+
+bool VideoDownload::integrityFailed() const {
+    return integrityError;
+}
+
+void VideoDownload::setSchedulerId(quint64 id) {
+    schedulerId = id;
+}
+
+void VideoDownload::start() {
+    QDir dir = QFileInfo(destPath).absoluteDir();
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+
+    if (!journal) {
+        openStaging(DownloadJournalEntry());
+        return;
+    }
+    // 日志记录在数据库线程中读取，返回后再打开暂存文件并发出请求
+    journal->getDownloadJournalAsync(destPath).then(this, [this](const DownloadJournalEntry &saved) {
+        openStaging(saved);
+    });
+}
+
+void VideoDownload::openStaging(const DownloadJournalEntry &saved) {
+    if (aborted) {
+        fail("下载已取消");
+        return;
+    }
+
+    // 有日志记录和暂存文件时续传，否则从头下载
+    bool resume = false;
+    if (saved.isValid() && QFile::exists(stagingPath())
+        && (!saved.etag.isEmpty() || !saved.lastModified.isEmpty())) {
+        journalEntry.etag = saved.etag;
+        journalEntry.lastModified = saved.lastModified;
+        journalEntry.totalBytes = saved.totalBytes;
+        resume = true;
+    }
+
+    // 暂存文件与目标文件在同一目录，保证最终的 rename 是原子操作
+    QIODevice::OpenMode mode = QIODevice::ReadWrite;
+    if (!resume) {
+        mode |= QIODevice::Truncate;
+    }
+    if (!stagingFile.open(mode)) {
+        fail("无法创建暂存文件: " + stagingFile.errorString());
+        return;
+    }
+
+    // 以暂存文件的实际大小为准：顺序写入保证其内容总是有效前缀
+    received = stagingFile.size();
+    if (received > 0) {
+        // 续传：已下载的前缀重新读一遍计入哈希和结构检查，之后的数据边写边算。
+        // QCryptographicHash 的中间状态无法导出，不能随下载日志保存，只能重读前缀
+        stagingFile.seek(0);
+        char buffer[64 * 1024];
+        qint64 n;
+        while ((n = stagingFile.read(buffer, sizeof(buffer))) > 0) {
+            hasher.addData(QByteArrayView(buffer, n));
+            verifier.addData(buffer, n);
+        }
+    }
+    stagingFile.seek(received);
+    journaledBytes = received;
+    if (received > 0) {
+        qDebug() << "Resuming download of" << destPath << "from byte" << received;
+    }
+
+    sendRequest();
+}
+
+void VideoDownload::sendRequest() {
+    QNetworkRequest request{sourceUrl};
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+
+    resumeOffset = received;
+    responseChecked = false;
+    discardBody = false;
+    if (resumeOffset > 0) {
+        // 只有校验器仍匹配时服务器才返回 206，否则返回完整的 200 响应
+        QByteArray validator = journalEntry.etag.isEmpty()
+            ? journalEntry.lastModified.toUtf8() : journalEntry.etag.toUtf8();
+        request.setRawHeader("Range", "bytes=" + QByteArray::number(resumeOffset) + "-");
+        request.setRawHeader("If-Range", validator);
+    }
+
+    reply = network->get(request, NetworkClient::Traffic::Download);
+    reply->setReadBufferSize(READ_BUFFER_SIZE);
+
+    connect(reply, &QNetworkReply::metaDataChanged, this, &VideoDownload::onMetaDataChanged);
+    connect(reply, &QNetworkReply::readyRead, this, &VideoDownload::onReadyRead);
+    connect(reply, &QNetworkReply::finished, this, &VideoDownload::onFinished);
+    connect(reply, &QNetworkReply::downloadProgress, this, [this](qint64 bytesReceived, qint64 bytesTotal) {
+        emit progress(resumeOffset + bytesReceived, bytesTotal > 0 ? resumeOffset + bytesTotal : bytesTotal);
+    });
+}
+
+void VideoDownload::abort() {
+    aborted = true;  // 还在读取下载日志时，读取返回后不再发出请求
+    if (reply) {
+        reply->abort();
+    }
+}
+
+void VideoDownload::onMetaDataChanged() {
+    if (!checkResponse()) {
+        reply->abort();
+    }
+}
+
+bool VideoDownload::checkResponse() {
+    if (responseChecked) {
+        return true;
+    }
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 0 || (status >= 300 && status < 400)) {
+        return true;  // 重定向中间响应，等待最终响应
+    }
+    responseChecked = true;
+
+    if (status == 206) {
+        // Content-Range: bytes <start>-<end>/<total>
+        QByteArray range = reply->rawHeader("Content-Range");
+        qint64 start = range.mid(6, range.indexOf('-') - 6).trimmed().toLongLong();
+        if (!range.startsWith("bytes ") || start != resumeOffset) {
+            qDebug() << "Unexpected Content-Range" << range << "for offset" << resumeOffset;
+            return false;
+        }
+        qint64 total = range.mid(range.indexOf('/') + 1).toLongLong();
+        if (total > 0) {
+            journalEntry.totalBytes = total;
+        }
+    } else if (status >= 200 && status < 300) {
+        // 服务器返回完整内容（不支持 Range 或 If-Range 校验失败），从头写入
+        if (resumeOffset > 0) {
+            qDebug() << "Server ignored range request for" << destPath << ", restarting";
+        }
+        stagingFile.resize(0);
+        stagingFile.seek(0);
+        hasher.reset();
+        verifier.reset();
+        received = 0;
+        resumeOffset = 0;
+        journaledBytes = 0;
+        journalEntry.totalBytes = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+        // 压缩编码时 Content-Length 是压缩后的大小，不能用来核对解压后的字节数
+        QByteArray encoding = reply->rawHeader("Content-Encoding").trimmed().toLower();
+        if (journalEntry.totalBytes <= 0 || !(encoding.isEmpty() || encoding == "identity")) {
+            journalEntry.totalBytes = -1;
+        }
+    } else {
+        discardBody = true;  // 错误状态由 finished 处理，响应体不能写入暂存文件
+        return true;
+    }
+
+    // 记录校验器：优先使用强 ETag，弱 ETag 不能用于 If-Range
+    QString etag = QString::fromUtf8(reply->rawHeader("ETag"));
+    journalEntry.etag = etag.startsWith("W/") ? "" : etag;
+    journalEntry.lastModified = QString::fromUtf8(reply->rawHeader("Last-Modified"));
+    updateJournal(true);
+    return true;
+}
+
+void VideoDownload::onReadyRead() {
+    if (!checkResponse()) {
+        reply->abort();
+        return;
+    }
+    if (discardBody) {
+        reply->skip(reply->bytesAvailable());
+        return;
+    }
+    if (!writeAvailable(reply, true)) {
+        reply->abort();
+        return;
+    }
+    updateJournal();
+}
+
+bool VideoDownload::writeAvailable(QNetworkReply *source, bool throttled) {
+    // 分块读取，避免一次性把缓冲区中的数据复制成大块 QByteArray
+    DownloadScheduler *scheduler = DownloadScheduler::instance();
+    char buffer[64 * 1024];
+    while (source->bytesAvailable() > 0) {
+        qint64 wanted = qMin<qint64>(sizeof(buffer), source->bytesAvailable());
+        if (throttled) {
+            // 未读的数据留在读缓冲区中，缓冲区满后由 TCP 流控减缓服务器发送
+            wanted = scheduler->takeBytes(schedulerId, wanted);
+            if (wanted == 0) {
+                scheduleThrottledRead();
+                break;
+            }
+        }
+        qint64 n = source->read(buffer, wanted);
+        if (n <= 0) {
+            break;
+        }
+        if (!throttled) {
+            scheduler->consumeBytes(n);
+        }
+        if (stagingFile.write(buffer, n) != n) {
+            return false;
+        }
+        hasher.addData(QByteArrayView(buffer, n));
+        verifier.addData(buffer, n);
+        received += n;
+    }
+    return true;
+}
+
+void VideoDownload::scheduleThrottledRead() {
+    // 缓冲区中已有的数据不会再触发 readyRead，需要自行安排下一次读取
+    if (throttledReadPending) {
+        return;
+    }
+    throttledReadPending = true;
+    QTimer::singleShot(DownloadScheduler::instance()->msUntilBytesAvailable(schedulerId), this, [this]() {
+        throttledReadPending = false;
+        if (reply && reply->bytesAvailable() > 0) {
+            onReadyRead();
+        }
+    });
+}
+
+void VideoDownload::updateJournal(bool force) {
+    if (!journal || (!force && received - journaledBytes < JOURNAL_FLUSH_BYTES)) {
+        return;
+    }
+    // 先落盘数据再记录进度，保证日志不会超前于文件内容
+    stagingFile.flush();
+    journalEntry.url = sourceUrl.toString();
+    journalEntry.bytesDone = received;
+    journalEntry.updateTime = QDateTime::currentDateTime();
+    journal->saveDownloadJournalAsync(journalEntry);  // 不等待写入，后续的读取按提交顺序仍能看到
+    journaledBytes = received;
+}
+
+void VideoDownload::onFinished() {
+    QNetworkReply *finishedReply = reply;
+    reply = nullptr;
+    finishedReply->deleteLater();
+
+    // 写入失败时 onReadyRead 会中止请求，这里优先报告文件错误；
+    // 请求已结束，限速时留在缓冲区中的剩余数据直接读完（计入带宽预算）
+    if (stagingFile.error() != QFileDevice::NoError) {
+        fail("写入暂存文件失败: " + stagingFile.errorString());
+        return;
+    }
+
+    QNetworkReply::NetworkError error = finishedReply->error();
+    if (error == QNetworkReply::NoError && !writeAvailable(finishedReply, false)) {
+        fail("写入暂存文件失败: " + stagingFile.errorString());
+        return;
+    }
+
+    if (error != QNetworkReply::NoError) {
+        bool canResume = journal && isResumableError(error)
+            && (!journalEntry.etag.isEmpty() || !journalEntry.lastModified.isEmpty());
+        if (canResume && resumeAttempts < MAX_RESUME_ATTEMPTS) {
+            // 网络中断：保留已下载部分，稍后以 Range 请求续传
+            resumeAttempts++;
+            updateJournal(true);
+            qDebug() << "Download interrupted at" << received << "bytes, resume attempt" << resumeAttempts
+                     << "for" << destPath << ":" << finishedReply->errorString();
+            QTimer::singleShot(RESUME_DELAY_MS * resumeAttempts, this, &VideoDownload::sendRequest);
+            return;
+        }
+        fail(finishedReply->errorString(), canResume);
+        return;
+    }
+
+    QString problem;
+    if (!verifyContent(&problem)) {
+        // 损坏的文件不保留：续传只会在错误的前缀上继续
+        integrityError = true;
+        qWarning() << "Downloaded file" << destPath << "failed verification:" << problem;
+        fail("下载的视频不完整或已损坏: " + problem);
+        return;
+    }
+
+    if (!commit()) {
+        fail("无法保存视频文件: " + destPath);
+        return;
+    }
+
+    if (journal) {
+        journal->deleteDownloadJournalAsync(destPath);
+    }
+    emit finished(destPath);
+}
+
+bool VideoDownload::isResumableError(QNetworkReply::NetworkError error) {
+    switch (error) {
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::ServiceUnavailableError:
+        case QNetworkReply::InternalServerError:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool VideoDownload::verifyContent(QString *error) const {
+    if (journalEntry.totalBytes > 0 && received != journalEntry.totalBytes) {
+        *error = QString("收到 %1 字节，应为 %2 字节").arg(received).arg(journalEntry.totalBytes);
+        return false;
+    }
+    return verifier.finish(error);
+}
+
+bool VideoDownload::commit() {
+    if (!stagingFile.flush()) {
+        return false;
+    }
+    stagingFile.close();
+    digest = hasher.result();
+    return atomicReplace(stagingPath(), destPath);
+}
+
+bool VideoDownload::atomicReplace(const QString &from, const QString &to) {
+    // std::filesystem::rename 在同一文件系统内原子替换目标文件
+    std::error_code ec;
+    std::filesystem::rename(std::filesystem::path(from.toStdU16String()),
+                            std::filesystem::path(to.toStdU16String()), ec);
+    if (ec) {
+        qDebug() << "Rename staging file failed:" << QString::fromStdString(ec.message());
+        return false;
+    }
+    return true;
+}
+
+void VideoDownload::fail(const QString &error, bool keepPartial) {
+    if (stagingFile.isOpen()) {
+        stagingFile.close();
+    }
+    if (keepPartial) {
+        // 保留暂存文件和日志，程序下次启动时续传
+        qDebug() << "Keeping partial download" << stagingPath() << "(" << received << "bytes) for later resume";
+    } else {
+        stagingFile.remove();
+        if (journal) {
+            journal->deleteDownloadJournalAsync(destPath);
+        }
+    }
+    emit failed(error);
+}
@@ -0,0 +1,99 @@
+#ifndef VIDEODOWNLOAD_H
+#define VIDEODOWNLOAD_H
+
+#include "const/QtHeaders.h"
+#include "models/DownloadJournalEntry.h"
+#include "utils/Mp4Verifier.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QUrl>
+#include <QNetworkReply>
+
+class TaskDatabaseService;
+class NetworkClient;
+
+// 单个视频的流式下载：每次 readyRead 将数据直接写入与目标文件同目录的
+// 暂存文件（<目标>.part），完成后原子重命名为最终文件。
+// QNetworkReply 的读缓冲区被限制为 READ_BUFFER_SIZE，内存占用与视频大小无关。
+//
+// 设置了下载日志（setJournal）后支持断点续传：暂存文件和 download_journal
+// 中的记录在网络错误或程序退出后保留，下次以 Range + If-Range 请求续传；
+// 服务器返回 200（不支持范围或文件已变化）时从头重新下载。
+//
+// 写入的同时计算内容的 SHA-256 并流式检查 MP4 结构（续传时先读入已有的前缀），
+// 完成时核对字节数与 Content-Length，不一致或结构不完整时视为损坏，删除暂存文件。
+// 读取数据前向 DownloadScheduler 申请带宽预算，没有预算时暂不读取，稍后再读。
+class VideoDownload : public QObject {
+    Q_OBJECT
+public:
+    VideoDownload(NetworkClient *network, const QUrl &url, const QString &destPath, QObject *parent = nullptr);
+    ~VideoDownload();
+
+    void setJournal(TaskDatabaseService *journal, const QString &taskId);
+    void setSchedulerId(quint64 id);  // DownloadScheduler 中的编号，带宽预算按其优先级分配
+    void start();
+    void abort();
+
+    QUrl url() const;
+    QString destinationPath() const;
+    QString stagingPath() const;
+    qint64 bytesReceived() const;
+    QByteArray contentHash() const;  // 完成后有效：文件内容的 SHA-256
+    bool integrityFailed() const;    // 失败原因是内容不完整或已损坏（可重新下载）
+
+    // 网络中断类错误可续传；HTTP 4xx 等错误不可续传
+    static bool isResumableError(QNetworkReply::NetworkError error);
+    // 将暂存文件原子重命名为目标文件（两者需在同一文件系统）
+    static bool atomicReplace(const QString &from, const QString &to);
+
+    static constexpr qint64 READ_BUFFER_SIZE = 256 * 1024;
+    static constexpr qint64 JOURNAL_FLUSH_BYTES = 1024 * 1024;  // 每写入 1MB 更新一次日志
+    static const int MAX_RESUME_ATTEMPTS = 5;
+    static const int RESUME_DELAY_MS = 2000;
+
+signals:
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
+    void finished(const QString &localPath);
+    void failed(const QString &error);
+
+private slots:
+    void onMetaDataChanged();
+    void onReadyRead();
+    void onFinished();
+
+private:
+    void openStaging(const DownloadJournalEntry &saved);  // saved 为日志中的记录，没有时无效
+    void sendRequest();
+    bool checkResponse();
+    // throttled 为 true 时只读取带宽预算允许的部分，其余稍后再读
+    bool writeAvailable(QNetworkReply *source, bool throttled);
+    void scheduleThrottledRead();
+    void updateJournal(bool force = false);
+    bool verifyContent(QString *error) const;
+    bool commit();
+    void fail(const QString &error, bool keepPartial = false);
+
+    NetworkClient *network;
+    QUrl sourceUrl;
+    QString destPath;
+    QFile stagingFile;
+    QCryptographicHash hasher;
+    Mp4Verifier verifier;
+    QByteArray digest;
+    QNetworkReply *reply;
+    qint64 received;
+    qint64 resumeOffset;      // 本次请求的起始偏移
+    bool responseChecked;
+    bool discardBody;         // 错误响应的内容直接丢弃
+    int resumeAttempts;
+    quint64 schedulerId;
+    bool throttledReadPending;
+    bool integrityError;
+    bool aborted;
+
+    TaskDatabaseService *journal;
+    DownloadJournalEntry journalEntry;
+    qint64 journaledBytes;
+};
+
+#endif // VIDEODOWNLOAD_H
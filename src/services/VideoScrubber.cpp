@@ -0,0 +1,141 @@
+#include "VideoScrubber.h"
+#include "TaskDatabaseService.h"
+#include "DownloadScheduler.h"
+#include "const/AppConfig.h"
+
+VideoScrubber::VideoScrubber(TaskDatabaseService *dbService, QObject *parent)
+    : QObject(parent), dbService(dbService), index(-1), hasher(QCryptographicHash::Sha256), corruptCount(0),
+      running(false) {
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &VideoScrubber::step);
+}
+
+bool VideoScrubber::isRunning() const {
+    return running;
+}
+
+void VideoScrubber::scheduleIfDue() {
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    QDateTime last = settings.value(Config::KEY_LAST_VIDEO_SCRUB).toDateTime();
+    if (last.isValid() && last.daysTo(QDateTime::currentDateTime()) < Config::VIDEO_SCRUB_INTERVAL_DAYS) {
+        return;
+    }
+    // 启动后先让界面、续传和轮询完成初始工作
+    QTimer::singleShot(STARTUP_DELAY_MS, this, &VideoScrubber::start);
+}
+
+void VideoScrubber::start() {
+    if (running) {
+        return;
+    }
+    running = true;
+    dbService->run([](TaskDatabase &db) { return db.getVideoBlobs(); })
+        .then(this, [this](const QList<VideoBlob> &stored) {
+            if (!running) {
+                return;  // 读取返回前已 stop()
+            }
+            blobs = stored;
+            index = -1;
+            corruptCount = 0;
+            qDebug() << "Scrubbing" << blobs.size() << "stored videos";
+            timer->start(0);
+        });
+}
+
+void VideoScrubber::stop() {
+    timer->stop();
+    file.close();
+    running = false;
+}
+
+void VideoScrubber::step() {
+    // 下载写入时让路，不增加磁盘负载
+    if (DownloadScheduler::instance()->activeCount() > 0) {
+        timer->start(BUSY_RETRY_MS);
+        return;
+    }
+
+    if (!file.isOpen() && !openNext()) {
+        // 排在已提交的删除之后：其结果都已计入 corruptCount 再结束
+        dbService->run([](TaskDatabase &) {}).then(this, [this]() {
+            running = false;
+            QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+            settings.setValue(Config::KEY_LAST_VIDEO_SCRUB, QDateTime::currentDateTime());
+            qDebug() << "Video scrub finished:" << blobs.size() << "checked," << corruptCount << "corrupt";
+            emit scrubFinished(blobs.size(), corruptCount);
+            blobs.clear();
+        });
+        return;
+    }
+
+    char buffer[64 * 1024];
+    qint64 budget = SCRUB_CHUNK_SIZE;
+    while (budget > 0) {
+        qint64 n = file.read(buffer, qMin<qint64>(sizeof(buffer), budget));
+        if (n < 0) {
+            removeCorrupt("读取失败: " + file.errorString());
+            break;
+        }
+        if (n == 0) {
+            finishCurrent();
+            break;
+        }
+        hasher.addData(QByteArrayView(buffer, n));
+        verifier.addData(buffer, n);
+        budget -= n;
+    }
+    timer->start(STEP_INTERVAL_MS);
+}
+
+bool VideoScrubber::openNext() {
+    while (++index < blobs.size()) {
+        file.setFileName(blobs[index].path);
+        hasher.reset();
+        verifier.reset();
+        if (file.open(QIODevice::ReadOnly)) {
+            return true;
+        }
+        removeCorrupt(QFile::exists(blobs[index].path) ? "无法打开: " + file.errorString() : "文件不存在");
+    }
+    return false;
+}
+
+void VideoScrubber::finishCurrent() {
+    const VideoBlob &blob = blobs[index];
+    QString problem;
+    QString hex = QString::fromLatin1(hasher.result().toHex());
+    if (verifier.bytesSeen() != blob.size) {
+        problem = QString("大小为 %1 字节，应为 %2 字节").arg(verifier.bytesSeen()).arg(blob.size);
+    } else if (hex != blob.hash) {
+        problem = "内容与哈希不符";
+    } else {
+        verifier.finish(&problem);
+    }
+    if (problem.isEmpty()) {
+        file.close();
+        return;
+    }
+    removeCorrupt(problem);
+}
+
+void VideoScrubber::removeCorrupt(const QString &reason) {
+    VideoBlob blob = blobs[index];
+    file.close();
+    // 记录的检查和删除在数据库线程中一次完成；开始校验后才被淘汰的视频（记录已删除）不算损坏
+    dbService->run([hash = blob.hash](TaskDatabase &db) { return db.hasVideoBlob(hash) && db.deleteVideoBlob(hash); })
+        .then(this, [this, blob, reason](bool removed) {
+            if (!removed) {
+                return;
+            }
+            if (QFile::exists(blob.path) && !QFile::remove(blob.path)) {
+                // 例如正在播放而被占用：恢复记录，下次再校验
+                qDebug() << "Cannot remove corrupt video" << blob.path;
+                dbService->run([blob](TaskDatabase &db) { db.addVideoBlob(blob.hash, blob.path, blob.size); });
+                return;
+            }
+            corruptCount++;
+            qWarning() << "Corrupt video" << blob.path << ":" << reason;
+            emit corruptVideoFound(blob.path, reason);
+        });
+}
@@ -0,0 +1,54 @@
+#ifndef VIDEOSCRUBBER_H
+#define VIDEOSCRUBBER_H
+
+#include "const/QtHeaders.h"
+#include "models/VideoBlob.h"
+#include "utils/Mp4Verifier.h"
+#include <QCryptographicHash>
+#include <QFile>
+
+class TaskDatabaseService;
+
+// 后台重新校验视频存储：逐个读取 video_blobs 中的视频，核对 SHA-256 与文件名、
+// 大小与记录，并检查 MP4 结构。以低 I/O 优先级运行：每步只读 SCRUB_CHUNK_SIZE，
+// 步与步之间让出事件循环；有视频正在下载时暂停，不与下载争抢磁盘。
+//
+// 损坏或丢失的视频从存储中删除（文件和 video_blobs 记录），任务保留 localFilePath 和
+// videoHash，与被淘汰的视频一样可按视频 URL 重新下载回原位置；由 corruptVideoFound 的接收方安排。
+class VideoScrubber : public QObject {
+    Q_OBJECT
+public:
+    explicit VideoScrubber(TaskDatabaseService *dbService, QObject *parent = nullptr);
+
+    void start();          // 立即开始一轮校验（已在进行时忽略）
+    void scheduleIfDue();  // 距上次完整校验超过 VIDEO_SCRUB_INTERVAL_DAYS 时，延迟 STARTUP_DELAY_MS 后开始
+    void stop();
+    bool isRunning() const;
+
+    static constexpr qint64 SCRUB_CHUNK_SIZE = 256 * 1024;
+    static const int STEP_INTERVAL_MS = 25;       // 约 10MB/s
+    static const int BUSY_RETRY_MS = 5000;        // 有下载进行时的等待间隔
+    static const int STARTUP_DELAY_MS = 60000;
+
+signals:
+    void corruptVideoFound(const QString &path, const QString &reason);
+    void scrubFinished(int checked, int corrupt);
+
+private:
+    void step();
+    bool openNext();
+    void finishCurrent();
+    void removeCorrupt(const QString &reason);
+
+    TaskDatabaseService *dbService;
+    QTimer *timer;
+    QList<VideoBlob> blobs;
+    int index;
+    QFile file;
+    QCryptographicHash hasher;
+    Mp4Verifier verifier;
+    int corruptCount;
+    bool running;
+};
+
+#endif // VIDEOSCRUBBER_H
@@ -0,0 +1,180 @@
+#include "VideoStore.h"
+#include "HistoryService.h"
+#include "TaskDatabaseService.h"
+#include "VideoDownload.h"
+#include "const/AppConfig.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+
+VideoStore::VideoStore(TaskDatabaseService *dbService, HistoryService *historyService, QObject *parent)
+    : QObject(parent), dbService(dbService), historyService(historyService), quotaBytes(0),
+      evictionTimer(new QTimer(this)) {
+    evictionTimer->setSingleShot(true);
+    evictionTimer->setInterval(EVICTION_INTERVAL_MS);
+    connect(evictionTimer, &QTimer::timeout, this, &VideoStore::evictStep);
+}
+
+QString VideoStore::root() const {
+    return QDir(historyService->getSavePath()).filePath("objects");
+}
+
+QString VideoStore::incomingPath(const QString &taskId) const {
+    QString name = taskId + "_" + QString::number(QDateTime::currentMSecsSinceEpoch()) + ".mp4";
+    return QDir(root()).filePath("incoming/" + name);
+}
+
+QString VideoStore::blobPath(const QString &hash) const {
+    return QDir(root()).filePath(hash.left(2) + "/" + hash + ".mp4");
+}
+
+QString VideoStore::add(const QString &downloadedPath, const QByteArray &hash, const QString &taskId) {
+    QByteArray digest = hash.isEmpty() ? hashFile(downloadedPath) : hash;
+    if (digest.isEmpty()) {
+        return QString();
+    }
+    QString hex = QString::fromLatin1(digest.toHex());
+    QString target = blobPath(hex);
+    qint64 size = QFileInfo(downloadedPath).size();
+
+    if (QFile::exists(target)) {
+        // 相同内容已在存储中：丢弃新下载的副本
+        qDebug() << "Video of task" << taskId << "already stored as" << target;
+        QFile::remove(downloadedPath);
+    } else {
+        QDir().mkpath(QFileInfo(target).absolutePath());
+        if (!VideoDownload::atomicReplace(downloadedPath, target)) {
+            // 下载目录与存储不在同一文件系统（例如旧的下载日志指向别处）时复制
+            if (!QFile::copy(downloadedPath, target)) {
+                return QString();
+            }
+            QFile::remove(downloadedPath);
+        }
+    }
+
+    // 不等待写入：之后的淘汰查询在同一线程中按提交顺序执行，能看到这条记录
+    dbService->run([hex, target, size, taskId](TaskDatabase &db) {
+        db.transaction([&]() {
+            return db.addVideoBlob(hex, target, size) && (taskId.isEmpty() || db.setTaskVideo(taskId, hex, target));
+        });
+    });
+    scheduleEviction();
+    return target;
+}
+
+void VideoStore::setQuota(qint64 bytes) {
+    quotaBytes = qMax<qint64>(0, bytes);
+    scheduleEviction();
+}
+
+qint64 VideoStore::quota() const {
+    return quotaBytes;
+}
+
+void VideoStore::reloadSettings() {
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    qint64 gigabytes = settings.value(Config::KEY_VIDEO_STORE_QUOTA_GB, Config::DEFAULT_VIDEO_STORE_QUOTA_GB).toLongLong();
+    setQuota(gigabytes * 1024 * 1024 * 1024);
+}
+
+void VideoStore::scheduleEviction() {
+    if (quotaBytes > 0 && !evictionTimer->isActive()) {
+        evictionTimer->start();
+    }
+}
+
+void VideoStore::releaseVideo(const QString &path, const QString &prompt) {
+    // 存储按内容去重，相同的视频可能被多条历史记录引用
+    const QList<HistoryItem> items = historyService->getItems();
+    bool inHistory = std::any_of(items.cbegin(), items.cend(), [&path](const HistoryItem &item) {
+        return item.filePath == path;
+    });
+    if (inHistory || path.isEmpty()) {
+        return;
+    }
+
+    dbService->run([path, prompt](TaskDatabase &db) { return db.releaseVideo(path, prompt); })
+        .then(this, [path](bool release) {
+            if (!release) {
+                qDebug() << "Keeping" << path << ": still referenced by other tasks";
+                return;
+            }
+            QFile::remove(path);
+        });
+}
+
+void VideoStore::evictStep() {
+    if (quotaBytes <= 0) {
+        return;
+    }
+
+    // 总大小、候选视频的查询和记录的删除在数据库线程中一次完成，界面线程只删除文件
+    qint64 quota = quotaBytes;
+    dbService->run([quota](TaskDatabase &db) {
+        EvictionStep step;
+        step.used = db.videoStoreSize();
+        if (step.used <= quota) {
+            return step;
+        }
+        const QList<VideoBlob> candidates = db.getEvictionCandidates(EVICTION_BATCH);
+        bool committed = db.transaction([&]() {
+            for (const VideoBlob &blob : candidates) {
+                if (step.used <= quota) {
+                    break;
+                }
+                if (!db.deleteVideoBlob(blob.hash)) {
+                    return false;
+                }
+                step.victims.append(blob);
+                step.used -= blob.size;
+            }
+            return true;
+        });
+        if (!committed) {
+            step.victims.clear();
+        }
+        return step;
+    }).then(this, [this, quota](const EvictionStep &step) {
+        if (step.victims.isEmpty()) {
+            if (step.used > quota) {
+                qDebug() << "Video store over quota (" << step.used << "/" << quota << "bytes) but nothing can be evicted";
+            }
+            return;
+        }
+
+        QList<VideoBlob> kept;
+        for (const VideoBlob &blob : step.victims) {
+            if (QFile::exists(blob.path) && !QFile::remove(blob.path)) {
+                qDebug() << "Cannot evict" << blob.path;  // 例如正在播放而被占用
+                kept.append(blob);
+                continue;
+            }
+            qDebug() << "Evicted" << blob.path << "(" << blob.size << "bytes, last used" << blob.lastUsed << ")";
+            emit videoEvicted(blob.path, blob.size);
+        }
+        if (!kept.isEmpty()) {
+            // 删不掉的文件仍在存储中，恢复其记录
+            dbService->run([kept](TaskDatabase &db) {
+                for (const VideoBlob &blob : kept) {
+                    db.addVideoBlob(blob.hash, blob.path, blob.size);
+                }
+            });
+        }
+
+        // 仍超出上限时下一步继续，期间事件循环照常处理；本步一个都删不掉时等下次新增视频再试
+        if (step.used > quota && kept.size() < step.victims.size()) {
+            evictionTimer->start();
+        }
+    });
+}
+
+QByteArray VideoStore::hashFile(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hasher(QCryptographicHash::Sha256);
+    hasher.addData(&file);
+    return hasher.result();
+}
@@ -0,0 +1,67 @@
+#ifndef VIDEOSTORE_H
+#define VIDEOSTORE_H
+
+#include "const/QtHeaders.h"
+#include "models/VideoBlob.h"
+
+class TaskDatabaseService;
+class HistoryService;
+
+// 内容寻址的本地视频存储，位于保存目录下的 objects/：
+//
+//   objects/incoming/<taskId>_<ms>.mp4  下载中和刚下载完的文件（与分片目录在同一文件系统）
+//   objects/<hh>/<sha256>.mp4           按内容 SHA-256 命名，hh 为哈希的前两位
+//
+// 下载完成后按下载时计算的哈希移入分片目录；相同内容已存在时删除新文件，
+// 不占用额外磁盘空间。视频记录在 video_blobs，任务通过 tasks.video_hash 引用。
+// 按哈希前缀分成 256 个子目录，数万个视频时每个目录仍只有几百个文件。
+//
+// 设置了容量上限（setQuota）后，超出时在事件循环中分步淘汰：每步删除最多
+// EVICTION_BATCH 个最久未播放的视频，步与步之间让出事件循环，不做阻塞式的整体清理。
+// 每步的查询和记录删除在数据库线程中执行，界面线程只删除文件。
+// 只淘汰仍有视频 URL 的视频，任务保留 localFilePath 和 videoHash，播放时可重新下载回原位置。
+class VideoStore : public QObject {
+    Q_OBJECT
+public:
+    VideoStore(TaskDatabaseService *dbService, HistoryService *historyService, QObject *parent = nullptr);
+
+    QString root() const;  // 随保存路径变化
+    QString incomingPath(const QString &taskId) const;  // 每次调用返回新文件名，同一任务可同时下载
+    QString blobPath(const QString &hash) const;
+
+    // 把下载完成的文件移入存储并记录任务的引用，返回视频在存储中的路径；失败时返回空字符串。
+    // hash 为空时（如下载器未能计算）读一遍文件计算。
+    QString add(const QString &downloadedPath, const QByteArray &hash, const QString &taskId);
+
+    void setQuota(qint64 bytes);  // 0 表示不限制
+    qint64 quota() const;
+    void reloadSettings();        // 从 QSettings 读取容量上限
+    void scheduleEviction();      // 超出上限时开始后台淘汰
+    // 画廊中的一条记录（提示词为 prompt）已删除：文件不再被其他历史记录或任务引用时删除文件和
+    // video_blobs 中的记录，否则只保留文件。引用检查和记录删除在数据库线程中一次完成
+    void releaseVideo(const QString &path, const QString &prompt);
+
+    static QByteArray hashFile(const QString &path);
+
+    static const int EVICTION_BATCH = 4;
+    static const int EVICTION_INTERVAL_MS = 200;
+
+signals:
+    void videoEvicted(const QString &path, qint64 size);
+
+private:
+    // 一步淘汰在数据库线程中的结果：已删除记录的视频，以及删除后的总大小
+    struct EvictionStep {
+        QList<VideoBlob> victims;
+        qint64 used = 0;
+    };
+
+    void evictStep();
+
+    TaskDatabaseService *dbService;
+    HistoryService *historyService;
+    qint64 quotaBytes;
+    QTimer *evictionTimer;
+};
+
+#endif // VIDEOSTORE_H
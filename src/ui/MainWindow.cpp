@@ -4,7 +4,12 @@
 #include "const/QtHeaders.h"
 #include "const/AppConfig.h"
 #include "services/TaskDatabaseService.h"
+#include "services/NetworkClient.h"
+#include "services/PollScheduler.h"
+#include "services/RateLimiter.h"
+#include "services/ParameterSweep.h"
 #include "models/TaskItem.h"
+#include "utils/ImageUtils.h"
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), taskHistoryWindow(nullptr), settingsDialog(nullptr) {
     viewModel = new MainViewModel(this);
@@ -26,86 +31,43 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), taskHistoryWindow
 
     connect(viewModel, &MainViewModel::videoReady, this, &MainWindow::onVideoReady);
     connect(viewModel, &MainViewModel::historyUpdated, this, &MainWindow::updateHistoryList);
+    connect(viewModel, &MainViewModel::queueChanged, this, [this](int active, int waiting) {
+        queueLabel->setText(QString("运行中: %1 / %2  排队: %3")
+            .arg(active).arg(viewModel->getTaskManager()->maxConcurrent()).arg(waiting));
+    });
+    connect(RateLimiter::instance(), &RateLimiter::stateChanged, this, &MainWindow::updateRateLimitLabel);
+    connect(viewModel, &MainViewModel::batchProgress, this, &MainWindow::onBatchProgress);
+    connect(viewModel, &MainViewModel::requestCacheStatsChanged, this, [this](const RequestCacheStats &stats) {
+        useCacheCheck->setToolTip(QString("提交前查找提示词、参数和图片都相同的已完成任务，直接复用其视频\n"
+                                          "本次运行命中 %1 / %2（%3%），跳过 %4 次")
+            .arg(stats.hits).arg(stats.lookups).arg(stats.hitRate() * 100, 0, 'f', 1).arg(stats.bypassed));
+    });
 
     // 2. UI -> UI/ViewModel
     connect(generateBtn, &QPushButton::clicked, this, &MainWindow::onGenerateClicked);
     connect(taskHistoryBtn, &QPushButton::clicked, this, &MainWindow::onShowTaskHistory);
     connect(settingsBtn, &QPushButton::clicked, this, &MainWindow::onShowSettings);
+    connect(useCacheCheck, &QCheckBox::toggled, viewModel, &MainViewModel::setRequestCacheEnabled);
     connect(addParameterBtn, &QPushButton::clicked, this, [this]() {
         addParameterRow("", "");
     });
 
-    // 列表点击播放
+    // 列表点击播放（文件已被淘汰时由 ViewModel 重新下载后播放）
     connect(historyList, &QListWidget::itemClicked, this, [this](QListWidgetItem *item){
         int row = historyList->row(item);
         auto items = viewModel->getHistory();
         if(row >= 0 && row < items.size()) {
-            QString filePath = items[row].filePath;
-
-            // 检查视频文件是否存在
-            if (QFile::exists(filePath)) {
-                // 文件存在，直接播放
-                player->setSource(QUrl::fromLocalFile(filePath));
-                player->play();
-            } else {
-                // 文件不存在，尝试重新下载
-                statusLabel->setText("视频文件不存在，正在重新下载...");
-
-                // 从文件路径提取 task_id（格式：taskId_timestamp.mp4）
-                QFileInfo fileInfo(filePath);
-                QString fileName = fileInfo.fileName();
-                QString taskId = extractTaskIdFromFileName(fileName);
-
-                if (!taskId.isEmpty()) {
-                    // 从数据库查找任务
-                    TaskDatabaseService *dbService = viewModel->getTaskDatabaseService();
-                    TaskItem task = dbService->getTask(taskId);
-
-                    if (!task.taskId.isEmpty() && !task.videoUrl.isEmpty()) {
-                        // 找到任务且有视频 URL，重新下载
-                        qDebug() << "重新下载视频，Task ID:" << taskId;
-                        statusLabel->setText(QString("正在重新下载视频... (Task ID: %1)").arg(taskId));
-
-                        // 使用 ApiService 下载
-                        ApiService *downloadService = new ApiService(this);
-                        connect(downloadService, &ApiService::videoDownloaded, this, [this, taskId, filePath, downloadService](const QString &tempPath) {
-                            // 下载完成，移动到原位置
-                            QFile::remove(filePath); // 删除可能存在的旧文件
-                            if (QFile::rename(tempPath, filePath)) {
-                                statusLabel->setText("视频下载完成");
-                                player->setSource(QUrl::fromLocalFile(filePath));
-                                player->play();
-
-                                // 更新数据库
-                                TaskDatabaseService *dbService = viewModel->getTaskDatabaseService();
-                                TaskItem task = dbService->getTask(taskId);
-                                task.localFilePath = filePath;
-                                task.updateTime = QDateTime::currentDateTime();
-                                dbService->updateTask(task);
-                            } else {
-                                statusLabel->setText("视频文件移动失败");
-                            }
-                            downloadService->deleteLater();
-                        });
-
-                        connect(downloadService, &ApiService::errorOccurred, this, [this, downloadService](const QString &error) {
-                            statusLabel->setText("视频下载失败: " + error);
-                            downloadService->deleteLater();
-                        });
-
-                        downloadService->downloadVideo(task.videoUrl);
-                    } else {
-                        QMessageBox::warning(this, "提示",
-                            QString("无法重新下载视频\nTask ID: %1\n请在任务历史中重新查询该任务").arg(taskId));
-                        statusLabel->setText("视频文件不存在");
-                    }
-                } else {
-                    QMessageBox::warning(this, "提示", "无法从文件名提取 Task ID，无法重新下载");
-                    statusLabel->setText("视频文件不存在");
-                }
-            }
+            viewModel->playVideo(items[row].filePath);
         }
     });
+    connect(viewModel, &MainViewModel::playbackReady, this, [this](const QString &localPath) {
+        player->setSource(QUrl::fromLocalFile(localPath));
+        player->play();
+    });
+    connect(viewModel, &MainViewModel::playbackFailed, this, [this](const QString &msg) {
+        QMessageBox::warning(this, "提示", msg);
+        statusLabel->setText("视频文件不存在");
+    });
 
     // 初始加载历史
     viewModel->loadHistory();
@@ -231,7 +193,10 @@ void MainWindow::setupUi() {
     QVBoxLayout *parametersBoxLayout = new QVBoxLayout(parametersWidget);
     parametersBoxLayout->setContentsMargins(0, 0, 0, 0);
 
-    parametersBoxLayout->addWidget(new QLabel("参数配置:"));
+    QLabel *parametersLabel = new QLabel("参数配置:");
+    parametersLabel->setToolTip("参数值可用逗号分隔多个取值（如 seed = 1,2,3），或用 a..b 表示整数范围（如 seed = 1..8），\n"
+                                "所有取值的组合将作为一个批次提交，便于对比");
+    parametersBoxLayout->addWidget(parametersLabel);
 
     // 参数列表容器
     QScrollArea *parametersScroll = new QScrollArea;
@@ -280,6 +245,12 @@ void MainWindow::setupUi() {
     buttonsLayout->addWidget(generateBtn);
     buttonsLayout->addWidget(taskHistoryBtn);
 
+    useCacheCheck = new QCheckBox("复用相同请求的结果");
+    useCacheCheck->setChecked(viewModel->getTaskManager()->requestCacheEnabled());
+    useCacheCheck->setToolTip("提交前查找提示词、参数和图片都相同的已完成任务，直接复用其视频；\n"
+                              "取消勾选则总是重新生成（随机种子 seed = -1 的请求不会复用）");
+    buttonsLayout->addWidget(useCacheCheck);
+
     progressBar = new QProgressBar;
     progressBar->setValue(0);
     progressBar->setTextVisible(false);
@@ -288,6 +259,20 @@ void MainWindow::setupUi() {
     statusLabel->setStyleSheet("color: gray; font-size: 12px;");
     statusLabel->setAlignment(Qt::AlignCenter);
 
+    queueLabel = new QLabel(QString("运行中: 0 / %1  排队: 0").arg(viewModel->getTaskManager()->maxConcurrent()));
+    queueLabel->setStyleSheet("color: gray; font-size: 11px;");
+    queueLabel->setAlignment(Qt::AlignCenter);
+
+    rateLimitLabel = new QLabel;
+    rateLimitLabel->setStyleSheet("color: #c07000; font-size: 11px;");
+    rateLimitLabel->setAlignment(Qt::AlignCenter);
+    rateLimitLabel->hide();
+
+    batchLabel = new QLabel;
+    batchLabel->setStyleSheet("color: gray; font-size: 11px;");
+    batchLabel->setAlignment(Qt::AlignCenter);
+    batchLabel->hide();
+
     // 5. 视频播放器 (Qt6)
     videoWidget = new QVideoWidget;
     videoWidget->setMinimumHeight(200);
@@ -305,6 +290,9 @@ void MainWindow::setupUi() {
     rightLayout->addLayout(buttonsLayout);
     rightLayout->addWidget(progressBar);
     rightLayout->addWidget(statusLabel);
+    rightLayout->addWidget(queueLabel);
+    rightLayout->addWidget(rateLimitLabel);
+    rightLayout->addWidget(batchLabel);
     rightLayout->addWidget(videoWidget, 1); // 1 表示占据剩余空间
 
     // 组装整体
@@ -371,8 +359,11 @@ void MainWindow::onGenerateClicked() {
 
         // 获取用户配置的参数（图生视频也使用相同的参数配置）
         QMap<QString, QString> params = getParameters();
+        if (ParameterSweep::combinationCount(params) > 1) {
+            startSweep(key, prompt, params, imageBase64, lastImageBase64);
+            return;
+        }
 
-        generateBtn->setEnabled(false);
         statusLabel->setText("正在提交图生视频任务...");
         viewModel->startImageToVideoGeneration(key, prompt, imageBase64, lastImageBase64, params);
 
@@ -385,13 +376,61 @@ void MainWindow::onGenerateClicked() {
 
         // 获取用户配置的参数
         QMap<QString, QString> params = getParameters();
+        if (ParameterSweep::combinationCount(params) > 1) {
+            startSweep(key, prompt, params);
+            return;
+        }
 
-        generateBtn->setEnabled(false);
         statusLabel->setText("正在提交文生视频任务...");
         viewModel->startGeneration(key, prompt, params);
     }
 }
 
+void MainWindow::startSweep(const QString &key, const QString &prompt, const QMap<QString, QString> &params,
+                            const QString &imageData, const QString &lastImageData) {
+    int count = ParameterSweep::combinationCount(params);
+    if (count > ParameterSweep::MAX_COMBINATIONS) {
+        QMessageBox::warning(this, "提示", QString("参数组合超过 %1 个，请减少取值").arg(ParameterSweep::MAX_COMBINATIONS));
+        return;
+    }
+
+    QStringList varying;
+    const QMap<QString, QStringList> axes = ParameterSweep::axes(params);
+    for (auto it = axes.constBegin(); it != axes.constEnd(); ++it) {
+        if (it.value().size() > 1) {
+            varying << QString("%1 (%2)").arg(it.key()).arg(it.value().size());
+        }
+    }
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this, "参数扫描",
+        QString("将按 %1 的所有组合提交 %2 个任务，作为一个批次排队执行。是否继续？").arg(varying.join("、")).arg(count),
+        QMessageBox::Yes | QMessageBox::No);
+    if (reply != QMessageBox::Yes) {
+        return;
+    }
+
+    QString batchId = viewModel->startSweep(key, prompt, params, imageData, lastImageData);
+    if (!batchId.isEmpty()) {
+        statusLabel->setText(QString("已提交参数扫描批次 %1（%2 个任务）").arg(batchId).arg(count));
+    }
+}
+
+void MainWindow::onBatchProgress(const BatchStats &stats) {
+    qint64 seconds = stats.wallClockMs() / 1000;
+    QString text = QString("批次 %1: 完成 %2 / %3")
+        .arg(stats.batchId).arg(stats.saved).arg(stats.total);
+    if (stats.failed > 0) {
+        text += QString("，失败 %1").arg(stats.failed);
+    }
+    text += QString("  用时 %1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+    if (stats.finished() > 0) {
+        text += QString("  吞吐 %1 个/分钟").arg(stats.throughputPerMinute(), 0, 'f', 2);
+    }
+    batchLabel->setText(text);
+    batchLabel->setStyleSheet(stats.isDone() ? "color: #2e7d32; font-size: 11px;" : "color: gray; font-size: 11px;");
+    batchLabel->show();
+}
+
 void MainWindow::onVideoReady(const QString &path) {
     generateBtn->setEnabled(true);
     player->setSource(QUrl::fromLocalFile(path));
@@ -412,11 +451,14 @@ void MainWindow::onShowTaskHistory() {
     if (!taskHistoryWindow) {
         // 从 ViewModel 获取服务实例
         TaskDatabaseService *dbService = viewModel->getTaskDatabaseService();
-        ApiService *apiService = new ApiService(this); // 创建一个独立的 ApiService 用于任务历史窗口
+        // 独立的 ApiService 用于任务历史窗口（信号互不干扰），底层共享同一个网络客户端
+        ApiService *apiService = new ApiService(this);
+        apiService->setDownloadJournal(dbService);
+        apiService->setVideoStore(viewModel->getApiService()->videoStore());
 
         taskHistoryWindow = new TaskHistoryWindow(dbService, apiService, this);
 
-        // 连接 ApiService 的 taskPolled 信号到窗口
+        // 单个任务的查询经由 PollScheduler 回调；这里只接收批量查询（pollAllTasks）的结果
         connect(apiService, &ApiService::taskPolled, taskHistoryWindow, &TaskHistoryWindow::onTaskPolled);
     }
 
@@ -535,31 +577,49 @@ void MainWindow::onShowSettings() {
     settingsDialog->exec();
 }
 
+void MainWindow::updateRateLimitLabel() {
+    // 只显示被限流过或有请求在排队的桶
+    QStringList lines;
+    for (const RateLimiterState &state : RateLimiter::instance()->snapshot()) {
+        if (state.throttleEvents == 0 && state.queued == 0) {
+            continue;
+        }
+        QString line = QString("%1限流 (…%2): 排队 %3  令牌 %4  速率 %5/s  并发 %6/%7  已限流 %8 次")
+            .arg(state.endpoint, state.apiKeyTag)
+            .arg(state.queued)
+            .arg(state.tokens, 0, 'f', 1)
+            .arg(state.rate, 0, 'f', 2)
+            .arg(state.inFlight).arg(state.concurrencyLimit)
+            .arg(state.throttleEvents);
+        if (state.blockedForMs > 0) {
+            line += QString("  暂停 %1 秒").arg((state.blockedForMs + 999) / 1000);
+        }
+        lines.append(line);
+    }
+    rateLimitLabel->setText(lines.join("\n"));
+    rateLimitLabel->setVisible(!lines.isEmpty());
+}
+
 void MainWindow::onSettingsChanged() {
 
     // 重新加载 API URLs
     viewModel->getApiService()->reloadApiUrls();
 
-    statusLabel->setText("设置已更新并立即生效");
+    // 重新加载并发任务上限
+    viewModel->getTaskManager()->reloadSettings();
 
-    qDebug() << "Settings changed and reloaded";
-}
+    // 重新加载每主机连接上限
+    NetworkClient::instance()->reloadSettings();
 
-QString MainWindow::extractTaskIdFromFileName(const QString &fileName) const {
-    // 视频文件名格式：taskId_timestamp.mp4
-    // 提取 taskId（第一个下划线之前的部分）
-    int underscorePos = fileName.indexOf('_');
-    if (underscorePos > 0) {
-        return fileName.left(underscorePos);
-    }
+    // 重新加载轮询速率上限和查询 URL
+    PollScheduler::instance()->reloadSettings();
 
-    // 如果没有下划线，尝试提取 .mp4 之前的部分作为 taskId
-    int dotPos = fileName.lastIndexOf('.');
-    if (dotPos > 0) {
-        return fileName.left(dotPos);
-    }
+    // 重新加载本地视频存储的容量上限（超出时开始后台淘汰）和下载并发数、带宽上限
+    viewModel->reloadStorageSettings();
+
+    statusLabel->setText("设置已更新并立即生效");
 
-    return "";
+    qDebug() << "Settings changed and reloaded";
 }
 
 void MainWindow::onModeChanged(int index) {
@@ -612,30 +672,7 @@ void MainWindow::onSelectLastImage() {
 }
 
 QString MainWindow::imageToBase64(const QString &imagePath) const {
-    QFile file(imagePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open image file:" << imagePath;
-        return "";
-    }
-
-    QByteArray imageData = file.readAll();
-    file.close();
-
-    // 获取文件扩展名以确定 MIME 类型
-    QString extension = QFileInfo(imagePath).suffix().toLower();
-    QString mimeType = "image/jpeg";  // 默认
-
-    if (extension == "png") mimeType = "image/png";
-    else if (extension == "webp") mimeType = "image/webp";
-    else if (extension == "bmp") mimeType = "image/bmp";
-    else if (extension == "tiff" || extension == "tif") mimeType = "image/tiff";
-    else if (extension == "gif") mimeType = "image/gif";
-
-    // 返回 Base64 格式：data:image/jpeg;base64,<base64-data>
-    QString base64 = "data:" + mimeType + ";base64," + imageData.toBase64();
-
-    qDebug() << "Image converted to base64, size:" << base64.length() << "chars";
-    return base64;
+    return ImageUtils::fileToDataUri(imagePath);
 }
 
 void MainWindow::updateImagePreview(QLabel *label, const QString &imagePath) {
@@ -25,12 +25,15 @@ private slots:
     void onSelectLastImage();  // 选择尾帧图片
     void onClearFirstImage();  // 清除首帧图片
     void onClearLastImage();  // 清除尾帧图片
+    void updateRateLimitLabel();  // 刷新 API 限流状态
+    void onBatchProgress(const BatchStats &stats);  // 参数扫描批次的进度和吞吐
 
 private:
     void setupUi(); // setupUi 声明
-    QString extractTaskIdFromFileName(const QString &fileName) const; // 从文件名提取 task_id
     QString imageToBase64(const QString &imagePath) const;  // 将图片转换为 Base64
     void updateImagePreview(QLabel *label, const QString &imagePath);  // 更新图片预览
+    void startSweep(const QString &key, const QString &prompt, const QMap<QString, QString> &params,
+                    const QString &imageData = "", const QString &lastImageData = "");  // 确认后提交参数扫描批次
 
     MainViewModel *viewModel;
     TaskHistoryWindow *taskHistoryWindow;
@@ -41,9 +44,13 @@ private:
     QTextEdit *promptEdit;
     QPushButton *generateBtn;
     QPushButton *taskHistoryBtn;
+    QCheckBox *useCacheCheck;  // 相同请求复用已有结果
     QPushButton *settingsBtn;  // 新增设置按钮
     QProgressBar *progressBar;
     QLabel *statusLabel;
+    QLabel *queueLabel;  // 并发任务队列状态
+    QLabel *rateLimitLabel;  // API 限流状态（仅在限流时显示）
+    QLabel *batchLabel;  // 最近一个参数扫描批次的进度（有批次时显示）
     QVideoWidget *videoWidget;
     QMediaPlayer *player;
     QAudioOutput *audioOutput;
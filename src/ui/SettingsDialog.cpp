@@ -77,6 +77,79 @@ void SettingsDialog::setupUi() {
 
     apiEndpointGroup->setLayout(endpointLayout);
 
+    // 任务调度设置
+    QGroupBox *schedulerGroup = new QGroupBox("任务调度");
+    QHBoxLayout *schedulerLayout = new QHBoxLayout;
+
+    maxConcurrentSpin = new QSpinBox;
+    maxConcurrentSpin->setRange(1, 32);
+    maxConcurrentSpin->setValue(Config::DEFAULT_MAX_CONCURRENT_TASKS);
+    maxConcurrentSpin->setToolTip("同时提交和轮询的生成任务数，超出的任务将排队等待");
+
+    downloadSegmentsSpin = new QSpinBox;
+    downloadSegmentsSpin->setRange(1, 16);
+    downloadSegmentsSpin->setValue(Config::DEFAULT_DOWNLOAD_SEGMENTS);
+    downloadSegmentsSpin->setToolTip("大于 1 时对支持 Range 的服务器分段并行下载；1 为单连接，支持跨重启续传");
+
+    maxConnectionsSpin = new QSpinBox;
+    maxConnectionsSpin->setRange(1, 16);
+    maxConnectionsSpin->setValue(Config::DEFAULT_MAX_CONNECTIONS_PER_HOST);
+    maxConnectionsSpin->setToolTip("每个主机的 HTTP/1.1 连接上限，空闲连接会被后续请求复用");
+
+    schedulerLayout->addWidget(new QLabel("最大并发任务数:"));
+    schedulerLayout->addWidget(maxConcurrentSpin);
+    schedulerLayout->addSpacing(20);
+    schedulerLayout->addWidget(new QLabel("下载分段数:"));
+    schedulerLayout->addWidget(downloadSegmentsSpin);
+    schedulerLayout->addSpacing(20);
+    schedulerLayout->addWidget(new QLabel("每主机连接数:"));
+    schedulerLayout->addWidget(maxConnectionsSpin);
+    schedulerLayout->addStretch();
+    schedulerGroup->setLayout(schedulerLayout);
+
+    // 本地视频存储
+    QGroupBox *storageGroup = new QGroupBox("本地视频存储");
+    QHBoxLayout *storageLayout = new QHBoxLayout;
+
+    storeQuotaSpin = new QSpinBox;
+    storeQuotaSpin->setRange(0, 10000);
+    storeQuotaSpin->setSuffix(" GB");
+    storeQuotaSpin->setSpecialValueText("不限制");
+    storeQuotaSpin->setValue(Config::DEFAULT_VIDEO_STORE_QUOTA_GB);
+    storeQuotaSpin->setToolTip("超出上限时在后台逐步删除最久未播放的视频，播放时按视频 URL 自动重新下载；\n"
+                               "只删除仍有视频 URL 的视频（服务端的 URL 过期后将无法重新下载）");
+
+    storageLayout->addWidget(new QLabel("容量上限:"));
+    storageLayout->addWidget(storeQuotaSpin);
+    storageLayout->addStretch();
+    storageGroup->setLayout(storageLayout);
+
+    // 视频下载队列
+    QGroupBox *downloadGroup = new QGroupBox("视频下载");
+    QHBoxLayout *downloadLayout = new QHBoxLayout;
+
+    maxDownloadsSpin = new QSpinBox;
+    maxDownloadsSpin->setRange(1, 16);
+    maxDownloadsSpin->setValue(Config::DEFAULT_MAX_CONCURRENT_DOWNLOADS);
+    maxDownloadsSpin->setToolTip("同时进行的视频下载数，超出的按优先级排队：播放 > 新完成 > 历史补全；\n"
+                                 "播放请求不受此限制");
+
+    bandwidthSpin = new QSpinBox;
+    bandwidthSpin->setRange(0, 1000000);
+    bandwidthSpin->setSingleStep(256);
+    bandwidthSpin->setSuffix(" KB/s");
+    bandwidthSpin->setSpecialValueText("不限制");
+    bandwidthSpin->setValue(Config::DEFAULT_DOWNLOAD_BANDWIDTH_KBPS);
+    bandwidthSpin->setToolTip("所有视频下载合计的带宽上限；有高优先级下载时，低优先级的下载只使用剩余的部分");
+
+    downloadLayout->addWidget(new QLabel("最大同时下载数:"));
+    downloadLayout->addWidget(maxDownloadsSpin);
+    downloadLayout->addSpacing(20);
+    downloadLayout->addWidget(new QLabel("带宽上限:"));
+    downloadLayout->addWidget(bandwidthSpin);
+    downloadLayout->addStretch();
+    downloadGroup->setLayout(downloadLayout);
+
     // 状态标签
     statusLabel = new QLabel("");
     statusLabel->setStyleSheet("color: green; font-weight: bold;");
@@ -103,6 +176,9 @@ void SettingsDialog::setupUi() {
     // 组装主布局
     mainLayout->addWidget(apiKeyGroup);
     mainLayout->addWidget(apiEndpointGroup);
+    mainLayout->addWidget(schedulerGroup);
+    mainLayout->addWidget(storageGroup);
+    mainLayout->addWidget(downloadGroup);
     mainLayout->addWidget(statusLabel);
     mainLayout->addSpacing(10);
     mainLayout->addLayout(buttonLayout);
@@ -127,6 +203,14 @@ void SettingsDialog::loadSettings() {
     // 如果是默认值则显示为空
     submitUrlEdit->setText(submitUrl == Config::SUBMIT_URL ? "" : submitUrl);
     queryUrlEdit->setText(queryUrl == Config::QUERY_URL ? "" : queryUrl);
+
+    // 加载并发任务上限
+    maxConcurrentSpin->setValue(settings.value(Config::KEY_MAX_CONCURRENT_TASKS, Config::DEFAULT_MAX_CONCURRENT_TASKS).toInt());
+    downloadSegmentsSpin->setValue(settings.value(Config::KEY_DOWNLOAD_SEGMENTS, Config::DEFAULT_DOWNLOAD_SEGMENTS).toInt());
+    maxConnectionsSpin->setValue(settings.value(Config::KEY_MAX_CONNECTIONS_PER_HOST, Config::DEFAULT_MAX_CONNECTIONS_PER_HOST).toInt());
+    storeQuotaSpin->setValue(settings.value(Config::KEY_VIDEO_STORE_QUOTA_GB, Config::DEFAULT_VIDEO_STORE_QUOTA_GB).toInt());
+    maxDownloadsSpin->setValue(settings.value(Config::KEY_MAX_CONCURRENT_DOWNLOADS, Config::DEFAULT_MAX_CONCURRENT_DOWNLOADS).toInt());
+    bandwidthSpin->setValue(settings.value(Config::KEY_DOWNLOAD_BANDWIDTH_KBPS, Config::DEFAULT_DOWNLOAD_BANDWIDTH_KBPS).toInt());
 }
 
 void SettingsDialog::saveSettings() {
@@ -142,6 +226,13 @@ void SettingsDialog::saveSettings() {
     settings.setValue("submitUrl", submitUrl.isEmpty() ? Config::SUBMIT_URL : submitUrl);
     settings.setValue("queryUrl", queryUrl.isEmpty() ? Config::QUERY_URL : queryUrl);
 
+    settings.setValue(Config::KEY_MAX_CONCURRENT_TASKS, maxConcurrentSpin->value());
+    settings.setValue(Config::KEY_DOWNLOAD_SEGMENTS, downloadSegmentsSpin->value());
+    settings.setValue(Config::KEY_MAX_CONNECTIONS_PER_HOST, maxConnectionsSpin->value());
+    settings.setValue(Config::KEY_VIDEO_STORE_QUOTA_GB, storeQuotaSpin->value());
+    settings.setValue(Config::KEY_MAX_CONCURRENT_DOWNLOADS, maxDownloadsSpin->value());
+    settings.setValue(Config::KEY_DOWNLOAD_BANDWIDTH_KBPS, bandwidthSpin->value());
+
     qDebug() << "Settings saved";
 }
 
@@ -196,6 +287,12 @@ void SettingsDialog::onResetClicked() {
         // 清空自定义 URL
         submitUrlEdit->clear();
         queryUrlEdit->clear();
+        maxConcurrentSpin->setValue(Config::DEFAULT_MAX_CONCURRENT_TASKS);
+        downloadSegmentsSpin->setValue(Config::DEFAULT_DOWNLOAD_SEGMENTS);
+        maxConnectionsSpin->setValue(Config::DEFAULT_MAX_CONNECTIONS_PER_HOST);
+        storeQuotaSpin->setValue(Config::DEFAULT_VIDEO_STORE_QUOTA_GB);
+        maxDownloadsSpin->setValue(Config::DEFAULT_MAX_CONCURRENT_DOWNLOADS);
+        bandwidthSpin->setValue(Config::DEFAULT_DOWNLOAD_BANDWIDTH_KBPS);
 
         statusLabel->setText("已重置为默认值（未保存）");
         statusLabel->setStyleSheet("color: orange; font-weight: bold;");
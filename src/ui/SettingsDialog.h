@@ -32,6 +32,12 @@ private:
     QLineEdit *apiKeyEdit;
     QLineEdit *submitUrlEdit;
     QLineEdit *queryUrlEdit;
+    QSpinBox *maxConcurrentSpin;
+    QSpinBox *downloadSegmentsSpin;
+    QSpinBox *maxConnectionsSpin;
+    QSpinBox *storeQuotaSpin;
+    QSpinBox *maxDownloadsSpin;
+    QSpinBox *bandwidthSpin;
     QPushButton *saveBtn;
     QPushButton *cancelBtn;
     QPushButton *resetBtn;
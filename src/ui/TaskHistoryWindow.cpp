@@ -1,6 +1,9 @@
 #include "TaskHistoryWindow.h"
+#include "TaskListModel.h"
 #include "services/TaskDatabaseService.h"
 #include "services/ApiService.h"
+#include "services/PollScheduler.h"
+#include "services/VideoStore.h"
 #include "const/AppConfig.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -9,9 +12,6 @@
 #include <QSplitter>
 #include <QGroupBox>
 #include <QSettings>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QNetworkRequest>
 #include <QDesktopServices>
 #include <QUrl>
 #include <QFileInfo>
@@ -31,6 +31,16 @@ TaskHistoryWindow::TaskHistoryWindow(TaskDatabaseService *dbService, ApiService
         apiKeyInput->setText(savedApiKey);
     }
 
+    // 数据库读写都在数据库线程中进行，结果返回后再更新表格
+    reloadTimer = new QTimer(this);
+    reloadTimer->setSingleShot(true);
+    reloadTimer->setInterval(RELOAD_DELAY_MS);
+    connect(reloadTimer, &QTimer::timeout, this, &TaskHistoryWindow::loadTasks);
+    pollFlushTimer = new QTimer(this);
+    pollFlushTimer->setSingleShot(true);
+    pollFlushTimer->setInterval(POLL_FLUSH_DELAY_MS);
+    connect(pollFlushTimer, &QTimer::timeout, this, &TaskHistoryWindow::flushPollResults);
+
     loadTasks();
 
     // 自动重试查询失败的任务
@@ -40,6 +50,32 @@ TaskHistoryWindow::TaskHistoryWindow(TaskDatabaseService *dbService, ApiService
     autoRefreshTimer = new QTimer(this);
     connect(autoRefreshTimer, &QTimer::timeout, this, &TaskHistoryWindow::onAutoRefreshTimeout);
     autoRefreshTimer->start(30000);  // 30秒
+
+    // 下载队列：排队变化时立即刷新，有下载进行时每秒刷新速率和进度
+    downloadQueueTimer = new QTimer(this);
+    downloadQueueTimer->setInterval(1000);
+    connect(downloadQueueTimer, &QTimer::timeout, this, &TaskHistoryWindow::refreshDownloadQueue);
+    connect(DownloadScheduler::instance(), &DownloadScheduler::queueChanged, this, &TaskHistoryWindow::refreshDownloadQueue);
+    refreshDownloadQueue();
+
+    // 下载结果
+    connect(apiService, &ApiService::videoDownloadedForTask, this, [this](const QString &taskId, const QString &localPath) {
+        qDebug() << "Video downloaded successfully to:" << localPath;
+        onVideoDownloadedForTask(taskId, localPath);
+        statusLabel->setText("视频已下载: " + taskId);
+    });
+    connect(apiService, &ApiService::downloadFailed, this, [this](const QString &taskId, const QString &error) {
+        qDebug() << "Download failed for task" << taskId << ":" << error;
+        statusLabel->setText("下载失败: " + taskId);
+    });
+
+    // 监听下载进度
+    connect(apiService, &ApiService::downloadProgress, this, [this](const QString &taskId, qint64 bytesReceived, qint64 bytesTotal) {
+        if (bytesTotal > 0) {
+            int percent = (bytesReceived * 100) / bytesTotal;
+            statusLabel->setText(QString("下载中 %1: %2%").arg(taskId).arg(percent));
+        }
+    });
 }
 
 TaskHistoryWindow::~TaskHistoryWindow() {
@@ -88,20 +124,36 @@ void TaskHistoryWindow::setupUi() {
 
     mainLayout->addLayout(toolbarLayout);
 
+    downloadQueueLabel = new QLabel(this);
+    downloadQueueLabel->setStyleSheet("color: gray;");
+    downloadQueueLabel->setToolTip("视频下载按优先级排队：播放 > 新完成 > 补全；并发数和带宽上限可在设置中调整");
+    mainLayout->addWidget(downloadQueueLabel);
+
     // 使用分割器布局任务列表和详情
     QSplitter *splitter = new QSplitter(Qt::Horizontal, this);
 
-    // 任务列表表格
-    taskTable = new QTableWidget(this);
-    taskTable->setColumnCount(6);
-    taskTable->setHorizontalHeaderLabels({"任务ID", "提示词", "状态", "创建时间", "完成时间", "视频URL"});
+    // 任务列表表格：模型按页从数据库读取，只缓存最近显示的页
+    taskModel = new TaskListModel(dbService, this);
+    taskTable = new QTableView(this);
+    taskTable->setModel(taskModel);
     taskTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     taskTable->setSelectionMode(QAbstractItemView::SingleSelection);
     taskTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     taskTable->horizontalHeader()->setStretchLastSection(true);
+    // 固定行高：视图不必逐行计算高度，行数很多时滚动条和跳转仍然是常数开销
+    taskTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    taskTable->verticalHeader()->setDefaultSectionSize(taskTable->fontMetrics().height() + 8);
+    // 只能按创建时间排序（有索引）；点击其他列时恢复原来的排序列
+    taskTable->horizontalHeader()->setSortIndicator(TaskListModel::CreateTimeColumn, Qt::DescendingOrder);
+    taskTable->setSortingEnabled(true);
+    connect(taskTable->horizontalHeader(), &QHeaderView::sortIndicatorChanged, this, [this](int column) {
+        if (column != TaskListModel::CreateTimeColumn) {
+            taskTable->horizontalHeader()->setSortIndicator(TaskListModel::CreateTimeColumn, taskModel->sortOrder());
+        }
+    });
     taskTable->setColumnWidth(0, 200);
     taskTable->setColumnWidth(1, 250);
-    taskTable->setColumnWidth(2, 80);
+    taskTable->setColumnWidth(2, 120);
     taskTable->setColumnWidth(3, 150);
     taskTable->setColumnWidth(4, 150);
 
@@ -121,63 +173,43 @@ void TaskHistoryWindow::setupUi() {
     mainLayout->addWidget(splitter);
 
     // 连接信号
-    connect(taskTable, &QTableWidget::itemSelectionChanged, this, &TaskHistoryWindow::onTableItemSelectionChanged);
-    connect(taskTable, &QTableWidget::itemDoubleClicked, this, &TaskHistoryWindow::onTableItemDoubleClicked);
+    connect(taskTable->selectionModel(), &QItemSelectionModel::selectionChanged, this, &TaskHistoryWindow::onTableItemSelectionChanged);
+    connect(taskTable, &QTableView::doubleClicked, this, &TaskHistoryWindow::onTableItemDoubleClicked);
+    // 重新加载时选中的行随模型重置而消失，不会发出 selectionChanged
+    connect(taskModel, &QAbstractItemModel::modelReset, this, [this]() {
+        currentSelectedTaskId.clear();
+        detailsText->clear();
+        deleteBtn->setEnabled(false);
+    });
     connect(refreshBtn, &QPushButton::clicked, this, &TaskHistoryWindow::onRefreshClicked);
     connect(deleteBtn, &QPushButton::clicked, this, &TaskHistoryWindow::onDeleteClicked);
     connect(queryByIdBtn, &QPushButton::clicked, this, &TaskHistoryWindow::onQueryByTaskId);
 }
 
 void TaskHistoryWindow::loadTasks() {
-    currentTasks = dbService->getAllTasks();
-
-    taskTable->setRowCount(0);
+    reloadTimer->stop();
+    taskModel->reload();
+    dbService->countTasksAsync().then(this, [this](int count) {
+        totalTasks = count;
+        statusLabel->setText(QString("共 %1 个任务").arg(count));
+    });
+}
 
-    for (int i = 0; i < currentTasks.size(); ++i) {
-        const TaskItem &task = currentTasks[i];
-        taskTable->insertRow(i);
-        updateTaskRow(i, task);
+void TaskHistoryWindow::scheduleReload() {
+    if (!reloadTimer->isActive()) {
+        reloadTimer->start();
     }
-
-    statusLabel->setText(QString("共 %1 个任务").arg(currentTasks.size()));
 }
 
-void TaskHistoryWindow::updateTaskRow(int row, const TaskItem &task) {
-    taskTable->setItem(row, 0, new QTableWidgetItem(task.taskId));
-
-    // 截断过长的提示词
-    QString promptPreview = task.prompt;
-    if (promptPreview.length() > 30) {
-        promptPreview = promptPreview.left(30) + "...";
-    }
-    taskTable->setItem(row, 1, new QTableWidgetItem(promptPreview));
-
-    // 状态带颜色
-    QTableWidgetItem *statusItem = new QTableWidgetItem(task.statusString());
-    switch(task.status) {
-        case TaskStatus::Completed:
-            statusItem->setForeground(Qt::darkGreen);
-            break;
-        case TaskStatus::Failed:
-            statusItem->setForeground(Qt::red);
-            break;
-        case TaskStatus::Processing:
-            statusItem->setForeground(Qt::blue);
-            break;
-        default:
-            statusItem->setForeground(Qt::gray);
-    }
-    taskTable->setItem(row, 2, statusItem);
-
-    taskTable->setItem(row, 3, new QTableWidgetItem(task.createTime.toString("yyyy-MM-dd HH:mm:ss")));
-
-    QString completeTimeStr = task.completeTime.isValid() ?
-        task.completeTime.toString("yyyy-MM-dd HH:mm:ss") : "-";
-    taskTable->setItem(row, 4, new QTableWidgetItem(completeTimeStr));
-
-    QString videoUrlPreview = task.videoUrl.isEmpty() ? "-" :
-        (task.videoUrl.length() > 40 ? task.videoUrl.left(40) + "..." : task.videoUrl);
-    taskTable->setItem(row, 5, new QTableWidgetItem(videoUrlPreview));
+void TaskHistoryWindow::replaceTask(const TaskItem &task) {
+    if (!taskModel->updateTask(TaskSummary::fromTask(task))) {
+        // 列表中还没有该任务（如刚通过 Task ID 查询）：重新读取
+        scheduleReload();
+        return;
+    }
+    if (currentSelectedTaskId == task.taskId) {
+        showTaskDetails(task);
+    }
 }
 
 void TaskHistoryWindow::showTaskDetails(const TaskItem &task) {
@@ -218,6 +250,10 @@ void TaskHistoryWindow::showTaskDetails(const TaskItem &task) {
         details += "更新时间: " + task.updateTime.toString("yyyy-MM-dd HH:mm:ss") + "\n";
     }
 
+    if (task.submitLatencyMs > 0) {
+        details += QString("提交: %1 次尝试，耗时 %2 毫秒\n").arg(task.submitAttempts).arg(task.submitLatencyMs);
+    }
+
     if (task.completeTime.isValid()) {
         details += "完成时间: " + task.completeTime.toString("yyyy-MM-dd HH:mm:ss") + "\n";
         int elapsedSeconds = task.createTime.secsTo(task.completeTime);
@@ -232,6 +268,11 @@ void TaskHistoryWindow::showTaskDetails(const TaskItem &task) {
     if (!task.videoUrl.isEmpty()) {
         details += "\n---------- 视频信息 ----------\n";
         details += "视频URL: " + task.videoUrl + "\n";
+        if (task.videoUrlExpires.isValid()) {
+            bool expired = task.videoUrlExpires <= QDateTime::currentDateTimeUtc();
+            details += QString("URL 有效期至: %1%2\n")
+                .arg(task.videoUrlExpires.toLocalTime().toString("yyyy-MM-dd HH:mm:ss"), expired ? "（已过期）" : "");
+        }
     }
 
     if (!task.localFilePath.isEmpty()) {
@@ -239,16 +280,72 @@ void TaskHistoryWindow::showTaskDetails(const TaskItem &task) {
     }
 
     detailsText->setText(details);
+
+    if (!task.batchId.isEmpty()) {
+        // 批次对比读取返回时仍选中该任务才追加
+        dbService->getBatchTasksAsync(task.batchId).then(this, [this, task, details](const QList<TaskItem> &siblings) {
+            if (currentSelectedTaskId == task.taskId) {
+                detailsText->setText(details + batchComparison(task, siblings));
+            }
+        });
+    }
+}
+
+QString TaskHistoryWindow::batchComparison(const TaskItem &task, const QList<TaskItem> &siblings) {
+    if (siblings.isEmpty()) {
+        return QString();
+    }
+
+    QString text = "\n---------- 批次对比 ----------\n";
+    text += "批次: " + task.batchId + "\n";
+
+    // 批次用时：最早创建到最晚完成
+    QDateTime firstCreate;
+    QDateTime lastComplete;
+    int completed = 0;
+    for (const TaskItem &item : siblings) {
+        if (!firstCreate.isValid() || item.createTime < firstCreate) {
+            firstCreate = item.createTime;
+        }
+        if (item.completeTime.isValid()) {
+            completed++;
+            if (!lastComplete.isValid() || item.completeTime > lastComplete) {
+                lastComplete = item.completeTime;
+            }
+        }
+        QString mark = item.taskId == task.taskId ? "▶ " : "  ";
+        QString elapsed = item.completeTime.isValid()
+            ? QString("%1 秒").arg(item.createTime.secsTo(item.completeTime)) : "-";
+        text += QString("%1seed %2 | %3 秒 | %4 | 固定相机 %5 | %6 | %7\n")
+            .arg(mark).arg(item.seed).arg(item.duration).arg(item.resolution)
+            .arg(item.cameraFixed ? "是" : "否").arg(item.statusString(), elapsed);
+    }
+
+    text += QString("完成 %1 / %2").arg(completed).arg(siblings.size());
+    if (lastComplete.isValid()) {
+        qint64 seconds = firstCreate.secsTo(lastComplete);
+        text += QString("，批次用时 %1 分 %2 秒").arg(seconds / 60).arg(seconds % 60);
+        if (seconds > 0) {
+            text += QString("，吞吐 %1 个/分钟").arg(completed * 60.0 / seconds, 0, 'f', 2);
+        }
+    }
+    return text + "\n";
 }
 
 void TaskHistoryWindow::onTableItemSelectionChanged() {
-    QList<QTableWidgetItem*> selected = taskTable->selectedItems();
+    QModelIndexList selected = taskTable->selectionModel()->selectedRows();
     if (!selected.isEmpty()) {
-        int row = taskTable->row(selected.first());
-        if (row >= 0 && row < currentTasks.size()) {
-            currentSelectedTaskId = currentTasks[row].taskId;
-            showTaskDetails(currentTasks[row]);
+        const TaskSummary *summary = taskModel->taskAt(selected.first().row());
+        if (summary) {
+            QString taskId = summary->taskId;
+            currentSelectedTaskId = taskId;
             deleteBtn->setEnabled(true);
+            // 列表只有摘要列，详情读取完整的任务；返回时仍选中该任务才显示
+            dbService->getTaskAsync(taskId).then(this, [this, taskId](const TaskItem &task) {
+                if (currentSelectedTaskId == taskId && !task.taskId.isEmpty()) {
+                    showTaskDetails(task);
+                }
+            });
         }
     } else {
         currentSelectedTaskId.clear();
@@ -257,17 +354,13 @@ void TaskHistoryWindow::onTableItemSelectionChanged() {
     }
 }
 
-void TaskHistoryWindow::onTableItemDoubleClicked(QTableWidgetItem *item) {
-    if (!item) {
-        return;
-    }
-
-    int row = taskTable->row(item);
-    if (row < 0 || row >= currentTasks.size()) {
+void TaskHistoryWindow::onTableItemDoubleClicked(const QModelIndex &index) {
+    const TaskSummary *summary = taskModel->taskAt(index.row());
+    if (!summary) {
         return;
     }
 
-    const TaskItem &task = currentTasks[row];
+    TaskSummary task = *summary;
 
     // 检查本地文件路径
     if (task.localFilePath.isEmpty()) {
@@ -279,6 +372,12 @@ void TaskHistoryWindow::onTableItemDoubleClicked(QTableWidgetItem *item) {
 
     // 检查文件是否存在
     QFileInfo fileInfo(task.localFilePath);
+    if (!fileInfo.exists() && !task.videoUrl.isEmpty()) {
+        // 已被本地存储的容量上限淘汰（或被删除）：重新下载，完成后可再次打开
+        statusLabel->setText("本地视频已被清理，正在重新下载: " + task.taskId);
+        downloadVideoForTask(task.taskId, task.videoUrl, DownloadScheduler::Priority::Playback);
+        return;
+    }
     if (!fileInfo.exists()) {
         QMessageBox::warning(this, "文件不存在",
             "本地视频文件不存在：\n" + task.localFilePath + "\n\n"
@@ -296,6 +395,7 @@ void TaskHistoryWindow::onTableItemDoubleClicked(QTableWidgetItem *item) {
             "文件路径: " + task.localFilePath);
     } else {
         qDebug() << "Opening video with system player:" << task.localFilePath;
+        dbService->markVideoPlayedAsync(task.localFilePath);
         statusLabel->setText("已打开视频: " + task.taskId);
     }
 }
@@ -310,16 +410,17 @@ void TaskHistoryWindow::refreshTasks() {
     // 重新加载所有任务
     loadTasks();
 
-    // 轮询未完成的任务
-    QList<TaskItem> pendingTasks = dbService->getPendingTasks();
-    if (!pendingTasks.isEmpty()) {
-        statusLabel->setText(QString("正在轮询 %1 个未完成任务...").arg(pendingTasks.size()));
-        for (const TaskItem &task : pendingTasks) {
-            pollPendingTask(task);
+    // 轮询未完成的任务（在上面的读取之后返回，此时 totalTasks 已更新）
+    dbService->getPendingTasksAsync().then(this, [this](const QList<PendingTask> &pendingTasks) {
+        if (!pendingTasks.isEmpty()) {
+            statusLabel->setText(QString("正在轮询 %1 个未完成任务...").arg(pendingTasks.size()));
+            for (const PendingTask &task : pendingTasks) {
+                pollPendingTask(task.apiKey, task.taskId, PollScheduler::Priority::Background);
+            }
+        } else {
+            statusLabel->setText(QString("共 %1 个任务，无待处理任务").arg(totalTasks));
         }
-    } else {
-        statusLabel->setText(QString("共 %1 个任务，无待处理任务").arg(currentTasks.size()));
-    }
+    });
 }
 
 void TaskHistoryWindow::onDeleteClicked() {
@@ -332,65 +433,107 @@ void TaskHistoryWindow::onDeleteClicked() {
         QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        if (dbService->deleteTask(currentSelectedTaskId)) {
-            QMessageBox::information(this, "成功", "任务已删除");
-            loadTasks();
-        } else {
-            QMessageBox::warning(this, "错误", "删除任务失败");
-        }
+        dbService->deleteTaskAsync(currentSelectedTaskId).then(this, [this](bool deleted) {
+            if (deleted) {
+                QMessageBox::information(this, "成功", "任务已删除");
+                loadTasks();
+            } else {
+                QMessageBox::warning(this, "错误", "删除任务失败");
+            }
+        });
     }
 }
 
 void TaskHistoryWindow::onAutoRefreshTimeout() {
     // 自动刷新未完成的任务
-    QList<TaskItem> pendingTasks = dbService->getPendingTasks();
-    if (!pendingTasks.isEmpty()) {
-        qDebug() << "Auto refreshing" << pendingTasks.size() << "pending tasks";
-        for (const TaskItem &task : pendingTasks) {
-            pollPendingTask(task);
+    dbService->getPendingTasksAsync().then(this, [this](const QList<PendingTask> &pendingTasks) {
+        if (!pendingTasks.isEmpty()) {
+            qDebug() << "Auto refreshing" << pendingTasks.size() << "pending tasks";
+            for (const PendingTask &task : pendingTasks) {
+                pollPendingTask(task.apiKey, task.taskId, PollScheduler::Priority::Background);
+            }
         }
-    }
+    });
 }
 
-void TaskHistoryWindow::pollPendingTask(const TaskItem &task) {
-    // 连接 ApiService 的轮询信号（需要修改 ApiService）
-    // 这里暂时使用简化方式
-    apiService->pollTask(task.apiKey, task.taskId);
+void TaskHistoryWindow::pollPendingTask(const QString &apiKey, const QString &taskId, PollScheduler::Priority priority) {
+    // 经由全局调度器查询：与其他窗口对同一任务的查询合并，并受全局速率限制
+    PollScheduler::instance()->poll(apiKey, taskId, this, [this](const PollResult &result) {
+        onTaskPolled(result.taskId, result.success, result.videoUrl, result.error, result.failed);
+    }, priority);
 }
 
-void TaskHistoryWindow::onTaskPolled(const QString &taskId, bool success, const QString &videoUrl, const QString &error) {
-    TaskItem task = dbService->getTask(taskId);
-    if (task.taskId.isEmpty()) {
-        return;
+void TaskHistoryWindow::onTaskPolled(const QString &taskId, bool success, const QString &videoUrl, const QString &error,
+                                     bool failed) {
+    // 一轮刷新的结果陆续到达（批量查询则同时到达），收集后在一个事务中写入
+    PollResult result;
+    result.taskId = taskId;
+    result.success = success;
+    result.videoUrl = videoUrl;
+    result.error = error;
+    result.failed = failed;
+    polledResults.insert(taskId, result);
+    if (!pollFlushTimer->isActive()) {
+        pollFlushTimer->start();
     }
+}
 
-    task.updateTime = QDateTime::currentDateTime();
+void TaskHistoryWindow::flushPollResults() {
+    const QList<PollResult> results = polledResults.values();
+    polledResults.clear();
+
+    // 读-改-写在数据库线程中完成；界面只更新这些任务所在的行，不重新读取全部任务
+    dbService->run([results](TaskDatabase &db) {
+        QList<TaskItem> updated;
+        db.transaction([&]() {
+            for (const PollResult &result : results) {
+                // 网络错误或未知状态不代表任务结束，保持原状态，下次刷新再查
+                if (!result.success && !result.failed && !result.isPending()) {
+                    continue;
+                }
+                TaskItem task = db.getTask(result.taskId);
+                if (task.taskId.isEmpty()) {
+                    continue;
+                }
+
+                task.updateTime = QDateTime::currentDateTime();
+
+                if (result.success) {
+                    task.status = TaskStatus::Completed;
+                    task.videoUrl = result.videoUrl;
+                    task.completeTime = QDateTime::currentDateTime();
+                } else if (result.failed) {
+                    task.status = TaskStatus::Failed;
+                    task.errorMessage = result.error;
+                    task.completeTime = QDateTime::currentDateTime();
+                } else {
+                    // 仍在处理中
+                    task.status = TaskStatus::Processing;
+                }
+
+                if (!db.updateTask(task)) {
+                    updated.clear();
+                    return false;
+                }
+                updated.append(task);
+            }
+            return true;
+        });
+        return updated;
+    }).then(this, [this](const QList<TaskItem> &updated) {
+        for (const TaskItem &task : updated) {
+            // 如果有视频 URL 但没有本地文件，自动下载
+            if (task.status == TaskStatus::Completed && !task.videoUrl.isEmpty() && task.localFilePath.isEmpty()) {
+                qDebug() << "Auto downloading video for task:" << task.taskId;
+                downloadVideoForTask(task.taskId, task.videoUrl, DownloadScheduler::Priority::Backfill);
+            }
 
-    if (success) {
-        task.status = TaskStatus::Completed;
-        task.videoUrl = videoUrl;
-        task.completeTime = QDateTime::currentDateTime();
+            // 刷新显示
+            replaceTask(task);
 
-        // 如果有视频 URL 但没有本地文件，自动下载
-        if (!videoUrl.isEmpty() && task.localFilePath.isEmpty()) {
-            qDebug() << "Auto downloading video for task:" << taskId;
-            downloadVideoForTask(taskId, videoUrl);
+            emit taskStatusChanged(task.taskId);
         }
-    } else if (!error.isEmpty() && error != "STATUS_PROCESSING") {
-        task.status = TaskStatus::Failed;
-        task.errorMessage = error;
-        task.completeTime = QDateTime::currentDateTime();
-    } else {
-        // 仍在处理中
-        task.status = TaskStatus::Processing;
-    }
-
-    dbService->updateTask(task);
-
-    // 刷新显示
-    loadTasks();
-
-    emit taskStatusChanged(taskId);
+    });
 }
 
 void TaskHistoryWindow::onQueryByTaskId() {
@@ -421,29 +564,35 @@ void TaskHistoryWindow::onQueryByTaskId() {
 
     // 如果有 Task ID，查询单个任务
     // 检查是否已存在
-    TaskItem existingTask = dbService->getTask(taskId);
-    if (!existingTask.taskId.isEmpty()) {
-        auto reply = QMessageBox::question(this, "任务已存在",
-            "该 Task ID 已存在于数据库中，是否重新查询更新状态？",
-            QMessageBox::Yes | QMessageBox::No);
-
-        if (reply == QMessageBox::No) {
-            return;
+    dbService->getTaskAsync(taskId).then(this, [this, taskId, apiKey](const TaskItem &existingTask) {
+        if (!existingTask.taskId.isEmpty()) {
+            auto reply = QMessageBox::question(this, "任务已存在",
+                "该 Task ID 已存在于数据库中，是否重新查询更新状态？",
+                QMessageBox::Yes | QMessageBox::No);
+
+            if (reply == QMessageBox::No) {
+                return;
+            }
         }
-    }
+        queryTaskById(taskId, apiKey);
+    });
+}
 
+void TaskHistoryWindow::queryTaskById(const QString &taskId, const QString &apiKey) {
     statusLabel->setText("正在查询 Task ID: " + taskId);
     queryByIdBtn->setEnabled(false);
 
     // 调用 API 查询任务状态
-    apiService->pollTask(apiKey, taskId);
+    pollPendingTask(apiKey, taskId, PollScheduler::Priority::Interactive);
 
     // 监听查询结果
     QTimer::singleShot(5000, this, [this, taskId, apiKey]() {
-        TaskItem task = dbService->getTask(taskId);
-
-        // 如果是新任务（不存在），创建一个新记录
-        if (task.taskId.isEmpty()) {
+        dbService->run([=](TaskDatabase &db) {
+            // 如果是新任务（不存在），创建一个新记录
+            if (!db.getTask(taskId).taskId.isEmpty()) {
+                return;
+            }
+            TaskItem task;
             task.taskId = taskId;
             task.prompt = "";  // 通过 task_id 查询的，prompt 为空
             task.apiKey = apiKey;
@@ -460,8 +609,8 @@ void TaskHistoryWindow::onQueryByTaskId() {
             task.cameraFixed = false;
             task.seed = 0;
 
-            dbService->saveTask(task);
-        }
+            db.saveTask(task);
+        });
 
         loadTasks();
         statusLabel->setText("查询完成");
@@ -469,127 +618,136 @@ void TaskHistoryWindow::onQueryByTaskId() {
     });
 }
 
-void TaskHistoryWindow::downloadVideoForTask(const QString &taskId, const QString &videoUrl) {
+void TaskHistoryWindow::downloadVideoForTask(const QString &taskId, const QString &videoUrl,
+                                             DownloadScheduler::Priority priority) {
     if (videoUrl.isEmpty()) {
         qDebug() << "Video URL is empty for task:" << taskId;
         return;
     }
 
-    // 创建保存目录
-    QString saveDir = QStandardPaths::writableLocation(QStandardPaths::MoviesLocation) + "/I See";
-    QDir dir;
-    if (!dir.exists(saveDir)) {
-        dir.mkpath(saveDir);
+    // 已在下载队列中（本窗口或生成任务发起）时只提升优先级，不重复下载
+    if (DownloadScheduler::instance()->promote(taskId, priority)) {
+        return;
     }
 
-    // 生成文件名：taskId_timestamp.mp4
-    QString fileName = taskId + "_" + QString::number(QDateTime::currentSecsSinceEpoch()) + ".mp4";
-    QString localPath = saveDir + "/" + fileName;
+    // 与生成任务相同，下载到视频存储（位于设置的保存目录下），完成后按内容去重
+    QString localPath = apiService->videoStore()->incomingPath(taskId);
 
     qDebug() << "Downloading video from:" << videoUrl;
     qDebug() << "Saving to:" << localPath;
 
-    // 创建 QNetworkAccessManager 进行下载
-    QNetworkAccessManager *downloadManager = new QNetworkAccessManager(this);
-    QNetworkRequest request{QUrl(videoUrl)};
-    QNetworkReply *reply = downloadManager->get(request);
-
-    connect(reply, &QNetworkReply::finished, this, [=, this]() {
-        reply->deleteLater();
-        downloadManager->deleteLater();
+    // 经由共享网络客户端下载，数据流式写入暂存文件，结果通过 ApiService 的按任务信号返回
+    apiService->downloadVideo(videoUrl, localPath, taskId, priority);
+}
 
-        if (reply->error()) {
-            qDebug() << "Download failed for task" << taskId << ":" << reply->errorString();
-            statusLabel->setText("下载失败: " + taskId);
-            return;
+void TaskHistoryWindow::refreshDownloadQueue() {
+    DownloadScheduler *scheduler = DownloadScheduler::instance();
+    downloadEntries.clear();
+    for (const DownloadScheduler::Entry &entry : scheduler->snapshot()) {
+        if (!entry.taskId.isEmpty()) {
+            downloadEntries.insert(entry.taskId, entry);
         }
+    }
 
-        // 保存文件
-        QFile file(localPath);
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write(reply->readAll());
-            file.close();
+    int active = scheduler->activeCount();
+    QString text = QString("下载: 进行中 %1/%2 | 排队 播放 %3 · 新完成 %4 · 补全 %5")
+        .arg(active).arg(scheduler->maxConcurrent())
+        .arg(scheduler->queuedCount(DownloadScheduler::Priority::Playback))
+        .arg(scheduler->queuedCount(DownloadScheduler::Priority::Fresh))
+        .arg(scheduler->queuedCount(DownloadScheduler::Priority::Backfill));
+    text += QString(" | %1 KB/s").arg(scheduler->bytesPerSecond() / 1024.0, 0, 'f', 0);
+    if (scheduler->bandwidthLimit() > 0) {
+        text += QString("（上限 %1 KB/s）").arg(scheduler->bandwidthLimit() / 1024);
+    }
+    DownloadStats stats = scheduler->stats();
+    if (stats.urlRefreshes > 0 || stats.missedWindow > 0) {
+        text += QString(" | URL 换新 %1 次，过期未下载 %2 个").arg(stats.urlRefreshes).arg(stats.missedWindow);
+    }
+    downloadQueueLabel->setText(text);
 
-            qDebug() << "Video downloaded successfully to:" << localPath;
-            onVideoDownloadedForTask(taskId, localPath);
-            statusLabel->setText("视频已下载: " + taskId);
-        } else {
-            qDebug() << "Failed to open file for writing:" << localPath;
-            statusLabel->setText("保存失败: " + taskId);
-        }
-    });
+    if (downloadEntries.isEmpty() && active == 0) {
+        downloadQueueTimer->stop();
+    } else if (!downloadQueueTimer->isActive()) {
+        downloadQueueTimer->start();
+    }
 
-    // 监听下载进度
-    connect(reply, &QNetworkReply::downloadProgress, this, [=](qint64 bytesReceived, qint64 bytesTotal) {
-        if (bytesTotal > 0) {
-            int percent = (bytesReceived * 100) / bytesTotal;
-            statusLabel->setText(QString("下载中 %1: %2%").arg(taskId).arg(percent));
-        }
-    });
+    // 只更新状态列的文字，不重新读取任务
+    QHash<QString, QString> statusTexts;
+    for (auto it = downloadEntries.constBegin(); it != downloadEntries.constEnd(); ++it) {
+        statusTexts.insert(it.key(), downloadStatusText(it.value()));
+    }
+    taskModel->setStatusOverrides(statusTexts);
+}
+
+QString TaskHistoryWindow::downloadStatusText(const DownloadScheduler::Entry &entry) {
+    if (entry.refreshing) {
+        return "等待新的视频 URL";
+    }
+    if (!entry.active) {
+        return QString("等待下载（%1）").arg(DownloadScheduler::priorityName(entry.priority));
+    }
+    if (entry.bytesTotal > 0) {
+        return QString("下载中 %1%").arg(entry.bytesReceived * 100 / entry.bytesTotal);
+    }
+    return "下载中";
 }
 
 void TaskHistoryWindow::onVideoDownloadedForTask(const QString &taskId, const QString &localPath) {
     // 更新数据库中的本地文件路径
-    TaskItem task = dbService->getTask(taskId);
-    if (!task.taskId.isEmpty()) {
-        task.localFilePath = localPath;
-        task.updateTime = QDateTime::currentDateTime();
-        dbService->updateTask(task);
-
-        qDebug() << "Updated task" << taskId << "with local path:" << localPath;
-
-        // 刷新显示
-        loadTasks();
-
-        // 如果当前选中的是这个任务，刷新详情
-        if (currentSelectedTaskId == taskId) {
-            showTaskDetails(task);
+    dbService->run([=](TaskDatabase &db) {
+        TaskItem task = db.getTask(taskId);
+        if (!task.taskId.isEmpty()) {
+            task.localFilePath = localPath;
+            task.updateTime = QDateTime::currentDateTime();
+            db.updateTask(task);
         }
-    }
+        return task;
+    }).then(this, [this, localPath](const TaskItem &task) {
+        if (task.taskId.isEmpty()) {
+            return;
+        }
+        qDebug() << "Updated task" << task.taskId << "with local path:" << localPath;
+
+        // 刷新显示（当前选中的是这个任务时一并刷新详情）
+        replaceTask(task);
+    });
 }
 
 void TaskHistoryWindow::retryFailedTasks() {
-    // 获取所有失败的任务（包括超时的）
-    QList<TaskItem> allTasks = dbService->getAllTasks();
-    QList<TaskItem> failedTasks;
-
-    for (const TaskItem &task : allTasks) {
-        if (task.status == TaskStatus::Failed) {
-            // 检查是否是查询超时导致的失败
-            if (task.errorMessage.contains("超时") || task.errorMessage.contains("timeout")) {
+    // 在数据库线程中找出查询超时而失败的任务，并将其状态改为处理中
+    dbService->run([](TaskDatabase &db) {
+        QList<TaskItem> failedTasks;
+        for (const TaskItem &task : db.getAllTasks()) {
+            if (task.status == TaskStatus::Failed && !task.apiKey.isEmpty()
+                && (task.errorMessage.contains("超时") || task.errorMessage.contains("timeout"))) {
+                TaskItem updatedTask = task;
+                updatedTask.status = TaskStatus::Processing;
+                updatedTask.errorMessage = ""; // 清除错误信息
+                updatedTask.updateTime = QDateTime::currentDateTime();
+                db.updateTask(updatedTask);
                 failedTasks.append(task);
             }
         }
-    }
-
-    if (failedTasks.isEmpty()) {
-        qDebug() << "No failed tasks to retry";
-        return;
-    }
+        return failedTasks;
+    }).then(this, [this](const QList<TaskItem> &failedTasks) {
+        if (failedTasks.isEmpty()) {
+            qDebug() << "No failed tasks to retry";
+            return;
+        }
 
-    qDebug() << "Found" << failedTasks.size() << "failed tasks, retrying...";
-    statusLabel->setText(QString("正在重试 %1 个失败任务...").arg(failedTasks.size()));
+        qDebug() << "Found" << failedTasks.size() << "failed tasks, retrying...";
+        statusLabel->setText(QString("正在重试 %1 个失败任务...").arg(failedTasks.size()));
 
-    // 对每个失败的任务重新查询
-    for (const TaskItem &task : failedTasks) {
-        if (!task.apiKey.isEmpty()) {
+        // 对每个失败的任务重新查询
+        for (const TaskItem &task : failedTasks) {
             qDebug() << "Retrying task:" << task.taskId;
-
-            // 更新状态为处理中
-            TaskItem updatedTask = task;
-            updatedTask.status = TaskStatus::Processing;
-            updatedTask.errorMessage = ""; // 清除错误信息
-            updatedTask.updateTime = QDateTime::currentDateTime();
-            dbService->updateTask(updatedTask);
-
-            // 发起查询
-            apiService->pollTask(task.apiKey, task.taskId);
+            pollPendingTask(task.apiKey, task.taskId, PollScheduler::Priority::Background);
         }
-    }
 
-    // 3秒后刷新列表
-    QTimer::singleShot(3000, this, [this]() {
-        loadTasks();
-        statusLabel->setText("重试完成");
+        // 3秒后刷新列表
+        QTimer::singleShot(3000, this, [this]() {
+            loadTasks();
+            statusLabel->setText("重试完成");
+        });
     });
 }
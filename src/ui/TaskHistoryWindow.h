@@ -2,15 +2,20 @@
 #define TASKHISTORYWINDOW_H
 
 #include <QMainWindow>
-#include <QTableWidget>
+#include <QTableView>
+#include <QLineEdit>
 #include <QPushButton>
 #include <QTimer>
 #include <QTextEdit>
 #include <QLabel>
 #include "models/TaskItem.h"
+#include "models/TaskSummary.h"
+#include "services/PollScheduler.h"
+#include "services/DownloadScheduler.h"
 
 class TaskDatabaseService;
 class ApiService;
+class TaskListModel;
 
 class TaskHistoryWindow : public QMainWindow {
     Q_OBJECT
@@ -22,7 +27,7 @@ public:
     void refreshTasks();
 
 public slots:
-    void onTaskPolled(const QString &taskId, bool success, const QString &videoUrl, const QString &error);
+    void onTaskPolled(const QString &taskId, bool success, const QString &videoUrl, const QString &error, bool failed);
 
 signals:
     void taskStatusChanged(const QString &taskId);
@@ -33,23 +38,31 @@ private slots:
     void onDeleteClicked();
     void onAutoRefreshTimeout();
     void onQueryByTaskId();
-    void onTableItemDoubleClicked(QTableWidgetItem *item);
+    void onTableItemDoubleClicked(const QModelIndex &index);
 
 private:
     void setupUi();
-    void loadTasks();
-    void updateTaskRow(int row, const TaskItem &task);
+    void loadTasks();       // 从第一页重新读取列表，并统计任务总数
+    void scheduleReload();  // 合并短时间内的多次刷新请求
+    void replaceTask(const TaskItem &task);  // 只更新该任务所在的行
     void showTaskDetails(const TaskItem &task);
-    void pollPendingTask(const TaskItem &task);
-    void downloadVideoForTask(const QString &taskId, const QString &videoUrl);
+    // 同一参数扫描批次中各任务的参数和耗时
+    static QString batchComparison(const TaskItem &task, const QList<TaskItem> &siblings);
+    void queryTaskById(const QString &taskId, const QString &apiKey);
+    void pollPendingTask(const QString &apiKey, const QString &taskId, PollScheduler::Priority priority);
+    void downloadVideoForTask(const QString &taskId, const QString &videoUrl, DownloadScheduler::Priority priority);
+    void refreshDownloadQueue();  // 更新下载队列概况和各任务的下载状态
+    static QString downloadStatusText(const DownloadScheduler::Entry &entry);
     void onVideoDownloadedForTask(const QString &taskId, const QString &localPath);
     void retryFailedTasks();  // 重试失败的任务
+    void flushPollResults();  // 一轮查询结果在一个事务中写入
 
     TaskDatabaseService *dbService;
     ApiService *apiService;
 
     // UI 组件
-    QTableWidget *taskTable;
+    QTableView *taskTable;
+    TaskListModel *taskModel;
     QPushButton *refreshBtn;
     QPushButton *deleteBtn;
     QPushButton *queryByIdBtn;
@@ -57,12 +70,21 @@ private:
     QLineEdit *apiKeyInput;
     QTextEdit *detailsText;
     QLabel *statusLabel;
+    QLabel *downloadQueueLabel;
 
     // 自动刷新定时器
     QTimer *autoRefreshTimer;
+    QTimer *downloadQueueTimer;  // 有下载进行时定时刷新速率和进度
+    QTimer *reloadTimer;
+    QTimer *pollFlushTimer;
 
-    QList<TaskItem> currentTasks;
+    int totalTasks = 0;
     QString currentSelectedTaskId;
+    QMap<QString, DownloadScheduler::Entry> downloadEntries;  // taskId -> 排队或进行中的下载
+    QMap<QString, PollResult> polledResults;  // 尚未写入数据库的查询结果
+
+    static const int RELOAD_DELAY_MS = 200;
+    static const int POLL_FLUSH_DELAY_MS = 250;  // 收集这段时间内到达的查询结果后一起写入
 };
 
 #endif // TASKHISTORYWINDOW_H
@@ -0,0 +1,257 @@
+#include "TaskListModel.h"
+#include "services/TaskDatabaseService.h"
+#include <QColor>
+#include <QStringList>
+
+TaskListModel::TaskListModel(TaskDatabaseService *dbService, QObject *parent)
+    : QAbstractTableModel(parent), dbService(dbService), order(Qt::DescendingOrder), generation(0), rows(0),
+      atEnd(true), fetching(false) {
+}
+
+int TaskListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : rows;
+}
+
+int TaskListModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TaskListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows) {
+        return QVariant();
+    }
+    int page = index.row() / PAGE_SIZE;
+    if (!pages[page].cached) {
+        // 已从缓存中丢弃：重新读取该页，返回后通过 dataChanged 刷新
+        requestPage(page);
+        return QVariant();
+    }
+    const TaskSummary *task = taskAt(index.row());
+    if (!task) {
+        return QVariant();
+    }
+    touch(page);
+
+    if (role == Qt::DisplayRole) {
+        return displayText(*task, index.column());
+    }
+    if (role == Qt::ForegroundRole && index.column() == StatusColumn) {
+        switch (task->status) {
+            case TaskStatus::Completed:
+                return QColor(Qt::darkGreen);
+            case TaskStatus::Failed:
+                return QColor(Qt::red);
+            case TaskStatus::Processing:
+                return QColor(Qt::blue);
+            default:
+                return QColor(Qt::gray);
+        }
+    }
+    return QVariant();
+}
+
+QVariant TaskListModel::displayText(const TaskSummary &task, int column) const {
+    switch (column) {
+        case TaskIdColumn:
+            return task.taskId;
+        case PromptColumn:
+            // 截断过长的提示词（列表投影只读取了预览长度多一个字符）
+            if (task.prompt.length() > TaskSummary::PROMPT_PREVIEW_LENGTH) {
+                return task.prompt.left(TaskSummary::PROMPT_PREVIEW_LENGTH) + "...";
+            }
+            return task.prompt;
+        case StatusColumn:
+            return statusOverrides.value(task.taskId, task.statusString());
+        case CreateTimeColumn:
+            return task.createTime.toString("yyyy-MM-dd HH:mm:ss");
+        case CompleteTimeColumn:
+            return task.completeTime.isValid() ? task.completeTime.toString("yyyy-MM-dd HH:mm:ss") : "-";
+        case VideoUrlColumn:
+            if (task.videoUrl.isEmpty()) {
+                return "-";
+            }
+            return task.videoUrl.length() > 40 ? task.videoUrl.left(40) + "..." : task.videoUrl;
+        default:
+            return QVariant();
+    }
+}
+
+QVariant TaskListModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        static const QStringList labels = {"任务ID", "提示词", "状态", "创建时间", "完成时间", "视频URL"};
+        return labels.value(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool TaskListModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && !atEnd && !fetching;
+}
+
+void TaskListModel::fetchMore(const QModelIndex &parent) {
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    fetching = true;
+    int requested = generation;
+    dbService->getTaskSummaryPageAsync(lastKey, false, descending(), PAGE_SIZE)
+        .then(this, [this, requested](const QList<TaskSummary> &page) {
+            onMoreLoaded(requested, page);
+        });
+}
+
+void TaskListModel::onMoreLoaded(int requested, const QList<TaskSummary> &page) {
+    if (requested != generation) {
+        return;
+    }
+    fetching = false;
+    atEnd = page.size() < PAGE_SIZE;
+    if (page.isEmpty()) {
+        return;
+    }
+
+    // 除最后一页外每页都是 PAGE_SIZE 行，行号除以 PAGE_SIZE 即为页号
+    beginInsertRows(QModelIndex(), rows, rows + page.size() - 1);
+    Page added;
+    added.first = TaskPageKey::of(page.first());
+    added.size = page.size();
+    added.cached = true;
+    added.rows = page;
+    pages.append(added);
+    rows += page.size();
+    lastKey = TaskPageKey::of(page.last());
+    touch(pages.size() - 1);
+    evict();
+    endInsertRows();
+}
+
+void TaskListModel::requestPage(int page) const {
+    if (loadingPages.contains(page)) {
+        return;
+    }
+    loadingPages.insert(page);
+    auto *self = const_cast<TaskListModel *>(this);
+    int requested = generation;
+    dbService->getTaskSummaryPageAsync(pages[page].first, true, descending(), PAGE_SIZE)
+        .then(self, [self, requested, page](const QList<TaskSummary> &loaded) {
+            self->onPageLoaded(requested, page, loaded);
+        });
+}
+
+void TaskListModel::onPageLoaded(int requested, int page, const QList<TaskSummary> &loaded) {
+    if (requested != generation) {
+        return;
+    }
+    loadingPages.remove(page);
+    // 读取后有任务被删除时该页会多读到下一页的行，只保留原有行数
+    Page &target = pages[page];
+    target.rows = loaded.mid(0, target.size);
+    target.cached = true;
+    touch(page);
+    evict();
+
+    int firstRow = page * PAGE_SIZE;
+    emit dataChanged(index(firstRow, 0), index(firstRow + target.size - 1, ColumnCount - 1));
+}
+
+void TaskListModel::touch(int page) const {
+    if (!recentPages.isEmpty() && recentPages.last() == page) {
+        return;
+    }
+    recentPages.removeOne(page);
+    recentPages.append(page);
+}
+
+void TaskListModel::evict() const {
+    while (recentPages.size() > CACHED_PAGES) {
+        Page &victim = pages[recentPages.takeFirst()];
+        victim.cached = false;
+        victim.rows = QList<TaskSummary>();  // 释放行数据，只保留键
+    }
+}
+
+void TaskListModel::sort(int column, Qt::SortOrder newOrder) {
+    if (column != CreateTimeColumn || newOrder == order) {
+        return;
+    }
+    order = newOrder;
+    reload();
+}
+
+void TaskListModel::reload() {
+    beginResetModel();
+    generation++;
+    pages.clear();
+    recentPages.clear();
+    loadingPages.clear();
+    rows = 0;
+    atEnd = false;
+    fetching = false;
+    lastKey = TaskPageKey();
+    endResetModel();
+    fetchMore(QModelIndex());
+}
+
+Qt::SortOrder TaskListModel::sortOrder() const {
+    return order;
+}
+
+bool TaskListModel::descending() const {
+    return order == Qt::DescendingOrder;
+}
+
+bool TaskListModel::precedes(const TaskPageKey &a, const TaskPageKey &b) const {
+    if (a.createTime != b.createTime) {
+        return descending() ? a.createTime > b.createTime : a.createTime < b.createTime;
+    }
+    return descending() ? a.taskId > b.taskId : a.taskId < b.taskId;
+}
+
+const TaskSummary *TaskListModel::taskAt(int row) const {
+    if (row < 0 || row >= rows) {
+        return nullptr;
+    }
+    const Page &page = pages[row / PAGE_SIZE];
+    int offset = row % PAGE_SIZE;
+    if (!page.cached || offset >= page.rows.size()) {
+        return nullptr;
+    }
+    return &page.rows[offset];
+}
+
+bool TaskListModel::updateTask(const TaskSummary &task) {
+    const QList<int> cachedPages = recentPages;  // 视图在 dataChanged 中取数据时会调整顺序
+    for (int p : cachedPages) {
+        Page &page = pages[p];
+        for (int i = 0; i < page.rows.size(); ++i) {
+            if (page.rows[i].taskId == task.taskId) {
+                page.rows[i] = task;
+                int row = p * PAGE_SIZE + i;
+                emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+                return true;
+            }
+        }
+    }
+
+    // 不在缓存中：在已读取的范围内时，所在的页下次显示时会读到新数据；
+    // 排在第一行之前的（读取后新建的），或已读到末尾而排在最后一行之后的，不在列表中
+    if (pages.isEmpty()) {
+        return false;
+    }
+    TaskPageKey key = TaskPageKey::of(task);
+    if (precedes(key, pages.first().first)) {
+        return false;
+    }
+    return !(atEnd && precedes(lastKey, key));
+}
+
+void TaskListModel::setStatusOverrides(const QHash<QString, QString> &texts) {
+    if (texts.isEmpty() && statusOverrides.isEmpty()) {
+        return;
+    }
+    statusOverrides = texts;
+    if (rows > 0) {
+        // 只有可见的行会重新取数据
+        emit dataChanged(index(0, StatusColumn), index(rows - 1, StatusColumn), {Qt::DisplayRole});
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef TASKLISTMODEL_H
+#define TASKLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include "models/TaskSummary.h"
+
+class TaskDatabaseService;
+
+// 任务历史表格的模型。行按 (创建时间, 任务 ID) 排序，从数据库线程按页读取：
+//
+//   - 滚动到末尾时视图调用 fetchMore，从上一页最后一行的键之后读取下一页（键集分页），
+//     读取位置与已读行数无关，百万行时每页的查询耗时相同；
+//   - 每页只保留第一行的键，行数据最多缓存 CACHED_PAGES 页，最久未显示的页被丢弃，
+//     再次显示时从该页的键重新读取，读取返回前单元格显示为空；
+//   - 只能按创建时间排序（有索引），切换方向时从第一页重新读取，不在内存中排序。
+//
+// 读取后新增的任务不会插入已有的页，调用 reload() 后出现。
+class TaskListModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        TaskIdColumn,
+        PromptColumn,
+        StatusColumn,
+        CreateTimeColumn,
+        CompleteTimeColumn,
+        VideoUrlColumn,
+        ColumnCount
+    };
+
+    explicit TaskListModel(TaskDatabaseService *dbService, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;  // 只支持 CreateTimeColumn
+
+    void reload();  // 丢弃全部页，从第一页重新读取
+    Qt::SortOrder sortOrder() const;
+    const TaskSummary *taskAt(int row) const;  // 该行所在的页不在缓存中时返回 nullptr
+    // 更新缓存中的行。返回 false 表示该任务不在已读取的范围内（如读取后新建的任务），需要 reload()
+    bool updateTask(const TaskSummary &task);
+    void setStatusOverrides(const QHash<QString, QString> &texts);  // taskId -> 代替任务状态显示的文字（如下载进度）
+
+    static const int PAGE_SIZE = 200;
+    static const int CACHED_PAGES = 16;
+
+private:
+    struct Page {
+        TaskPageKey first;  // 第一行的键，重新读取时从这里开始（含）
+        int size = 0;
+        bool cached = false;
+        QList<TaskSummary> rows;
+    };
+
+    bool descending() const;
+    bool precedes(const TaskPageKey &a, const TaskPageKey &b) const;  // 按当前排序方向 a 在 b 之前
+    void requestPage(int page) const;
+    void onPageLoaded(int generation, int page, const QList<TaskSummary> &rows);
+    void onMoreLoaded(int generation, const QList<TaskSummary> &rows);
+    void touch(int page) const;
+    void evict() const;
+    QVariant displayText(const TaskSummary &task, int column) const;
+
+    TaskDatabaseService *dbService;
+    Qt::SortOrder order;
+    int generation;  // reload() 后递增，丢弃之前发出的读取的结果
+    int rows;
+    bool atEnd;
+    bool fetching;
+    TaskPageKey lastKey;  // 已读取的最后一行
+    QHash<QString, QString> statusOverrides;
+
+    // data() 是 const 的：缺页时的读取请求和缓存淘汰属于可变状态
+    mutable QList<Page> pages;
+    mutable QList<int> recentPages;  // 缓存中的页，最近显示的在后
+    mutable QSet<int> loadingPages;
+};
+
+#endif // TASKLISTMODEL_H
@@ -0,0 +1,35 @@
+#include "ImageUtils.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+namespace ImageUtils {
+
+QString fileToDataUri(const QString &imagePath) {
+    QFile file(imagePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open image file:" << imagePath;
+        return "";
+    }
+
+    QByteArray imageData = file.readAll();
+    file.close();
+
+    // 获取文件扩展名以确定 MIME 类型
+    QString extension = QFileInfo(imagePath).suffix().toLower();
+    QString mimeType = "image/jpeg";  // 默认
+
+    if (extension == "png") mimeType = "image/png";
+    else if (extension == "webp") mimeType = "image/webp";
+    else if (extension == "bmp") mimeType = "image/bmp";
+    else if (extension == "tiff" || extension == "tif") mimeType = "image/tiff";
+    else if (extension == "gif") mimeType = "image/gif";
+
+    // 返回 Base64 格式：data:image/jpeg;base64,<base64-data>
+    QString base64 = "data:" + mimeType + ";base64," + imageData.toBase64();
+
+    qDebug() << "Image converted to base64, size:" << base64.length() << "chars";
+    return base64;
+}
+
+} // namespace ImageUtils
@@ -0,0 +1,13 @@
+#ifndef IMAGEUTILS_H
+#define IMAGEUTILS_H
+
+#include <QString>
+
+namespace ImageUtils {
+
+// 读取图片文件并编码为 data URI（data:image/png;base64,...），读取失败时返回空字符串
+QString fileToDataUri(const QString &imagePath);
+
+} // namespace ImageUtils
+
+#endif // IMAGEUTILS_H
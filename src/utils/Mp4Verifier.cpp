@@ -0,0 +1,78 @@
+#include "Mp4Verifier.h"
+#include <QtEndian>
+
+void Mp4Verifier::reset() {
+    *this = Mp4Verifier();
+}
+
+void Mp4Verifier::addData(const char *data, qint64 size) {
+    while (size > 0 && failure.isEmpty()) {
+        if (toEnd || offset < boxEnd) {
+            // box 内容：直接跳过
+            qint64 skip = toEnd ? size : qMin(size, boxEnd - offset);
+            offset += skip;
+            data += skip;
+            size -= skip;
+            continue;
+        }
+
+        // box 头：8 字节（32 位大小 + 类型），大小为 1 时再跟 8 字节的 64 位大小
+        qint64 needed = (header.size() >= 4 && qFromBigEndian<quint32>(header.constData()) == 1) ? 16 : 8;
+        qint64 take = qMin<qint64>(size, needed - header.size());
+        header.append(data, take);
+        offset += take;
+        data += take;
+        size -= take;
+        if (header.size() == needed && parseHeader()) {
+            header.clear();
+        }
+    }
+}
+
+bool Mp4Verifier::parseHeader() {
+    quint32 size32 = qFromBigEndian<quint32>(header.constData());
+    if (size32 == 1 && header.size() < 16) {
+        return false;  // 还需要 64 位大小
+    }
+    const QByteArray type = header.mid(4, 4);
+    for (char c : type) {
+        if (c < 0x20 || c > 0x7e) {
+            failure = QString("偏移 %1 处不是有效的 MP4 box").arg(offset - header.size());
+            return true;
+        }
+    }
+
+    qint64 boxStart = offset - header.size();
+    if (size32 == 0) {
+        toEnd = true;
+    } else {
+        qint64 boxSize = size32 == 1 ? qFromBigEndian<qint64>(header.constData() + 8) : size32;
+        if (boxSize < header.size()) {
+            failure = QString("box %1 的大小 %2 无效").arg(QString::fromLatin1(type)).arg(boxSize);
+            return true;
+        }
+        boxEnd = boxStart + boxSize;
+    }
+
+    if (type == "ftyp") {
+        seenFtyp = true;
+    } else if (type == "moov") {
+        seenMoov = true;
+    }
+    return true;
+}
+
+bool Mp4Verifier::finish(QString *error) const {
+    QString reason = failure;
+    if (reason.isEmpty() && (!header.isEmpty() || (!toEnd && offset < boxEnd))) {
+        reason = QString("文件在偏移 %1 处被截断").arg(offset);
+    } else if (reason.isEmpty() && !seenFtyp) {
+        reason = "缺少 ftyp box，不是 MP4 文件";
+    } else if (reason.isEmpty() && !seenMoov) {
+        reason = "缺少 moov box（元数据不完整）";
+    }
+    if (error) {
+        *error = reason;
+    }
+    return reason.isEmpty();
+}
@@ -0,0 +1,34 @@
+#ifndef MP4VERIFIER_H
+#define MP4VERIFIER_H
+
+#include <QByteArray>
+#include <QString>
+
+// MP4（ISO BMFF）顶层结构的流式检查：随下载按顺序喂入数据，只解析各顶层 box 的头部
+// （大小和类型）并跳过内容，不缓存文件数据。完成时要求：
+//   - 存在 ftyp 和 moov；
+//   - box 类型是可打印字符（HTML 错误页等非 MP4 内容会在第一个 box 处失败）；
+//   - 最后一个 box 恰好在文件末尾结束（截断的文件在这里失败）。
+class Mp4Verifier {
+public:
+    void addData(const char *data, qint64 size);
+    void reset();
+
+    // 全部数据喂入后调用；失败时 error 给出原因
+    bool finish(QString *error) const;
+
+    qint64 bytesSeen() const { return offset; }
+
+private:
+    bool parseHeader();
+
+    qint64 offset = 0;      // 已喂入的字节数
+    qint64 boxEnd = 0;      // 当前顶层 box 结束的位置
+    bool toEnd = false;     // 大小为 0 的 box 延伸到文件末尾
+    QByteArray header;      // 尚未完整的 box 头
+    bool seenFtyp = false;
+    bool seenMoov = false;
+    QString failure;
+};
+
+#endif // MP4VERIFIER_H
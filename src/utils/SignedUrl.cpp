@@ -0,0 +1,77 @@
+#include "SignedUrl.h"
+#include <QTimeZone>
+#include <QUrl>
+#include <QUrlQuery>
+
+namespace SignedUrl {
+
+namespace {
+
+// 秒或毫秒的 Unix 时间戳
+QDateTime fromEpoch(const QString &value) {
+    bool ok = false;
+    qint64 number = value.toLongLong(&ok);
+    if (!ok || number <= 0) {
+        return QDateTime();
+    }
+    if (number > 100000000000LL) {
+        return QDateTime::fromMSecsSinceEpoch(number, QTimeZone::utc());
+    }
+    return QDateTime::fromSecsSinceEpoch(number, QTimeZone::utc());
+}
+
+// 签名时间 + 有效秒数，签名时间为 20240101T120000Z 格式
+QDateTime fromSignedDate(const QString &date, const QString &seconds) {
+    QDateTime signedAt = QDateTime::fromString(date, "yyyyMMdd'T'HHmmss'Z'");
+    bool ok = false;
+    qint64 ttl = seconds.toLongLong(&ok);
+    if (!signedAt.isValid() || !ok) {
+        return QDateTime();
+    }
+    signedAt.setTimeZone(QTimeZone::utc());
+    return signedAt.addSecs(ttl);
+}
+
+} // namespace
+
+QDateTime expiry(const QString &url) {
+    // 查询参数名大小写不一，统一按小写匹配
+    QMap<QString, QString> params;
+    const QUrlQuery query(QUrl(url).query(QUrl::FullyEncoded));
+    for (const auto &item : query.queryItems(QUrl::FullyDecoded)) {
+        params.insert(item.first.toLower(), item.second);
+    }
+
+    if (params.contains("x-amz-date") && params.contains("x-amz-expires")) {
+        return fromSignedDate(params["x-amz-date"], params["x-amz-expires"]);
+    }
+    if (params.contains("x-goog-date") && params.contains("x-goog-expires")) {
+        return fromSignedDate(params["x-goog-date"], params["x-goog-expires"]);
+    }
+    if (params.contains("se") && params.contains("sig")) {
+        QDateTime end = QDateTime::fromString(params["se"], Qt::ISODate);
+        if (end.isValid()) {
+            return end.toUTC();
+        }
+    }
+    for (const QString &key : {QString("q-sign-time"), QString("q-key-time")}) {
+        // "开始;结束" 两个秒级时间戳
+        if (params.contains(key)) {
+            QDateTime end = fromEpoch(params[key].section(';', 1, 1));
+            if (end.isValid()) {
+                return end;
+            }
+        }
+    }
+    for (const QString &key : {QString("expires"), QString("x-expires"), QString("exp"), QString("expire")}) {
+        if (params.contains(key)) {
+            QDateTime end = fromEpoch(params[key]);
+            if (end.isValid()) {
+                return end;
+            }
+        }
+    }
+    return QDateTime();
+}
+
+} // namespace SignedUrl
@@ -0,0 +1,17 @@
+#ifndef SIGNEDURL_H
+#define SIGNEDURL_H
+
+#include <QDateTime>
+#include <QString>
+
+namespace SignedUrl {
+
+// 从签名 URL 的查询参数解析过期时间（UTC），无法识别时返回无效的 QDateTime。
+// 支持 AWS SigV4（X-Amz-Date + X-Amz-Expires）、GCS V4（X-Goog-Date + X-Goog-Expires）、
+// Azure SAS（se）、腾讯云 COS（q-sign-time / q-key-time 的结束时间），
+// 以及 Expires / x-expires / exp 等 Unix 时间戳形式（AWS V2、阿里云 OSS、CloudFront 等）。
+QDateTime expiry(const QString &url);
+
+} // namespace SignedUrl
+
+#endif // SIGNEDURL_H
@@ -1,252 +1,241 @@
 #include "MainViewModel.h"
 #include "services/TaskDatabaseService.h"
+#include "services/ParameterSweep.h"
+#include "services/VideoStore.h"
+#include "services/VideoScrubber.h"
+#include "const/AppConfig.h"
 #include "models/TaskItem.h"
+#include <QFile>
+#include <QFileInfo>
 
-MainViewModel::MainViewModel(QObject *parent) : QObject(parent),
-    pollAttempts(0), currentInterval(INITIAL_INTERVAL) {
+MainViewModel::MainViewModel(QObject *parent) : QObject(parent) {
     apiService = new ApiService(this);
     historyService = new HistoryService(this);
     taskDbService = new TaskDatabaseService(this);
-    pollTimer = new QTimer(this);
 
     // 初始化数据库
     if (!taskDbService->initialize()) {
         qWarning() << "Failed to initialize task database";
     }
 
-    connect(apiService, &ApiService::taskSubmitted, this, &MainViewModel::onTaskSubmitted);
-    connect(apiService, &ApiService::taskFinished, this, &MainViewModel::onTaskFinished);
-    connect(apiService, &ApiService::videoDownloaded, this, &MainViewModel::onVideoDownloaded);
-    connect(apiService, &ApiService::errorOccurred, this, [this](const QString &msg){
-        if(msg == "STATUS_PROCESSING") return; // 忽略处理中的内部信号
-        emit errorOccurred(msg);
-        stopPolling();
-    });
+    apiService->setDownloadJournal(taskDbService);
+    videoStore = new VideoStore(taskDbService, historyService, this);
+    videoStore->reloadSettings();
+    apiService->setVideoStore(videoStore);
+    taskManager = new GenerationTaskManager(apiService, taskDbService, historyService, this);
+
+    connect(taskManager, &GenerationTaskManager::jobStateChanged, this, &MainViewModel::onJobStateChanged);
+    connect(taskManager, &GenerationTaskManager::jobProgress, this, &MainViewModel::onJobProgress);
+    connect(taskManager, &GenerationTaskManager::jobSaved, this, &MainViewModel::onJobSaved);
+    connect(taskManager, &GenerationTaskManager::jobFailed, this, &MainViewModel::onJobFailed);
+    connect(taskManager, &GenerationTaskManager::queueChanged, this, &MainViewModel::queueChanged);
+    connect(taskManager, &GenerationTaskManager::batchProgress, this, &MainViewModel::batchProgress);
+    connect(taskManager, &GenerationTaskManager::requestCacheStatsChanged, this, &MainViewModel::requestCacheStatsChanged);
+    connect(apiService, &ApiService::videoDownloadedForTask, this, &MainViewModel::onVideoRefetched);
+    connect(apiService, &ApiService::downloadFailed, this, &MainViewModel::onRefetchFailed);
+
+    // 续传上次退出时未完成的下载
+    taskManager->resumeInterruptedDownloads();
+
+    // 定期在后台重新校验已下载的视频，损坏的自动重新下载
+    videoScrubber = new VideoScrubber(taskDbService, this);
+    connect(videoScrubber, &VideoScrubber::corruptVideoFound, this, &MainViewModel::onCorruptVideo);
+    videoScrubber->scheduleIfDue();
+}
+
+QString MainViewModel::startSweep(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params,
+                                  const QString &imageData, const QString &lastImageData) {
+    QList<QMap<QString, QString>> combinations = ParameterSweep::expand(params);
+    if (combinations.isEmpty()) {
+        emit errorOccurred(QString("参数组合超过 %1 个").arg(ParameterSweep::MAX_COMBINATIONS));
+        return "";
+    }
 
-    // 使用智能轮询
-    connect(pollTimer, &QTimer::timeout, this, &MainViewModel::onSmartPoll);
+    // 所有组合一次入队，由调度器的并发上限和提交限流控制实际的提交节奏
+    QString batchId = ParameterSweep::newBatchId();
+    for (const QMap<QString, QString> &combination : combinations) {
+        if (imageData.isEmpty()) {
+            focusedJobId = taskManager->enqueueTextToVideo(apiKey, prompt, combination, batchId);
+        } else {
+            focusedJobId = taskManager->enqueueImageToVideo(apiKey, prompt, imageData, lastImageData, combination, batchId);
+        }
+    }
+    qDebug() << "Sweep" << batchId << "enqueued" << combinations.size() << "tasks";
+    return batchId;
 }
 
-void MainViewModel::loadHistory() {
-    historyService->load();
-    emit historyUpdated();
+void MainViewModel::setRequestCacheEnabled(bool enabled) {
+    taskManager->setRequestCacheEnabled(enabled);
+    QSettings settings(Config::ORG_NAME, Config::APP_NAME);
+    settings.setValue(Config::KEY_USE_REQUEST_CACHE, enabled);
 }
 
-void MainViewModel::startGeneration(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params) {
-    currentApiKey = apiKey;
-    currentPrompt = prompt;
-    currentParams = params;  // 保存参数
-    emit statusChanged("正在提交任务...");
-    emit progressUpdated(10);
-    apiService->submitTask(apiKey, prompt);
-}
+void MainViewModel::playVideo(const QString &filePath) {
+    if (QFile::exists(filePath)) {
+        taskDbService->markVideoPlayedAsync(filePath);
+        emit playbackReady(filePath);
+        return;
+    }
 
-void MainViewModel::startImageToVideoGeneration(const QString &apiKey, const QString &prompt, const QString &imageData, const QString &lastImageData, const QMap<QString, QString> &params) {
-    currentApiKey = apiKey;
-    currentPrompt = prompt;
-    currentParams = params;  // 保存参数（图生视频使用相同的参数）
-    emit statusChanged("正在提交图生视频任务...");
-    emit progressUpdated(10);
-    apiService->submitImageToVideoTask(apiKey, prompt, imageData, lastImageData, params);
-}
-
-void MainViewModel::onTaskSubmitted(const QString &taskId) {
-    currentTaskId = taskId;
-
-    // 保存任务到数据库
-    TaskItem task;
-    task.taskId = taskId;
-    task.prompt = currentPrompt;
-    task.apiKey = currentApiKey;
-
-    // 使用用户配置的参数，如果没有则使用默认值
-    task.width = currentParams.value("width", "1280").toInt();
-    task.height = currentParams.value("height", "720").toInt();
-    task.resolution = currentParams.value("resolution", "1080p");
-    task.aspectRatio = currentParams.value("aspect_ratio", "16:9");
-    task.duration = currentParams.value("duration", "5").toInt();
-    task.cameraFixed = (currentParams.value("camera_fixed", "false") == "true");
-    task.seed = currentParams.value("seed", "123").toInt();
-
-    task.status = TaskStatus::Processing;
-    task.createTime = QDateTime::currentDateTime();
-    task.updateTime = task.createTime;
-
-    taskDbService->saveTask(task);
-
-    emit statusChanged("任务已提交 (" + taskId + ")，正在生成...");
-    emit progressUpdated(30);
-
-    // 启动智能轮询
-    startSmartPolling();
-}
-
-void MainViewModel::onTaskFinished(bool success, const QString &result, const QString &error) {
-    if(success) {
-        stopPolling();
-
-        // 更新数据库中的任务状态
-        TaskItem task = taskDbService->getTask(currentTaskId);
-        if (!task.taskId.isEmpty()) {
-            task.status = TaskStatus::Completed;
-            task.videoUrl = result;
-            task.updateTime = QDateTime::currentDateTime();
-            task.completeTime = task.updateTime;
-            taskDbService->updateTask(task);
+    // 文件已被存储淘汰或被删除：按任务记录的视频 URL 重新下载，任务在数据库线程中查找
+    taskDbService->run([filePath](TaskDatabase &db) {
+        TaskItem task = db.getTaskByLocalPath(filePath);
+        if (task.taskId.isEmpty()) {
+            // 旧版本直接保存在保存目录下，文件名格式：taskId_timestamp.mp4
+            QString fileName = QFileInfo(filePath).completeBaseName();
+            task = db.getTask(fileName.section('_', 0, 0));
         }
+        return task;
+    }).then(this, [this, filePath](const TaskItem &task) {
+        refetchForPlayback(filePath, task);
+    });
+}
 
-        emit statusChanged("生成成功，正在下载...");
-        emit progressUpdated(80);
-        apiService->downloadVideo(result); // result is URL
-    } else if (!error.isEmpty()) {
-        stopPolling();
-
-        // 更新数据库中的任务状态为失败
-        TaskItem task = taskDbService->getTask(currentTaskId);
-        if (!task.taskId.isEmpty()) {
-            task.status = TaskStatus::Failed;
-            task.errorMessage = error;
-            task.updateTime = QDateTime::currentDateTime();
-            task.completeTime = task.updateTime;
-            taskDbService->updateTask(task);
-        }
+void MainViewModel::refetchForPlayback(const QString &filePath, const TaskItem &task) {
+    if (task.taskId.isEmpty() || task.videoUrl.isEmpty()) {
+        emit playbackFailed("视频文件不存在，且找不到可用于重新下载的视频 URL\n请在任务历史中重新查询该任务");
+        return;
+    }
 
-        emit errorOccurred("生成失败: " + error);
-        emit progressUpdated(0);
+    emit statusChanged(QString("视频文件不存在，正在重新下载... (Task ID: %1)").arg(task.taskId));
+    if (pendingPlayback.contains(task.taskId)) {
+        return;
     }
-    // 如果还没完成，Timer 会继续触发，这里不用处理
+    pendingPlayback.insert(task.taskId, filePath);
+    // 播放请求优先于其他下载，不受最大同时下载数限制
+    apiService->downloadVideo(task.videoUrl, videoStore->incomingPath(task.taskId), task.taskId,
+                              DownloadScheduler::Priority::Playback);
 }
 
-void MainViewModel::onVideoDownloaded(const QString &tempPath) {
-    // 将临时文件移动到最终保存目录
-    QString saveDir = historyService->getSavePath();
-    QDir dir(saveDir);
-    if (!dir.exists()) dir.mkpath(".");
-
-    QString fileName = "video_" + QString::number(QDateTime::currentSecsSinceEpoch()) + ".mp4";
-    QString finalPath = dir.filePath(fileName);
+void MainViewModel::onCorruptVideo(const QString &path, const QString &reason) {
+    taskDbService->run([path](TaskDatabase &db) { return db.getTaskByLocalPath(path); })
+        .then(this, [this, path, reason](const TaskItem &task) {
+            repairCorruptVideo(path, reason, task);
+        });
+}
 
-    QFile::remove(finalPath); // 覆盖旧的
-    if (QFile::copy(tempPath, finalPath)) {
-        QFile::remove(tempPath); // 删掉临时文件
-        
-        // 更新数据库中的本地文件路径
-        TaskItem task = taskDbService->getTask(currentTaskId);
-        if (!task.taskId.isEmpty()) {
-            task.localFilePath = finalPath;
-            task.updateTime = QDateTime::currentDateTime();
-            taskDbService->updateTask(task);
+void MainViewModel::repairCorruptVideo(const QString &path, const QString &reason, const TaskItem &task) {
+    if (task.taskId.isEmpty() || task.videoUrl.isEmpty()) {
+        emit statusChanged(QString("视频已损坏且无法重新下载: %1 (%2)").arg(QFileInfo(path).fileName(), reason));
+        return;
+    }
+    if (pendingRepair.contains(task.taskId) || pendingPlayback.contains(task.taskId)) {
+        return;
+    }
+    emit statusChanged(QString("视频已损坏，正在重新下载... (Task ID: %1)").arg(task.taskId));
+    pendingRepair.insert(task.taskId, path);
+    apiService->downloadVideo(task.videoUrl, videoStore->incomingPath(task.taskId), task.taskId,
+                              DownloadScheduler::Priority::Backfill);
+}
+
+void MainViewModel::onVideoRefetched(const QString &taskId, const QString &localPath) {
+    auto repair = pendingRepair.find(taskId);
+    if (repair != pendingRepair.end()) {
+        // 服务器上的内容与损坏前不同时存储路径随之变化
+        if (localPath != repair.value()) {
+            historyService->replacePath(repair.value(), localPath);
+            emit historyUpdated();
         }
+        pendingRepair.erase(repair);
+    }
 
-        historyService->add(currentPrompt, finalPath);
+    auto it = pendingPlayback.find(taskId);
+    if (it == pendingPlayback.end()) {
+        return;
+    }
+    QString oldPath = it.value();
+    pendingPlayback.erase(it);
+
+    // 内容相同时存储路径不变；旧版本的文件则移入了存储
+    if (localPath != oldPath) {
+        historyService->replacePath(oldPath, localPath);
         emit historyUpdated();
-        emit videoReady(finalPath);
-        emit statusChanged("完成");
-        emit progressUpdated(100);
-    } else {
-        emit errorOccurred("无法保存视频文件");
     }
+    taskDbService->markVideoPlayedAsync(localPath);
+    emit statusChanged("视频下载完成");
+    emit playbackReady(localPath);
 }
 
-void MainViewModel::deleteHistoryItem(int index) {
-    historyService->remove(index);
-    emit historyUpdated();
+void MainViewModel::onRefetchFailed(const QString &taskId, const QString &error) {
+    pendingRepair.remove(taskId);
+    if (pendingPlayback.remove(taskId) > 0) {
+        emit playbackFailed("视频下载失败: " + error);
+    }
 }
 
-QList<HistoryItem> MainViewModel::getHistory() const {
-    return historyService->getItems();
+void MainViewModel::reloadStorageSettings() {
+    videoStore->reloadSettings();
+    DownloadScheduler::instance()->reloadSettings();
 }
 
-QString MainViewModel::getCurrentSavePath() const {
-    return historyService->getSavePath();
+void MainViewModel::loadHistory() {
+    historyService->load();
+    emit historyUpdated();
 }
 
-TaskDatabaseService* MainViewModel::getTaskDatabaseService() const {
-    return taskDbService;
+void MainViewModel::startGeneration(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params) {
+    focusedJobId = taskManager->enqueueTextToVideo(apiKey, prompt, params);
 }
 
-ApiService* MainViewModel::getApiService() const {
-    return apiService;
+void MainViewModel::startImageToVideoGeneration(const QString &apiKey, const QString &prompt, const QString &imageData, const QString &lastImageData, const QMap<QString, QString> &params) {
+    focusedJobId = taskManager->enqueueImageToVideo(apiKey, prompt, imageData, lastImageData, params);
 }
 
-void MainViewModel::startSmartPolling() {
-    taskStartTime = QDateTime::currentDateTime();
-    pollAttempts = 0;
-    currentInterval = INITIAL_INTERVAL;
-
-    // 立即进行第一次查询
-    onSmartPoll();
+void MainViewModel::onJobStateChanged(const QString &jobId, GenerationState state, const QString &message) {
+    Q_UNUSED(state);
+    // 只有最近提交的任务驱动状态栏，其余任务的状态通过 queueChanged 汇总
+    if (jobId == focusedJobId && !message.isEmpty()) {
+        emit statusChanged(message);
+    }
 }
 
-void MainViewModel::stopPolling() {
-    pollTimer->stop();
-    pollAttempts = 0;
-    currentInterval = INITIAL_INTERVAL;
+void MainViewModel::onJobProgress(const QString &jobId, int percent) {
+    if (jobId == focusedJobId) {
+        emit progressUpdated(percent);
+    }
 }
 
-void MainViewModel::onSmartPoll() {
-    // 检查是否超时（5分钟）
-    int elapsedSeconds = taskStartTime.secsTo(QDateTime::currentDateTime());
-
-    if (elapsedSeconds > MAX_WAIT_TIME) {
-        // 超时，标记为失败并保存
-        stopPolling();
-
-        TaskItem task = taskDbService->getTask(currentTaskId);
-        if (!task.taskId.isEmpty()) {
-            task.status = TaskStatus::Failed;
-            task.errorMessage = "查询超时（超过5分钟）";
-            task.updateTime = QDateTime::currentDateTime();
-            taskDbService->updateTask(task);
-        }
+void MainViewModel::onJobSaved(const QString &jobId, const QString &localPath) {
+    emit historyUpdated();
+    if (jobId == focusedJobId) {
+        emit videoReady(localPath);
+    }
+}
 
-        emit statusChanged("查询超时");
+void MainViewModel::onJobFailed(const QString &jobId, const QString &error) {
+    // 只有最近提交的任务弹出错误对话框；其余任务和批量任务的失败通过 queueChanged / batchProgress 汇总
+    if (jobId == focusedJobId) {
+        emit errorOccurred(error);
         emit progressUpdated(0);
-        emit errorOccurred("任务查询超时（超过5分钟）\n"
-                          "任务 ID: " + currentTaskId + "\n"
-                          "任务已保存到历史记录，可在任务历史窗口重新查询");
-        return;
     }
+}
 
-    // 更新等待时间显示
-    updateWaitingTime();
-
-    // 执行查询
-    pollAttempts++;
-    qDebug() << "Smart poll attempt" << pollAttempts << "after" << elapsedSeconds << "seconds, interval:" << currentInterval << "ms";
-    apiService->pollTask(currentApiKey, currentTaskId);
-
-    // 计算下一次查询间隔（指数退避）
-    // 间隔序列：3s, 5s, 8s, 13s, 21s, 30s(max)
-    int nextInterval = currentInterval;
-    if (pollAttempts >= 3) {
-        // 从第3次开始使用指数退避
-        nextInterval = qMin(currentInterval * 1.6, (double)MAX_INTERVAL);
+void MainViewModel::deleteHistoryItem(int index) {
+    const QList<HistoryItem> items = historyService->getItems();
+    if (index < 0 || index >= items.size()) {
+        return;
     }
-    currentInterval = nextInterval;
-
-    // 设置下一次查询
-    pollTimer->start(currentInterval);
+    historyService->remove(index);
+    videoStore->releaseVideo(items[index].filePath, items[index].prompt);
+    emit historyUpdated();
 }
 
-void MainViewModel::updateWaitingTime() {
-    int elapsedSeconds = taskStartTime.secsTo(QDateTime::currentDateTime());
-    int remainingSeconds = MAX_WAIT_TIME - elapsedSeconds;
-
-    int minutes = elapsedSeconds / 60;
-    int seconds = elapsedSeconds % 60;
-
-    QString timeStr = QString("已等待: %1分%2秒").arg(minutes).arg(seconds, 2, 10, QChar('0'));
+QList<HistoryItem> MainViewModel::getHistory() const {
+    return historyService->getItems();
+}
 
-    if (remainingSeconds < 60) {
-        timeStr += QString(" (剩余: %1秒)").arg(remainingSeconds);
-    }
+QString MainViewModel::getCurrentSavePath() const {
+    return historyService->getSavePath();
+}
 
-    emit statusChanged("正在生成视频... " + timeStr);
+TaskDatabaseService* MainViewModel::getTaskDatabaseService() const {
+    return taskDbService;
+}
 
-    // 更新进度条（基于时间）
-    int progress = 30 + (elapsedSeconds * 50 / MAX_WAIT_TIME); // 30-80%
-    progress = qMin(progress, 75); // 最多75%
-    emit progressUpdated(progress);
+ApiService* MainViewModel::getApiService() const {
+    return apiService;
 }
 
+GenerationTaskManager* MainViewModel::getTaskManager() const {
+    return taskManager;
+}
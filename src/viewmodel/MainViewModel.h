@@ -4,8 +4,11 @@
 #include "const/QtHeaders.h"
 #include "services/ApiService.h"
 #include "services/HistoryService.h"
+#include "services/GenerationTaskManager.h"
 
 class TaskDatabaseService;
+class VideoStore;
+class VideoScrubber;
 
 class MainViewModel : public QObject {
     Q_OBJECT
@@ -15,6 +18,13 @@ public:
     // 给 UI 调用的方法
     void startGeneration(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params = QMap<QString, QString>());
     void startImageToVideoGeneration(const QString &apiKey, const QString &prompt, const QString &imageData, const QString &lastImageData = "", const QMap<QString, QString> &params = QMap<QString, QString>());
+    // 参数扫描：按 ParameterSweep 展开参数矩阵，作为一个批次提交；imageData 非空时为图生视频。返回批次 ID
+    QString startSweep(const QString &apiKey, const QString &prompt, const QMap<QString, QString> &params,
+                       const QString &imageData = "", const QString &lastImageData = "");
+    void setRequestCacheEnabled(bool enabled);  // 关闭后相同的请求也重新生成
+    // 播放历史中的视频：文件已被淘汰或删除时按任务的视频 URL 重新下载，完成后发出 playbackReady
+    void playVideo(const QString &filePath);
+    void reloadStorageSettings();
     void loadHistory();
     void deleteHistoryItem(int index);
     QList<HistoryItem> getHistory() const;
@@ -26,6 +36,9 @@ public:
     // 获取 API 服务
     ApiService* getApiService() const;
 
+    // 获取多任务调度器
+    GenerationTaskManager* getTaskManager() const;
+
 signals:
     // 通知 UI 更新的信号
     void statusChanged(const QString &msg);
@@ -33,34 +46,34 @@ signals:
     void videoReady(const QString &localPath); // 新生成的视频
     void historyUpdated(); // 列表变化
     void errorOccurred(const QString &msg);
+    void queueChanged(int active, int waiting); // 并发任务数变化
+    void batchProgress(const BatchStats &stats); // 参数扫描批次的进度和吞吐
+    void requestCacheStatsChanged(const RequestCacheStats &stats); // 结果缓存命中统计
+    void playbackReady(const QString &localPath); // 可以播放（可能是重新下载的）
+    void playbackFailed(const QString &msg);
 
 private slots:
-    void onTaskSubmitted(const QString &taskId);
-    void onTaskFinished(bool success, const QString &result, const QString &error);
-    void onVideoDownloaded(const QString &tempPath);
-    void onSmartPoll();  // 智能轮询槽函数
+    void onJobStateChanged(const QString &jobId, GenerationState state, const QString &message);
+    void onJobProgress(const QString &jobId, int percent);
+    void onJobSaved(const QString &jobId, const QString &localPath);
+    void onJobFailed(const QString &jobId, const QString &error);
+    void onVideoRefetched(const QString &taskId, const QString &localPath);
+    void onRefetchFailed(const QString &taskId, const QString &error);
+    void onCorruptVideo(const QString &path, const QString &reason);
 
 private:
-    void startSmartPolling();  // 开始智能轮询
-    void stopPolling();  // 停止轮询
-    void updateWaitingTime();  // 更新等待时间显示
+    void refetchForPlayback(const QString &filePath, const TaskItem &task);  // task 为引用该文件的任务
+    void repairCorruptVideo(const QString &path, const QString &reason, const TaskItem &task);
 
     ApiService *apiService;
     HistoryService *historyService;
     TaskDatabaseService *taskDbService;
-    QTimer *pollTimer;
-    QString currentTaskId;
-    QString currentApiKey;
-    QString currentPrompt;
-    QMap<QString, QString> currentParams;  // 当前任务参数
-
-    // 智能轮询相关
-    QDateTime taskStartTime;  // 任务开始时间
-    int pollAttempts;  // 轮询次数
-    int currentInterval;  // 当前轮询间隔（毫秒）
-    static const int MAX_WAIT_TIME = 300;  // 最大等待时间（秒）5分钟
-    static const int INITIAL_INTERVAL = 3000;  // 初始轮询间隔3秒
-    static const int MAX_INTERVAL = 30000;  // 最大轮询间隔30秒
+    GenerationTaskManager *taskManager;
+    VideoStore *videoStore;
+    VideoScrubber *videoScrubber;
+    QMap<QString, QString> pendingPlayback;  // 为播放而重新下载的 taskId -> 历史记录中的原路径
+    QMap<QString, QString> pendingRepair;    // 因校验失败而重新下载的 taskId -> 原路径
+    QString focusedJobId;  // 状态栏和进度条跟随最近提交的任务
 };
 
 #endif // MAINVIEWMODEL_H
\ No newline at end of file